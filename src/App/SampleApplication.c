@@ -18,18 +18,22 @@
 #include "UARTModule.h"
 #include "ButtonModule.h"
 #include "LEDModule.h"
+#include "ADCModule.h"
 
 #include "Util/StateTable/StateTable.h"
 
 #include "SampleApplication.h"
 #include "ADCValues.h"
+#include "SensorDiagnostics.h"
+#include "AcquisitionRate.h"
+#include "SensorPipeline.h"
+#include "ButtonGesture.h"
 #include "LogOutput.h"
 
 #define distanceTillError 20  //in 10cm
+#define Distance_Error_mm (distanceTillError * 100)	// in mm
 #define Distance_Min 500000	// in µV
 #define Distance_Max 2500000	// in µV
-#define Voltage_Range 2000000	// in µV
-#define Distance_Range 95		//in m
 
 /*
  * Private Functions
@@ -37,12 +41,16 @@
 
 // State realte functions (on-Entry, on-State and on-Exit)
 static int32_t onEntryStartup(State_t* pState, int32_t eventID);
+static int32_t onEntryRunningNormal(State_t* pState, int32_t eventID);
+static int32_t onEntryRunningRace(State_t* pState, int32_t eventID);
 static int32_t onStateRunning(State_t* pState, int32_t eventID);
 static int32_t onExitRunning(State_t* pState, int32_t eventID);
 static int32_t onEntryFailure(State_t* pState, int32_t eventID);
 static int32_t onEntryEmergency(State_t* pState, int32_t eventID);
 static int32_t onStateEmergency(State_t* pState, int32_t eventID);
 
+static void onSensorOutOfRange(ADC_Channel_t adcChannel);
+
 /**
  * @brief List of State for the State Machine
  *
@@ -53,8 +61,8 @@ static int32_t onStateEmergency(State_t* pState, int32_t eventID);
 static State_t gStateList[] =
 {
     {STATE_ID_STARTUP,			onEntryStartup,  	0,					0,              false},
-    {STATE_ID_RUNNING_NORMAL,	0,					onStateRunning, 	onExitRunning,  false},
-	{STATE_ID_RUNNING_RACE, 	0,					onStateRunning, 	onExitRunning,  false},
+    {STATE_ID_RUNNING_NORMAL,	onEntryRunningNormal,	onStateRunning, 	onExitRunning,  false},
+	{STATE_ID_RUNNING_RACE, 	onEntryRunningRace,		onStateRunning, 	onExitRunning,  false},
 	{STATE_ID_EMERGENCY, 		onEntryEmergency,	onStateEmergency, 	0,  			false},
     {STATE_ID_FAILURE, 			onEntryFailure,  	0,					0,              false}
 };
@@ -78,12 +86,36 @@ static StateTableEntry_t gStateTableEntries[] =
 	{STATE_ID_RUNNING_RACE,          	STATE_ID_FAILURE,           		EVT_ID_SENSOR_FAILED,       0,      0,      0}
 };
 
+/**
+ * @brief Mapping of the button gestures to state machine events. Events
+ * without a transition in the current state are ignored by the state table
+ *
+ */
+static const GestureMapping_t gGestureMapping[] =
+{
+    {GESTURE_BUTTON(BTN_RACE_MODE),                                 GESTURE_CLICK,          EVT_ID_NORMAL2RACE},
+    {GESTURE_BUTTON(BTN_RACE_MODE),                                 GESTURE_LONG_PRESS,     EVT_ID_RACE2NORMAL},
+    {GESTURE_BUTTON(BTN_ACTIVATE) | GESTURE_BUTTON(BTN_RACE_MODE),  GESTURE_CHORD,          EVT_ID_EMERGENCY}
+};
+
 /**
  * @brief Global State Table instance
  *
  */
 static StateTable_t gStateTable;
 
+/**
+ * @brief Latched sensor failure reported by the analog watchdog interrupt
+ *
+ */
+static volatile bool gSensorFailureLatched = false;
+
+/**
+ * @brief Sensor diagnostic flags which have already been reported
+ *
+ */
+static uint32_t gReportedDiagFlags = 0;
+
 
 int32_t sampleAppInitialize()
 {
@@ -91,6 +123,13 @@ int32_t sampleAppInitialize()
     gStateTable.stateCount = sizeof(gStateList) / sizeof(State_t);
     int32_t result = stateTableInitialize(&gStateTable, gStateTableEntries, sizeof(gStateTableEntries) / sizeof(StateTableEntry_t), STATE_ID_STARTUP);
 
+    // Button gestures post their events directly into the event queue of the state table
+    gestureInitialize(gGestureMapping, sizeof(gGestureMapping) / sizeof(GestureMapping_t), sameplAppSendEvent);
+
+    // Range check of the position sensors is done by the ADC analog watchdogs
+    adcConfigureWatchdog(ADC_INPUT0, Distance_Min, Distance_Max, onSensorOutOfRange);
+    adcConfigureWatchdog(ADC_INPUT1, Distance_Min, Distance_Max, onSensorOutOfRange);
+
     return result;
 }
 
@@ -111,6 +150,17 @@ static int32_t onEntryStartup(State_t* pState, int32_t eventID)
     return sameplAppSendEvent(EVT_ID_INIT_READY);
 }
 
+static int32_t onEntryRunningNormal(State_t* pState, int32_t eventID)
+{
+    // Sampling rate follows the sensor motion (idle / normal)
+    return acqSetMinimumProfile(ACQ_PROFILE_IDLE);
+}
+
+static int32_t onEntryRunningRace(State_t* pState, int32_t eventID)
+{
+    return acqSetMinimumProfile(ACQ_PROFILE_RACE);
+}
+
 static int32_t onStateRunning(State_t* pState, int32_t eventID)
 {
 
@@ -121,20 +171,34 @@ static int32_t onStateRunning(State_t* pState, int32_t eventID)
 //
 //	}
 
-	int32_t Sensor1MicroVolt = filteredChannel1();
-	int32_t Sensor2MicroVolt = filteredChannel2();
+	SensorFusion_t fusion;
+
+	// Both pots are checked against the position predicted by the Kalman filter, so
+	// fast motion doesn't show up as sensor mismatch
+	sensorPipelineReadFusion(&fusion);
 
-	if(Sensor1MicroVolt<=Distance_Min || Sensor1MicroVolt>=Distance_Max){
+	// The out-of-range event is posted directly from the ADC interrupt. The latch
+	// repeats it in case it collided with another pending event
+	if(gSensorFailureLatched){
 		return sameplAppSendEvent(EVT_ID_SENSOR_FAILED);
 	}
-	if(Sensor2MicroVolt<=Distance_Min || Sensor2MicroVolt>=Distance_Max){
-		return sameplAppSendEvent(EVT_ID_SENSOR_FAILED);
+
+	// Report degrading sensors (noise, stuck, jumps) before they cause an emergency
+	uint32_t diagFlags = sensorDiagGetFlags();
+	if(diagFlags != gReportedDiagFlags){
+		if(diagFlags != 0){
+			outputLogf("Sensor warning: 0x%02x\r\n", diagFlags);
+		}
+		gReportedDiagFlags = diagFlags;
 	}
 
-	int32_t Sensor_1_10cm=((Sensor1MicroVolt-Distance_Min)*Distance_Range * 10) /Voltage_Range;
-	int32_t Sensor_2_10cm=((Sensor2MicroVolt-Distance_Min)*Distance_Range * 10) /Voltage_Range;
+	// The pipeline provides the residuals in mm (calibrated characteristic of each pot)
+	int32_t Innovation_1_mm=fusion.innovation[0];
+	int32_t Innovation_2_mm=fusion.innovation[1];
 
-	if((Sensor_1_10cm - Sensor_2_10cm) <= -distanceTillError || (Sensor_1_10cm - Sensor_2_10cm) >= distanceTillError){
+	// A mismatch between the pots splits up evenly into both residuals
+	if((2*Innovation_1_mm) <= -Distance_Error_mm || (2*Innovation_1_mm) >= Distance_Error_mm ||
+	   (2*Innovation_2_mm) <= -Distance_Error_mm || (2*Innovation_2_mm) >= Distance_Error_mm){
 
 		return sameplAppSendEvent(EVT_ID_EMERGENCY);
 	}
@@ -148,8 +212,14 @@ static int32_t onEntryEmergency(State_t* pState, int32_t eventID){
 
 	char message [] = "Emergency!";
 	outputLog(message);
+
+	// Keep monitoring the sensors at least at the normal rate
+	acqSetMinimumProfile(ACQ_PROFILE_NORMAL);
 	//UART<-"EMERGENCY"
 
+	// Flashing is run by the LED timer, no task code is needed
+	ledSetPattern(LED2_EMERGENCY, &gLedPatternBlinkFast);
+
 	return 0;
 }
 
@@ -166,8 +236,20 @@ static int32_t onExitRunning(State_t* pState, int32_t eventID)
     return 0;
 }
 
+/**
+ * @brief Analog watchdog callback for the position sensors (interrupt context)
+ *
+ * @param adcChannel Channel which left the valid window
+ */
+static void onSensorOutOfRange(ADC_Channel_t adcChannel)
+{
+	gSensorFailureLatched = true;
+	sameplAppSendEvent(EVT_ID_SENSOR_FAILED);
+}
+
 static int32_t onEntryFailure(State_t* pState, int32_t eventID)
 {
     ledSetLED(LED3_MOTOR_STATUS, LED_ON);
+    acqSetMinimumProfile(ACQ_PROFILE_NORMAL);
     return 0;
 }
@@ -27,7 +27,7 @@
 #define EVT_ID_SENSOR_FAILED    		2       //!< Event ID for Sensor Failure
 #define EVT_ID_NORMAL2RACE  			3       //!< Event ID for Sensor Failure
 #define EVT_ID_RACE2NORMAL  			4       //!< Event ID for Sensor Failure
-#define EVT_ID_EMERGENCY	 			4       //!< Event ID for Sensor Failure
+#define EVT_ID_EMERGENCY	 			5       //!< Event ID for Emergency
 /*
  * Public Interface
 */
@@ -0,0 +1,188 @@
+/**
+ * @file ADCFrame.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of the frame buffer between the ADC interrupt and the tasks
+ *
+ * The sequence counter counts two steps per frame: frame n is written while
+ * the counter is 2n - 1 and complete at 2n. It is stored in slot
+ * n % ADC_FRAME_QUEUE_LENGTH, so a copy of frame n is valid as long as the
+ * update of frame n + ADC_FRAME_QUEUE_LENGTH hasn't started. The frame
+ * numbers wrap with the counter at 2^31 (ADC_SEQUENCE_MASK), so positions in
+ * the ring are compared by their distance
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdbool.h>
+
+#include "stm32g4xx_hal.h"
+
+#include "ADCFrame.h"
+
+/*
+ * Private Defines
+*/
+#define ADC_FRAME_SLOT(frame)       ((frame) % ADC_FRAME_QUEUE_LENGTH)                  //!< Ring slot of a frame number
+#define ADC_FRAME_OVERWRITE(frame)  (2UL * ((frame) + ADC_FRAME_QUEUE_LENGTH) - 1UL)    //!< Sequence counter at which the slot of a frame is overwritten
+
+/*
+ * Private Module Variables
+*/
+static volatile ADCSnapshot_t gFrames[ADC_FRAME_QUEUE_LENGTH];  //!< Last published frames, indexed by ADC_FRAME_SLOT
+static volatile uint32_t gFrameSequence;                        //!< Sequence counter (odd while an update is in progress)
+
+/*
+ * Private Module Functions
+*/
+static bool adcFrameCopy(uint32_t frame, ADCSnapshot_t* pSnapshot);
+
+/*
+ * Public Module Functions
+*/
+
+void adcFrameInitialize(int32_t supplyMicroVolt, int32_t temperature)
+{
+    gFrameSequence = 0;
+
+    for (int32_t slot=0; slot<ADC_FRAME_QUEUE_LENGTH; slot++)
+    {
+        for (int32_t i=0; i<ADC_CHANNEL_COUNT; i++)
+        {
+            gFrames[slot].raw[i]        = 0;
+            gFrames[slot].microVolt[i]  = 0;
+        }
+        gFrames[slot].sequence          = 0;
+        gFrames[slot].supplyMicroVolt   = supplyMicroVolt;
+        gFrames[slot].temperature       = temperature;
+    }
+}
+
+void adcFramePublish(const int32_t* pRaw, const int32_t* pMicroVolt, int32_t supplyMicroVolt, int32_t temperature)
+{
+    // Begin of frame update (sequence becomes odd)
+    uint32_t sequence = gFrameSequence + 1;
+    gFrameSequence = sequence;
+    __DMB();
+
+    uint32_t frame = (sequence + 1) >> 1;
+    volatile ADCSnapshot_t* pFrame = &gFrames[ADC_FRAME_SLOT(frame)];
+
+    for (int32_t i=0; i<ADC_CHANNEL_COUNT; i++)
+    {
+        pFrame->raw[i]          = pRaw[i];
+        pFrame->microVolt[i]    = pMicroVolt[i];
+    }
+    pFrame->supplyMicroVolt     = supplyMicroVolt;
+    pFrame->temperature         = temperature;
+    pFrame->sequence            = frame;
+
+    // End of frame update (sequence becomes even again)
+    __DMB();
+    gFrameSequence = sequence + 1;
+}
+
+int32_t adcFrameRead(ADCSnapshot_t* pSnapshot)
+{
+    uint32_t previous = pSnapshot->sequence;
+
+    for (int32_t retry=0; retry<ADC_FRAME_RETRIES; retry++)
+    {
+        // Last complete frame
+        if (adcFrameCopy(gFrameSequence >> 1, pSnapshot))
+        {
+            pSnapshot->newData = (pSnapshot->sequence != previous);
+            return ADC_ERR_OK;
+        }
+    }
+
+    return ADC_ERR_BUSY;
+}
+
+int32_t adcFrameReadNext(ADCSnapshot_t* pSnapshot)
+{
+    uint32_t previous = pSnapshot->sequence;
+
+    for (int32_t retry=0; retry<ADC_FRAME_RETRIES; retry++)
+    {
+        uint32_t sequence = gFrameSequence;
+        uint32_t newest = sequence >> 1;
+
+        if (newest == previous)
+        {
+            pSnapshot->newData = false;
+            return ADC_ERR_OK;
+        }
+
+        // Frames behind the newest one which are not being overwritten right now
+        uint32_t window = ADC_FRAME_QUEUE_LENGTH - 1 - (sequence & 1);
+        uint32_t frame = (previous + 1) & ADC_SEQUENCE_MASK;
+
+        // Signed distance in the 31 bit frame numbers, so the ring is followed across the wrap
+        int32_t age = (int32_t)(ADC_SEQUENCE_DISTANCE(frame, newest) << 1) >> 1;
+
+        if (age < 0)
+        {
+            // Snapshot is ahead of the ring (frames reinitialized)
+            frame = newest;
+        }
+        else if (age > (int32_t)window)
+        {
+            // Overwritten meanwhile, continue with the oldest frame of the ring
+            frame = (newest - window) & ADC_SEQUENCE_MASK;
+        }
+
+        if (adcFrameCopy(frame, pSnapshot))
+        {
+            pSnapshot->newData = true;
+            return ADC_ERR_OK;
+        }
+    }
+
+    return ADC_ERR_BUSY;
+}
+
+const volatile ADCSnapshot_t* adcFrameLatest(void)
+{
+    return &gFrames[ADC_FRAME_SLOT(gFrameSequence >> 1)];
+}
+
+/**
+ * @brief Copies a frame from the ring
+ *
+ * @param frame         Number of the frame
+ * @param pSnapshot     Pointer to the snapshot to update (sequence is set to the frame number)
+ *
+ * @return Returns true if the copy is consistent, false if the slot has
+ * been overwritten before or during the copy
+ */
+static bool adcFrameCopy(uint32_t frame, ADCSnapshot_t* pSnapshot)
+{
+    const volatile ADCSnapshot_t* pFrame = &gFrames[ADC_FRAME_SLOT(frame)];
+
+    __DMB();
+
+    for (int32_t i=0; i<ADC_CHANNEL_COUNT; i++)
+    {
+        pSnapshot->raw[i]       = pFrame->raw[i];
+        pSnapshot->microVolt[i] = pFrame->microVolt[i];
+    }
+    pSnapshot->supplyMicroVolt  = pFrame->supplyMicroVolt;
+    pSnapshot->temperature      = pFrame->temperature;
+    uint32_t copied             = pFrame->sequence;
+
+    __DMB();
+
+    // Copy is only valid if it is the requested frame and its slot wasn't overwritten meanwhile
+    if (copied != frame || (int32_t)(gFrameSequence - ADC_FRAME_OVERWRITE(frame)) >= 0)
+    {
+        return false;
+    }
+
+    pSnapshot->sequence = frame;
+
+    return true;
+}
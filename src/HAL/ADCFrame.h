@@ -0,0 +1,96 @@
+/**
+ * @file ADCFrame.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Header file of the frame buffer between the ADC interrupt and the tasks
+ *
+ * The conversion complete interrupt publishes one frame per scan, the tasks
+ * copy it without disabling interrupts. A sequence counter (seqlock) detects
+ * a copy which overlapped with an update: it is odd while the interrupt
+ * writes a frame, so a reader retries if the frame it copied was written
+ * in the meantime. There is only one writer (the interrupt), which is never
+ * interrupted by a reader
+ *
+ * The last ADC_FRAME_QUEUE_LENGTH frames are kept in a ring, so a task
+ * which runs at about the frame rate (1kHz frames, 1ms task) can process
+ * every frame in order even if it is delayed by a few periods
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _ADC_FRAME_H_
+#define _ADC_FRAME_H_
+
+#include <stdint.h>
+
+#include "ADCModule.h"
+
+/*
+ * Public Defines
+*/
+#define ADC_FRAME_RETRIES           8           //!< Maximum number of retries of a read overlapping a frame update
+#define ADC_FRAME_QUEUE_LENGTH      4           //!< Number of frames kept in the ring (frame n is overwritten by frame n + 4)
+
+/*
+ * Public Interface
+*/
+
+/**
+ * @brief Resets the frame (sequence 0, all channels zero)
+ *
+ * @param supplyMicroVolt   Initial supply voltage in µV
+ * @param temperature       Initial chip temperature in 0.1°C
+ */
+void adcFrameInitialize(int32_t supplyMicroVolt, int32_t temperature);
+
+/**
+ * @brief Publishes a new frame (writer, called from the conversion complete
+ * interrupt only)
+ *
+ * @param pRaw              Raw values in digits, indexed by ADC_Channel_t
+ * @param pMicroVolt        Converted values in µV, indexed by ADC_Channel_t
+ * @param supplyMicroVolt   Supply voltage of the frame in µV
+ * @param temperature       Chip temperature of the frame in 0.1°C
+ */
+void adcFramePublish(const int32_t* pRaw, const int32_t* pMicroVolt, int32_t supplyMicroVolt, int32_t temperature);
+
+/**
+ * @brief Copies the last published frame (reader)
+ *
+ * The sequence of the previous read (kept in the snapshot) is used to set
+ * the newData flag
+ *
+ * @param pSnapshot     Pointer to the snapshot to update
+ *
+ * @return Returns ADC_ERR_OK if a consistent copy was made, ADC_ERR_BUSY if
+ * all retries overlapped with an update
+ */
+int32_t adcFrameRead(ADCSnapshot_t* pSnapshot);
+
+/**
+ * @brief Copies the frame following the one in the snapshot (reader)
+ *
+ * Frames which have already been overwritten are skipped (the oldest frame
+ * of the ring is copied), the gap shows in the sequence numbers. If there is
+ * no newer frame, the snapshot is kept and newData is cleared
+ *
+ * @param pSnapshot     Pointer to the snapshot of the previous read
+ *
+ * @return Returns ADC_ERR_OK if no error occured, ADC_ERR_BUSY if all retries
+ * overlapped with an update of the copied frame
+ */
+int32_t adcFrameReadNext(ADCSnapshot_t* pSnapshot);
+
+/**
+ * @brief Returns the last published frame for reads of a single value
+ *
+ * @remark Single 32 bit values are always consistent, values which have to
+ * belong to the same scan must be read with adcFrameRead
+ *
+ * @return Returns a pointer to the frame
+ */
+const volatile ADCSnapshot_t* adcFrameLatest(void);
+
+#endif
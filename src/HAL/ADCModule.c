@@ -17,37 +17,158 @@
 #include "stm32g4xx_hal.h"
 
 #include "System.h"
+#include "CriticalSection.h"
 #include "HardwareConfig.h"
 #include "ADCModule.h"
+#include "ADCWatchdog.h"
+#include "ADCFrame.h"
+#include "FlashModule.h"
 
 /*
  * Private Defines
 */
-#define ADC_CHANNEL_COUNT       5                   //!< Total number of used ADC channels
+#define ADC_FRAME_LENGTH        1                   //!< Number of 32 bit words per DMA frame (one word per ADC1/ADC2 rank pair)
 
-#define IDX_ADC_INPUT0          0                   //!< Array index for ADC channel 0 (Pot 1) in global ADC value array
-#define IDX_ADC_INPUT1          1                   //!< Array index for ADC channel 1 (Pot 2) in global ADC value array
-#define IDX_ADC_TEMP            2                   //!< Array index for ADC channel 2 (internal Temp) in global ADC value array
-#define IDX_ADC_VBAT            3                   //!< Array index for ADC channel 3 (VBat) in global ADC value array
-#define IDX_ADC_VREF            4                   //!< Array index for ADC channel 4 (internal reference voltage) in global ADC value array
+#define IDX_ADC_POT_PAIR        0                   //!< Frame index for Pot 1 (ADC1, lower half) and Pot 2 (ADC2, upper half), sampled simultaneously
+
+#define ADC_HOUSEKEEPING_LENGTH 3                   //!< Number of ranks of the injected (housekeeping) sequence of ADC1
+
+#define IDX_ADC_TEMP            0                   //!< Housekeeping index for internal Temp (ADC1, injected rank 1)
+#define IDX_ADC_VBAT            1                   //!< Housekeeping index for VBat (ADC1, injected rank 2)
+#define IDX_ADC_VREF            2                   //!< Housekeeping index for internal reference voltage (ADC1, injected rank 3)
+
+/**
+ * @brief Sampling times of both lanes (ADC clock is PCLK / 4 = 32 MHz)
+ *
+ * Regular lane (Pot 1 / Pot 2, simultaneous): 47.5 + 12.5 = 60 cycles = 1.875µs per scan,
+ * which allows a trigger rate of up to ~533kHz (before 4 ranks with 105 cycles = 13.1µs).
+ *
+ * Injected lane (Temp, VBat, VREFINT): 3 * (640.5 + 12.5) = 1959 cycles = 61.2µs per
+ * sequence, which satisfies the minimum sampling times of the internal channels
+ */
+#define ADC_SAMPLETIME_POSITION     ADC_SAMPLETIME_47CYCLES_5
+#define ADC_SAMPLETIME_HOUSEKEEPING ADC_SAMPLETIME_640CYCLES_5
+
+#define ADC_WATCHDOG_NONE       0                   //!< Marker for channels without analog watchdog support
+
+#define ADC_GAIN_MIN            (ADC_GAIN_UNITY / 2)    //!< Lowest plausible gain compensation (0.5)
+#define ADC_GAIN_MAX            (ADC_GAIN_UNITY * 2)    //!< Highest plausible gain compensation (2.0)
+#define ADC_OFFSET_MAX          1024                    //!< Highest plausible absolute offset in digits
+
+#define ADC_OFFSET_LEVEL(offset)    ((uint32_t)(((offset) < 0) ? -(offset) : (offset)))     //!< Offset register value of a signed offset
+#define ADC_OFFSET_SIGN(offset)     (((offset) < 0) ? ADC_OFFSET_SIGN_POSITIVE : ADC_OFFSET_SIGN_NEGATIVE) //!< Offset sign (positive offsets are subtracted)
+
+#define ADC_MASTER_DATA(word)   ((word) & 0xFFFFUL) //!< Extracts the ADC1 (master) result of a dual mode data word
+#define ADC_SLAVE_DATA(word)    ((word) >> 16)      //!< Extracts the ADC2 (slave) result of a dual mode data word
+
+#define ADC_FULL_SCALE          4095                //!< Maximum digit value of the 12 bit ADC
+#define ADC_CAL_MICROVOLT       (VREFINT_CAL_VREF * 1000UL)     //!< VDDA in µV used during factory calibration (3.0V)
+#define ADC_NOMINAL_VDDA_MV     3300UL              //!< Nominal VDDA in mV, used until the first frame is available
+
+/**
+ * @brief µV per digit at calibration VDDA as Q8 value (3.0V / 4095 * 256),
+ * evaluated at compile time so no division is needed at runtime
+ */
+#define ADC_CAL_MICROVOLTS_PER_DIGIT_Q8     ((ADC_CAL_MICROVOLT * 256UL + ADC_FULL_SCALE / 2) / ADC_FULL_SCALE)
+
+/**
+ * @brief Ratio VDDA / calibration VDDA for the nominal supply as Q16 value
+ */
+#define ADC_NOMINAL_SUPPLY_RATIO_Q16        ((ADC_NOMINAL_VDDA_MV << 16) / VREFINT_CAL_VREF)
+
+/*
+ * Private Types
+*/
+
+/**
+ * @brief Assignment of an analog watchdog (ADC instance, watchdog number and
+ * monitored channel) to a logical ADC channel
+ *
+ */
+typedef struct _ADCWatchdogEntry
+{
+    ADC_HandleTypeDef* pHandle;                     //!< ADC which converts the channel
+    uint32_t watchdogNumber;                        //!< Analog watchdog used for the channel (ADC_WATCHDOG_NONE if not supported)
+    uint32_t thresholdRegister;                     //!< Threshold register of the watchdog (ADC_WDG_AWDx)
+    uint32_t watchdogMode;                          //!< Conversion group monitored by the watchdog (regular or injected)
+    uint32_t channel;                               //!< HAL channel monitored by the watchdog
+    uint32_t interruptSource;                       //!< Interrupt source/flag of the watchdog
+} ADCWatchdogEntry_t;
+
+/**
+ * @brief Window of an analog watchdog as configured by the application. The
+ * thresholds in digits are derived from it with the current VDDA
+ *
+ */
+typedef struct _ADCWatchdogWindow
+{
+    bool active;                                    //!< Window has been configured (thresholds follow VDDA)
+    int32_t lowMicroVolt;                           //!< Lower limit of the window in µV
+    int32_t highMicroVolt;                          //!< Upper limit of the window in µV
+} ADCWatchdogWindow_t;
 
 /*
  * Private Module Variables
 */
-static ADC_HandleTypeDef gADCHandle;                //!< Global handle for ADC peripheral
+static ADC_HandleTypeDef gADCHandle;                //!< Global handle for ADC peripheral (ADC1, multimode master)
+static ADC_HandleTypeDef gADCSlaveHandle;           //!< Global handle for ADC peripheral (ADC2, multimode slave)
 static DMA_HandleTypeDef gDMA_ADC_Handle;           //!< Global handle for DMA peripheral used for ADC data transfer
 
-static uint32_t gADCValues[ADC_CHANNEL_COUNT];      //!< Global array for ADC values used by the DMA transfer
+static uint32_t gADCValues[ADC_FRAME_LENGTH];       //!< Global array for packed ADC1/ADC2 values used by the DMA transfer
+
+static uint32_t gHousekeepingValues[ADC_HOUSEKEEPING_LENGTH];  //!< Latest raw values of the injected (housekeeping) sequence
+static volatile bool gHousekeepingRequest;          //!< Request to start the injected sequence after the next regular scan
+
+static ADCSensorCalibration_t gSensorCalibration[ADC_SENSOR_COUNT];    //!< Offset and gain compensation of the position sensors, indexed by ADC_Channel_t
+static volatile uint32_t gHousekeepingGainQ16;      //!< Reciprocal of the ADC1 gain compensation (Q16), which also applies to the housekeeping channels
+
+static volatile ADCErrorCounters_t gErrorCounters;  //!< Error counters of the ADC/DMA data path, updated by the error callback
+
+static ADCWatchdogCallback gWatchdogCallbacks[ADC_CHANNEL_COUNT];    //!< Callbacks for out-of-window events, per logical channel
+static ADCWatchdogWindow_t gWatchdogWindows[ADC_CHANNEL_COUNT];     //!< Configured watchdog windows, per logical channel
+
+/**
+ * @brief Analog watchdog assignment, indexed by ADC_Channel_t. AWD1 is the only
+ * watchdog with 12 bit thresholds, so it is used for the position sensors
+ */
+static const ADCWatchdogEntry_t gWatchdogTable[ADC_CHANNEL_COUNT] =
+{
+    {&gADCHandle,       ADC_ANALOGWATCHDOG_1,   ADC_WDG_AWD1,   ADC_ANALOGWATCHDOG_SINGLE_REG,      ADC_CHANNEL_1,                  ADC_IT_AWD1},   // ADC_INPUT0
+    {&gADCSlaveHandle,  ADC_ANALOGWATCHDOG_1,   ADC_WDG_AWD1,   ADC_ANALOGWATCHDOG_SINGLE_REG,      ADC_CHANNEL_2,                  ADC_IT_AWD1},   // ADC_INPUT1
+    {&gADCHandle,       ADC_ANALOGWATCHDOG_2,   ADC_WDG_AWD2,   ADC_ANALOGWATCHDOG_SINGLE_INJEC,    ADC_CHANNEL_TEMPSENSOR_ADC1,    ADC_IT_AWD2},   // ADC_TEMP
+    {0,                 ADC_WATCHDOG_NONE,      0,              ADC_ANALOGWATCHDOG_NONE,            0,                              0},             // ADC_VBAT
+    {&gADCHandle,       ADC_ANALOGWATCHDOG_3,   ADC_WDG_AWD3,   ADC_ANALOGWATCHDOG_SINGLE_INJEC,    ADC_CHANNEL_VREFINT,            ADC_IT_AWD3}    // ADC_VREF
+};
+
+static int32_t gVrefIntCal;                         //!< Factory calibration value of VREFINT (raw digits at 3.0V)
+static int32_t gTempSensorCal1;                     //!< Factory calibration value TS_CAL1 (raw digits at 30°C and 3.0V)
+static int32_t gTempSlopeQ16;                       //!< Precomputed reciprocal slope of the temperature sensor in 0.1°C / digit (Q16)
+
+static volatile uint32_t gSupplyRatioQ16;           //!< Ratio of measured VDDA to calibration VDDA (Q16), updated by the housekeeping lane
+static volatile uint32_t gMicroVoltsPerDigitQ16;    //!< Ratiometric conversion factor in µV / digit (Q16), updated by the housekeeping lane
+static volatile int32_t gSupplyMicroVolt;           //!< VDDA of the latest housekeeping sequence in µV
+static volatile int32_t gTemperature;               //!< Chip temperature of the latest housekeeping sequence in 0.1°C
+
 
 /*
  * Private Module Functions
 */
 static void adcInitializeDMA(void);
-
-/*
- * Public Constants
-*/
-static const int32_t MICROVOLTS_PER_DIGIT = 805;    //!< 805 µV / digit
+static void adcInitializeSlave(void);
+static void adcInitializeHousekeeping(void);
+static void adcInitializeWatchdogs(void);
+static int32_t adcSetWatchdogThresholds(const ADCWatchdogEntry_t* pEntry, uint32_t lowThreshold, uint32_t highThreshold);
+static void adcWriteWatchdogThresholds(ADC_Channel_t adcChannel);
+static void adcUpdateWatchdogThresholds(void);
+static void adcArmWatchdog(ADC_Channel_t adcChannel);
+static void adcHandleWatchdog(ADC_HandleTypeDef* hadc, uint32_t watchdogNumber);
+static void adcInitializeConversion(void);
+static void adcUpdateConversion(void);
+static void adcUpdateHousekeeping(void);
+static void adcLoadSensorCalibration(void);
+static void adcApplySensorCalibration(void);
+static int32_t adcStoreSensorCalibration(void);
+static void adcStartConversion(void);
 
 /*
  * Public Module Functions
@@ -58,7 +179,13 @@ int32_t adcInitialize()
     /* Initialize DMA block for use with ADC */
     adcInitializeDMA();
 
-    memset(gADCValues, 0, ADC_CHANNEL_COUNT * sizeof(uint32_t));
+    memset(gADCValues, 0, ADC_FRAME_LENGTH * sizeof(uint32_t));
+
+    /* Load the factory calibration values and precompute the conversion factors */
+    adcInitializeConversion();
+
+    /* Restore the calibration of the position sensors */
+    adcLoadSensorCalibration();
 
     /**
      * Common config
@@ -70,12 +197,12 @@ int32_t adcInitialize()
     gADCHandle.Init.ClockPrescaler 			= ADC_CLOCK_SYNC_PCLK_DIV4;
     gADCHandle.Init.Resolution 				= ADC_RESOLUTION_12B;
     gADCHandle.Init.DataAlign 				= ADC_DATAALIGN_RIGHT;
-    gADCHandle.Init.GainCompensation 		= 0;
+    gADCHandle.Init.GainCompensation 		= gSensorCalibration[ADC_INPUT0].gain;
     gADCHandle.Init.ScanConvMode 			= ADC_SCAN_ENABLE;
-    gADCHandle.Init.EOCSelection 			= ADC_EOC_SINGLE_CONV;
+    gADCHandle.Init.EOCSelection 			= ADC_EOC_SEQ_CONV;
     gADCHandle.Init.LowPowerAutoWait 		= DISABLE;
     gADCHandle.Init.ContinuousConvMode 		= DISABLE;
-    gADCHandle.Init.NbrOfConversion 		= 5;
+    gADCHandle.Init.NbrOfConversion 		= ADC_FRAME_LENGTH;
     gADCHandle.Init.DiscontinuousConvMode 	= DISABLE;
     gADCHandle.Init.ExternalTrigConv 		= ADC_EXTERNALTRIG_T3_TRGO;
     gADCHandle.Init.ExternalTrigConvEdge 	= ADC_EXTERNALTRIGCONVEDGE_RISING;
@@ -88,69 +215,50 @@ int32_t adcInitialize()
     	Error_Handler();
     }
 
-	/** Configure the ADC multi-mode
-	*/
-	multimode.Mode = ADC_MODE_INDEPENDENT;
-	if (HAL_ADCEx_MultiModeConfigChannel(&gADCHandle, &multimode) != HAL_OK)
-	{
-		Error_Handler();
-	}
-
-	/** Configure Regular Channel
-	*/
-	sConfig.Channel 		= ADC_CHANNEL_1;
-	sConfig.Rank 			= ADC_REGULAR_RANK_1;
-	sConfig.SamplingTime 	= ADC_SAMPLETIME_92CYCLES_5;
-	sConfig.SingleDiff 		= ADC_SINGLE_ENDED;
-	sConfig.OffsetNumber 	= ADC_OFFSET_NONE;
-	sConfig.Offset 			= 0;
-	if (HAL_ADC_ConfigChannel(&gADCHandle, &sConfig) != HAL_OK)
-	{
-		Error_Handler();
-	}
+	/* ADC2 samples Pot 2 at the same instant as ADC1 samples Pot 1 */
+	adcInitializeSlave();
 
-	/** Configure Regular Channel
+	/** Configure the ADC multi-mode: ADC1 and ADC2 in regular simultaneous mode,
+	 *  both results are packed into one 32 bit word of the common data register
 	*/
-	sConfig.Channel 		= ADC_CHANNEL_2;
-	sConfig.Rank 			= ADC_REGULAR_RANK_2;
-	if (HAL_ADC_ConfigChannel(&gADCHandle, &sConfig) != HAL_OK)
+	multimode.Mode 				= ADC_DUALMODE_REGSIMULT;
+	multimode.DMAAccessMode 	= ADC_DMAACCESSMODE_12_10_BITS;
+	multimode.TwoSamplingDelay 	= ADC_TWOSAMPLINGDELAY_1CYCLE;
+	if (HAL_ADCEx_MultiModeConfigChannel(&gADCHandle, &multimode) != HAL_OK)
 	{
 		Error_Handler();
 	}
 
-	/** Configure Regular Channel
+	/** Configure Regular Channel (fast lane, position sensor only)
 	*/
-	sConfig.Channel 		= ADC_CHANNEL_TEMPSENSOR_ADC1;
-	sConfig.Rank 			= ADC_REGULAR_RANK_3;
+	sConfig.Channel 			= ADC_CHANNEL_1;
+	sConfig.Rank 				= ADC_REGULAR_RANK_1;
+	sConfig.SamplingTime 		= ADC_SAMPLETIME_POSITION;
+	sConfig.SingleDiff 			= ADC_SINGLE_ENDED;
+	sConfig.OffsetNumber 		= ADC_OFFSET_1;
+	sConfig.Offset 				= ADC_OFFSET_LEVEL(gSensorCalibration[ADC_INPUT0].offset);
+	sConfig.OffsetSign 			= ADC_OFFSET_SIGN(gSensorCalibration[ADC_INPUT0].offset);
+	sConfig.OffsetSaturation 	= ENABLE;
 	if (HAL_ADC_ConfigChannel(&gADCHandle, &sConfig) != HAL_OK)
 	{
 		Error_Handler();
 	}
 
-	/** Configure Regular Channel
-	*/
-	sConfig.Channel 		= ADC_CHANNEL_VBAT;
-	sConfig.Rank 			= ADC_REGULAR_RANK_4;
-	if (HAL_ADC_ConfigChannel(&gADCHandle, &sConfig) != HAL_OK)
-	{
-		Error_Handler();
-	}
+	/* Internal channels are converted in the injected sequence (slow lane) */
+	adcInitializeHousekeeping();
 
-	/** Configure Regular Channel
-	*/
-	sConfig.Channel 		= ADC_CHANNEL_VREFINT;
-	sConfig.Rank 			= ADC_REGULAR_RANK_5;
-	if (HAL_ADC_ConfigChannel(&gADCHandle, &sConfig) != HAL_OK)
-	{
-		Error_Handler();
-	}
+	/* Arm the analog watchdogs (thresholds are opened later via adcConfigureWatchdog) */
+	adcInitializeWatchdogs();
 
-	/* Calibrate the ADC */
+	/* Calibrate both ADCs */
     HAL_ADCEx_Calibration_Start(&gADCHandle, ADC_SINGLE_ENDED);
+    HAL_ADCEx_Calibration_Start(&gADCSlaveHandle, ADC_SINGLE_ENDED);
+
+    // Start ADC1/ADC2 in dual mode with DMA
+    adcStartConversion();
 
-    // Start ADC in DMA mode
-    // This assumes, that DMA peripheral has been already configured
-    HAL_ADC_Start_DMA(&gADCHandle, gADCValues, ADC_CHANNEL_COUNT);
+    // Get the supply and temperature values before the first frame is published
+    adcStartHousekeeping();
 
 	return ADC_ERR_OK;
 }
@@ -219,46 +327,732 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef* adcHandle)
 	HAL_NVIC_SetPriority(ADC1_2_IRQn, 0, 0);
 	HAL_NVIC_EnableIRQ(ADC1_2_IRQn);
   }
+  else if(adcHandle->Instance==ADC2)
+  {
+	/* ADC2 shares the ADC12 kernel clock, interrupt and DMA with ADC1.
+	 * The Pot 2 GPIO has already been configured together with ADC1
+	 */
+	__HAL_RCC_ADC12_CLK_ENABLE();
+  }
 }
 
 int32_t adcReadChannelRaw(ADC_Channel_t adcChannel)
 {
-    int32_t adcValue = 0;
+    if (adcChannel < 0 || adcChannel >= ADC_CHANNEL_COUNT)
+    {
+        return 0;
+    }
+
+    return adcFrameLatest()->raw[adcChannel];
+}
 
-    switch(adcChannel)
+int32_t adcReadChannel(ADC_Channel_t adcChannel)
+{
+    if (adcChannel < 0 || adcChannel >= ADC_CHANNEL_COUNT)
     {
-        case ADC_INPUT0:
-            adcValue = gADCValues[IDX_ADC_INPUT0];
-            break;
+        return 0;
+    }
 
-        case ADC_INPUT1:
-            adcValue = gADCValues[IDX_ADC_INPUT1];
-            break;
+    return adcFrameLatest()->microVolt[adcChannel];
+}
 
-        case ADC_TEMP:
-            adcValue = gADCValues[IDX_ADC_TEMP];
-            break;
+int32_t adcReadSnapshot(ADCSnapshot_t* pSnapshot)
+{
+    if (pSnapshot == 0)
+    {
+        return ADC_ERR_INVALID_PTR;
+    }
 
-        case ADC_VBAT:
-            adcValue = gADCValues[IDX_ADC_VBAT];
-            break;
+    return adcFrameRead(pSnapshot);
+}
+
+int32_t adcReadNextSnapshot(ADCSnapshot_t* pSnapshot)
+{
+    if (pSnapshot == 0)
+    {
+        return ADC_ERR_INVALID_PTR;
+    }
+
+    return adcFrameReadNext(pSnapshot);
+}
+
+int32_t adcMicroVoltToDigits(int32_t microVolt)
+{
+    if (microVolt <= 0)
+    {
+        return 0;
+    }
+
+    // Inverse of the ratiometric conversion, only used during configuration
+    uint32_t digits = (uint32_t)((((uint64_t)microVolt << 16) + (gMicroVoltsPerDigitQ16 / 2)) / gMicroVoltsPerDigitQ16);
+
+    return (digits > ADC_FULL_SCALE) ? ADC_FULL_SCALE : (int32_t)digits;
+}
+
+int32_t adcConfigureWatchdog(ADC_Channel_t adcChannel, int32_t lowMicroVolt, int32_t highMicroVolt, ADCWatchdogCallback pCallback)
+{
+    if (adcChannel < 0 || adcChannel >= ADC_CHANNEL_COUNT || lowMicroVolt > highMicroVolt)
+    {
+        return ADC_ERR_INVALID_PARAM;
+    }
+
+    const ADCWatchdogEntry_t* pEntry = &gWatchdogTable[adcChannel];
+    if (pEntry->watchdogNumber == ADC_WATCHDOG_NONE)
+    {
+        return ADC_ERR_INVALID_PARAM;
+    }
+
+    // Callback has to be in place before the window is narrowed
+    gWatchdogCallbacks[adcChannel] = pCallback;
+
+    // The housekeeping interrupt reprograms all active windows, so it must not see a half updated window
+    CRITICAL_SECTION_ENTER();
+
+    gWatchdogWindows[adcChannel].lowMicroVolt   = lowMicroVolt;
+    gWatchdogWindows[adcChannel].highMicroVolt  = highMicroVolt;
+    gWatchdogWindows[adcChannel].active         = true;
+    adcWriteWatchdogThresholds(adcChannel);
+
+    CRITICAL_SECTION_EXIT();
+
+    // (Re-)arm the interrupt, it is disabled after each out-of-window event
+    adcArmWatchdog(adcChannel);
+
+    return ADC_ERR_OK;
+}
+
+int32_t adcCaptureCalibrationPoint(ADC_Channel_t adcChannel, int32_t expectedMicroVolt, ADCCalibrationPoint_t* pPoint)
+{
+    if (pPoint == 0)
+    {
+        return ADC_ERR_INVALID_PTR;
+    }
+
+    if (adcChannel < 0 || adcChannel >= ADC_SENSOR_COUNT)
+    {
+        return ADC_ERR_INVALID_PARAM;
+    }
+
+    const ADCSensorCalibration_t* pCalibration = &gSensorCalibration[adcChannel];
+
+    // Revert the active compensation: raw = value * ADC_GAIN_UNITY / gain + offset
+    int32_t value = adcFrameLatest()->raw[adcChannel];
+    pPoint->measured = (int32_t)(((uint32_t)value * ADC_GAIN_UNITY + pCalibration->gain / 2) / pCalibration->gain) + pCalibration->offset;
+    pPoint->expected = adcMicroVoltToDigits(expectedMicroVolt);
+
+    return ADC_ERR_OK;
+}
+
+int32_t adcCalibrateSensor(ADC_Channel_t adcChannel, const ADCCalibrationPoint_t* pLow, const ADCCalibrationPoint_t* pHigh)
+{
+    if (pLow == 0 || pHigh == 0)
+    {
+        return ADC_ERR_INVALID_PTR;
+    }
+
+    if (adcChannel < 0 || adcChannel >= ADC_SENSOR_COUNT)
+    {
+        return ADC_ERR_INVALID_PARAM;
+    }
+
+    int32_t deltaMeasured = pHigh->measured - pLow->measured;
+    int32_t deltaExpected = pHigh->expected - pLow->expected;
+
+    if (deltaMeasured <= 0 || deltaExpected <= 0)
+    {
+        return ADC_ERR_INVALID_PARAM;
+    }
+
+    // Solve (measured - offset) * gain / ADC_GAIN_UNITY = expected for both points
+    int32_t gain = (deltaExpected * ADC_GAIN_UNITY + deltaMeasured / 2) / deltaMeasured;
+    if (gain < ADC_GAIN_MIN || gain > ADC_GAIN_MAX)
+    {
+        return ADC_ERR_INVALID_PARAM;
+    }
+
+    int32_t offset = pLow->measured - (pLow->expected * ADC_GAIN_UNITY + gain / 2) / gain;
+    if (offset < -ADC_OFFSET_MAX || offset > ADC_OFFSET_MAX)
+    {
+        return ADC_ERR_INVALID_PARAM;
+    }
+
+    gSensorCalibration[adcChannel].offset   = offset;
+    gSensorCalibration[adcChannel].gain     = (uint32_t)gain;
+
+    adcApplySensorCalibration();
 
-        case ADC_VREF:
-            adcValue = gADCValues[IDX_ADC_VREF];
+    return adcStoreSensorCalibration();
+}
+
+int32_t adcResetSensorCalibration(ADC_Channel_t adcChannel)
+{
+    if (adcChannel < 0 || adcChannel >= ADC_SENSOR_COUNT)
+    {
+        return ADC_ERR_INVALID_PARAM;
+    }
+
+    gSensorCalibration[adcChannel].offset   = 0;
+    gSensorCalibration[adcChannel].gain     = ADC_GAIN_UNITY;
+
+    adcApplySensorCalibration();
+
+    return adcStoreSensorCalibration();
+}
+
+int32_t adcReadErrorCounters(ADCErrorCounters_t* pCounters)
+{
+    if (pCounters == 0)
+    {
+        return ADC_ERR_INVALID_PTR;
+    }
+
+    pCounters->overrun  = gErrorCounters.overrun;
+    pCounters->dmaError = gErrorCounters.dmaError;
+
+    return ADC_ERR_OK;
+}
+
+int32_t adcReadSupplyVoltage()
+{
+    return adcFrameLatest()->supplyMicroVolt;
+}
+
+void adcStartHousekeeping()
+{
+    gHousekeepingRequest = true;
+}
+
+int32_t adcReadTemperature()
+{
+    return adcFrameLatest()->temperature;
+}
+
+/**
+ * @brief Regular conversion complete callback, called by the HAL from the
+ * DMA interrupt once a complete scan has been transferred
+ *
+ * @param hadc ADC handle pointer
+ *
+ * @remark: this HAL_ADC_ConvCpltCallback function is called automatically by the
+ * STM32 HAL library
+ */
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc)
+{
+    if (hadc->Instance == ADC1)
+    {
+        adcUpdateConversion();
+
+        // Start the slow lane right after the scan, so it never overlaps with a regular conversion.
+        // If the HAL is busy (e.g. locked by the task), the request is kept for the next scan
+        if (gHousekeepingRequest && HAL_ADCEx_InjectedStart_IT(&gADCHandle) == HAL_OK)
+        {
+            gHousekeepingRequest = false;
+        }
+    }
+}
+
+/**
+ * @brief Injected conversion complete callback, called by the HAL from the
+ * ADC interrupt once the housekeeping sequence has been converted
+ *
+ * @param hadc ADC handle pointer
+ *
+ * @remark: this HAL_ADCEx_InjectedConvCpltCallback function is called automatically by the
+ * STM32 HAL library
+ */
+void HAL_ADCEx_InjectedConvCpltCallback(ADC_HandleTypeDef* hadc)
+{
+    if (hadc->Instance == ADC1)
+    {
+        adcUpdateHousekeeping();
+    }
+}
+
+/**
+ * @brief ADC error callback, called by the HAL on an overrun or a DMA error.
+ * Both stop the DMA requests of the ADC, so the conversion is restarted
+ *
+ * @param hadc ADC handle pointer
+ *
+ * @remark: this HAL_ADC_ErrorCallback function is called automatically by the
+ * STM32 HAL library
+ */
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef* hadc)
+{
+    if (hadc->Instance != ADC1)
+    {
+        return;
+    }
+
+    if ((hadc->ErrorCode & HAL_ADC_ERROR_OVR) != 0)
+    {
+        gErrorCounters.overrun++;
+    }
+
+    if ((hadc->ErrorCode & HAL_ADC_ERROR_DMA) != 0)
+    {
+        gErrorCounters.dmaError++;
+    }
+
+    // The stop also aborts a pending housekeeping sequence
+    HAL_ADCEx_MultiModeStop_DMA(&gADCHandle);
+    adcStartConversion();
+    gHousekeepingRequest = true;
+}
+
+/**
+ * @brief Analog watchdog 1 callback (out of window)
+ *
+ * @param hadc ADC handle pointer
+ *
+ * @remark: this HAL_ADC_LevelOutOfWindowCallback function is called automatically by the
+ * STM32 HAL library
+ */
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef* hadc)
+{
+    adcHandleWatchdog(hadc, ADC_ANALOGWATCHDOG_1);
+}
+
+/**
+ * @brief Analog watchdog 2 callback (out of window)
+ *
+ * @param hadc ADC handle pointer
+ *
+ * @remark: this HAL_ADCEx_LevelOutOfWindow2Callback function is called automatically by the
+ * STM32 HAL library
+ */
+void HAL_ADCEx_LevelOutOfWindow2Callback(ADC_HandleTypeDef* hadc)
+{
+    adcHandleWatchdog(hadc, ADC_ANALOGWATCHDOG_2);
+}
+
+/**
+ * @brief Analog watchdog 3 callback (out of window)
+ *
+ * @param hadc ADC handle pointer
+ *
+ * @remark: this HAL_ADCEx_LevelOutOfWindow3Callback function is called automatically by the
+ * STM32 HAL library
+ */
+void HAL_ADCEx_LevelOutOfWindow3Callback(ADC_HandleTypeDef* hadc)
+{
+    adcHandleWatchdog(hadc, ADC_ANALOGWATCHDOG_3);
+}
+
+/**
+ * @brief Configures all supported analog watchdogs with interrupt enabled
+ * and a full scale window (never triggers)
+ *
+ * Channel selection and interrupt enable can only be changed while the ADC
+ * is idle, thresholds can be updated at any time. So the watchdogs are armed
+ * here and adcConfigureWatchdog only narrows the window
+ */
+static void adcInitializeWatchdogs(void)
+{
+    for (int32_t i=0; i<ADC_CHANNEL_COUNT; i++)
+    {
+        if (gWatchdogTable[i].watchdogNumber != ADC_WATCHDOG_NONE)
+        {
+            adcSetWatchdogThresholds(&gWatchdogTable[i], 0, ADC_FULL_SCALE);
+        }
+    }
+}
+
+/**
+ * @brief Writes the configuration of an analog watchdog
+ *
+ * @param pEntry            Watchdog assignment to configure
+ * @param lowThreshold      Lower threshold in digits
+ * @param highThreshold     Upper threshold in digits
+ *
+ * @return Returns ADC_ERR_OK if no error occured
+ */
+static int32_t adcSetWatchdogThresholds(const ADCWatchdogEntry_t* pEntry, uint32_t lowThreshold, uint32_t highThreshold)
+{
+    ADC_AnalogWDGConfTypeDef watchdogConfig = {0};
+
+    watchdogConfig.WatchdogNumber   = pEntry->watchdogNumber;
+    watchdogConfig.WatchdogMode     = pEntry->watchdogMode;
+    watchdogConfig.Channel          = pEntry->channel;
+    watchdogConfig.ITMode           = ENABLE;
+    watchdogConfig.HighThreshold    = highThreshold;
+    watchdogConfig.LowThreshold     = lowThreshold;
+    watchdogConfig.FilteringConfig  = ADC_AWD_FILTERING_NONE;
+
+    if (HAL_ADC_AnalogWDGConfig(pEntry->pHandle, &watchdogConfig) != HAL_OK)
+    {
+        return ADC_ERR_INIT_FAILURE;
+    }
+
+    return ADC_ERR_OK;
+}
+
+/**
+ * @brief Converts the window of a channel with the current ratiometric scale
+ * and writes the thresholds to the watchdog. The registers are written
+ * directly, so this works while the ADC converts and without the HAL lock
+ *
+ * @param adcChannel    Channel with an active window
+ */
+static void adcWriteWatchdogThresholds(ADC_Channel_t adcChannel)
+{
+    const ADCWatchdogEntry_t* pEntry = &gWatchdogTable[adcChannel];
+    ADCWatchdogThresholds_t thresholds;
+
+    // The gain compensation of ADC1 also scales the injected channels, the sensor windows refer to the compensated value
+    uint32_t gain = (pEntry->watchdogMode == ADC_ANALOGWATCHDOG_SINGLE_INJEC) ? gSensorCalibration[ADC_INPUT0].gain : ADC_GAIN_UNITY;
+
+    adcWatchdogComputeThresholds(gWatchdogWindows[adcChannel].lowMicroVolt, gWatchdogWindows[adcChannel].highMicroVolt,
+        gMicroVoltsPerDigitQ16, gain, &thresholds);
+    adcWatchdogWriteThresholds(pEntry->pHandle->Instance, pEntry->thresholdRegister, &thresholds);
+}
+
+/**
+ * @brief Recomputes the thresholds of all active windows after a change of
+ * the ratiometric scale (interrupt context)
+ */
+static void adcUpdateWatchdogThresholds(void)
+{
+    for (int32_t i=0; i<ADC_CHANNEL_COUNT; i++)
+    {
+        if (gWatchdogWindows[i].active)
+        {
+            adcWriteWatchdogThresholds((ADC_Channel_t)i);
+        }
+    }
+}
+
+/**
+ * @brief Clears a pending event of the watchdog of a channel and enables its
+ * interrupt
+ *
+ * @param adcChannel    Channel with an active window
+ */
+static void adcArmWatchdog(ADC_Channel_t adcChannel)
+{
+    const ADCWatchdogEntry_t* pEntry = &gWatchdogTable[adcChannel];
+
+    __HAL_ADC_CLEAR_FLAG(pEntry->pHandle, pEntry->interruptSource);
+    __HAL_ADC_ENABLE_IT(pEntry->pHandle, pEntry->interruptSource);
+}
+
+/**
+ * @brief Dispatches an analog watchdog event to the callback of the logical
+ * channel and disables the watchdog interrupt to avoid an interrupt storm
+ * while the signal stays out of the window
+ *
+ * @param hadc              ADC handle which raised the event
+ * @param watchdogNumber    Analog watchdog which raised the event
+ */
+static void adcHandleWatchdog(ADC_HandleTypeDef* hadc, uint32_t watchdogNumber)
+{
+    for (int32_t i=0; i<ADC_CHANNEL_COUNT; i++)
+    {
+        const ADCWatchdogEntry_t* pEntry = &gWatchdogTable[i];
+
+        if (pEntry->pHandle != 0 && pEntry->pHandle->Instance == hadc->Instance && pEntry->watchdogNumber == watchdogNumber)
+        {
+            __HAL_ADC_DISABLE_IT(hadc, pEntry->interruptSource);
+
+            if (gWatchdogCallbacks[i] != 0)
+            {
+                gWatchdogCallbacks[i]((ADC_Channel_t)i);
+            }
             break;
+        }
+    }
+}
+
+/**
+ * @brief Loads the factory calibration values (VREFINT_CAL, TS_CAL1, TS_CAL2)
+ * and precomputes all constants needed by the ratiometric conversion
+ *
+ * All divisions needed for the conversion are done here once, so the
+ * frame update and the channel conversion only use multiply and shift
+ */
+static void adcInitializeConversion(void)
+{
+    gVrefIntCal     = (int32_t)(*VREFINT_CAL_ADDR);
+    gTempSensorCal1 = (int32_t)(*TEMPSENSOR_CAL1_ADDR);
+
+    int32_t tempSensorCal2 = (int32_t)(*TEMPSENSOR_CAL2_ADDR);
+    int32_t calDelta = tempSensorCal2 - gTempSensorCal1;
+
+    // Temperature slope in 0.1°C per digit (Q16)
+    if (calDelta > 0)
+    {
+        gTempSlopeQ16 = (int32_t)((((TEMPSENSOR_CAL2_TEMP - TEMPSENSOR_CAL1_TEMP) * 10L) << 16) / calDelta);
     }
+    else
+    {
+        gTempSlopeQ16 = 0;
+    }
+
+    // Start with the nominal supply until the first housekeeping sequence provides a VREFINT sample
+    gSupplyRatioQ16         = ADC_NOMINAL_SUPPLY_RATIO_Q16;
+    gMicroVoltsPerDigitQ16  = (uint32_t)(((uint64_t)gSupplyRatioQ16 * ADC_CAL_MICROVOLTS_PER_DIGIT_Q8) >> 8);
 
-    return adcValue;
+    gSupplyMicroVolt        = (int32_t)(((uint64_t)gSupplyRatioQ16 * ADC_CAL_MICROVOLT) >> 16);
+    gTemperature            = TEMPSENSOR_CAL1_TEMP * 10;
+
+    adcFrameInitialize(gSupplyMicroVolt, gTemperature);
 }
 
-int32_t adcReadChannel(ADC_Channel_t adcChannel)
+/**
+ * @brief Restores the position sensor calibration from flash. Without a valid
+ * calibration (or with implausible values) the sensors are uncompensated
+ */
+static void adcLoadSensorCalibration(void)
 {
-    int32_t adcRawValue = adcReadChannelRaw(adcChannel);
-    int32_t adcMicroVoltValue = adcRawValue * MICROVOLTS_PER_DIGIT;
+    if (flashReadParameters(gSensorCalibration, sizeof(gSensorCalibration)) != FLASH_ERR_OK)
+    {
+        memset(gSensorCalibration, 0, sizeof(gSensorCalibration));
+    }
+
+    for (int32_t i=0; i<ADC_SENSOR_COUNT; i++)
+    {
+        ADCSensorCalibration_t* pCalibration = &gSensorCalibration[i];
+
+        if (pCalibration->gain < ADC_GAIN_MIN || pCalibration->gain > ADC_GAIN_MAX ||
+            pCalibration->offset < -ADC_OFFSET_MAX || pCalibration->offset > ADC_OFFSET_MAX)
+        {
+            pCalibration->offset    = 0;
+            pCalibration->gain      = ADC_GAIN_UNITY;
+        }
+    }
 
-    return adcMicroVoltValue;
+    gHousekeepingGainQ16 = ((uint32_t)ADC_GAIN_UNITY << 16) / gSensorCalibration[ADC_INPUT0].gain;
 }
 
+/**
+ * @brief Programs the position sensor calibration into the offset (OFR1) and
+ * gain compensation (GCOMP) registers of ADC1 and ADC2
+ *
+ * These registers can only be written while no conversion is ongoing, so the
+ * dual mode conversion is stopped and restarted around the update. The stop
+ * aborts a pending housekeeping sequence and the new gain changes the
+ * thresholds of the injected watchdogs, so both are restored afterwards
+ */
+static void adcApplySensorCalibration(void)
+{
+    ADC_HandleTypeDef* const handles[ADC_SENSOR_COUNT] = {&gADCHandle, &gADCSlaveHandle};
+    const uint32_t channels[ADC_SENSOR_COUNT] = {ADC_CHANNEL_1, ADC_CHANNEL_2};
+
+    // No ADC/DMA interrupt (error restart, housekeeping, threshold update) while the ADCs are reconfigured
+    HAL_NVIC_DisableIRQ(ADC1_2_IRQn);
+    HAL_NVIC_DisableIRQ(DMA1_Channel1_IRQn);
+
+    HAL_ADCEx_MultiModeStop_DMA(&gADCHandle);
+
+    for (int32_t i=0; i<ADC_SENSOR_COUNT; i++)
+    {
+        const ADCSensorCalibration_t* pCalibration = &gSensorCalibration[i];
+        ADC_TypeDef* pInstance = handles[i]->Instance;
+
+        LL_ADC_SetOffset(pInstance, LL_ADC_OFFSET_1, channels[i], ADC_OFFSET_LEVEL(pCalibration->offset));
+        LL_ADC_SetOffsetSign(pInstance, LL_ADC_OFFSET_1, ADC_OFFSET_SIGN(pCalibration->offset));
+        LL_ADC_SetOffsetSaturation(pInstance, LL_ADC_OFFSET_1, LL_ADC_OFFSET_SATURATION_ENABLE);
+        LL_ADC_SetGainCompensation(pInstance, pCalibration->gain);
+    }
+
+    gHousekeepingGainQ16 = ((uint32_t)ADC_GAIN_UNITY << 16) / gSensorCalibration[ADC_INPUT0].gain;
+
+    // Thresholds with the new gain, events of the old calibration are discarded
+    for (int32_t i=0; i<ADC_CHANNEL_COUNT; i++)
+    {
+        if (gWatchdogWindows[i].active)
+        {
+            adcWriteWatchdogThresholds((ADC_Channel_t)i);
+            adcArmWatchdog((ADC_Channel_t)i);
+        }
+    }
+
+    adcStartConversion();
+    gHousekeepingRequest = true;
+
+    HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+    HAL_NVIC_EnableIRQ(ADC1_2_IRQn);
+}
+
+/**
+ * @brief Starts the dual mode conversion of ADC1/ADC2 with DMA
+ */
+static void adcStartConversion(void)
+{
+    // One DMA transfer per rank pair, this assumes that the DMA peripheral has been already configured
+    HAL_ADCEx_MultiModeStart_DMA(&gADCHandle, gADCValues, ADC_FRAME_LENGTH);
+
+    // Only the transfer complete event is used
+    __HAL_DMA_DISABLE_IT(&gDMA_ADC_Handle, DMA_IT_HT);
+}
+
+/**
+ * @brief Stores the position sensor calibration in flash
+ *
+ * @return Returns ADC_ERR_OK if no error occured
+ */
+static int32_t adcStoreSensorCalibration(void)
+{
+    if (flashWriteParameters(gSensorCalibration, sizeof(gSensorCalibration)) != FLASH_ERR_OK)
+    {
+        return ADC_ERR_STORE_FAILURE;
+    }
+
+    return ADC_ERR_OK;
+}
+
+/**
+ * @brief Reads the injected sequence and updates the ratiometric conversion
+ * factors, the supply voltage and the chip temperature
+ *
+ * VDDA = 3.0V * VREFINT_CAL / VREFINT. The only division is the VREFINT
+ * reciprocal, the channel conversions then are a multiply and shift.
+ */
+static void adcUpdateHousekeeping(void)
+{
+    const uint32_t ranks[ADC_HOUSEKEEPING_LENGTH] = {ADC_INJECTED_RANK_1, ADC_INJECTED_RANK_2, ADC_INJECTED_RANK_3};
+    uint32_t gainQ16 = gHousekeepingGainQ16;
+
+    // The gain compensation of ADC1 is applied to all channels, so it is reverted for the internal channels
+    for (int32_t i=0; i<ADC_HOUSEKEEPING_LENGTH; i++)
+    {
+        gHousekeepingValues[i] = (HAL_ADCEx_InjectedGetValue(&gADCHandle, ranks[i]) * gainQ16 + 0x8000UL) >> 16;
+    }
+
+    if (gHousekeepingValues[IDX_ADC_VREF] == 0)
+    {
+        return;
+    }
+
+    uint32_t supplyRatioQ16 = ((uint32_t)gVrefIntCal << 16) / gHousekeepingValues[IDX_ADC_VREF];
+
+    gSupplyRatioQ16         = supplyRatioQ16;
+    gMicroVoltsPerDigitQ16  = (uint32_t)(((uint64_t)supplyRatioQ16 * ADC_CAL_MICROVOLTS_PER_DIGIT_Q8) >> 8);
+    gSupplyMicroVolt        = (int32_t)(((uint64_t)supplyRatioQ16 * ADC_CAL_MICROVOLT) >> 16);
+
+    // The watchdog windows are defined in µV, so their thresholds follow the measured VDDA
+    adcUpdateWatchdogThresholds();
+
+    // Scale the temperature sample to the calibration VDDA and apply TS_CAL1/TS_CAL2
+    int32_t tempRawQ16 = (int32_t)(gHousekeepingValues[IDX_ADC_TEMP] * supplyRatioQ16) - (gTempSensorCal1 << 16);
+    gTemperature = (int32_t)(TEMPSENSOR_CAL1_TEMP * 10 + (((int64_t)tempRawQ16 * gTempSlopeQ16) >> 32));
+}
+
+/**
+ * @brief Publishes the converted frame of the latest regular scan together
+ * with the latest housekeeping values
+ *
+ * The frame is published with a sequence counter (seqlock, see ADCFrame.h),
+ * so readers can detect and retry a copy overlapping the update
+ *
+ * @remark The injected interrupt has the same priority as the DMA interrupt,
+ * so the housekeeping values cannot change during the update
+ */
+static void adcUpdateConversion(void)
+{
+    int32_t raw[ADC_CHANNEL_COUNT];
+    int32_t microVolt[ADC_CHANNEL_COUNT];
+
+    raw[ADC_INPUT0] = (int32_t)ADC_MASTER_DATA(gADCValues[IDX_ADC_POT_PAIR]);
+    raw[ADC_INPUT1] = (int32_t)ADC_SLAVE_DATA(gADCValues[IDX_ADC_POT_PAIR]);
+    raw[ADC_TEMP]   = (int32_t)gHousekeepingValues[IDX_ADC_TEMP];
+    raw[ADC_VBAT]   = (int32_t)gHousekeepingValues[IDX_ADC_VBAT];
+    raw[ADC_VREF]   = (int32_t)gHousekeepingValues[IDX_ADC_VREF];
+
+    uint32_t microVoltsPerDigitQ16 = gMicroVoltsPerDigitQ16;
+
+    // The conversion is done before the frame update, so the update itself is only a copy
+    for (int32_t i=0; i<ADC_CHANNEL_COUNT; i++)
+    {
+        microVolt[i] = (int32_t)(((uint64_t)raw[i] * microVoltsPerDigitQ16) >> 16);
+    }
+
+    adcFramePublish(raw, microVolt, gSupplyMicroVolt, gTemperature);
+}
+
+
+/**
+ * @brief Initializes ADC2 as multimode slave of ADC1
+ *
+ * In regular simultaneous mode both ADCs need a sequence of the same length
+ * and matching sampling times, so ADC2 samples Pot 2 in its only rank
+ */
+static void adcInitializeSlave(void)
+{
+    ADC_ChannelConfTypeDef sConfig = {0};
+
+    gADCSlaveHandle.Instance 					= ADC2;
+    gADCSlaveHandle.Init.ClockPrescaler 		= ADC_CLOCK_SYNC_PCLK_DIV4;
+    gADCSlaveHandle.Init.Resolution 			= ADC_RESOLUTION_12B;
+    gADCSlaveHandle.Init.DataAlign 				= ADC_DATAALIGN_RIGHT;
+    gADCSlaveHandle.Init.GainCompensation 		= gSensorCalibration[ADC_INPUT1].gain;
+    gADCSlaveHandle.Init.ScanConvMode 			= ADC_SCAN_ENABLE;
+    gADCSlaveHandle.Init.EOCSelection 			= ADC_EOC_SINGLE_CONV;
+    gADCSlaveHandle.Init.LowPowerAutoWait 		= DISABLE;
+    gADCSlaveHandle.Init.ContinuousConvMode 	= DISABLE;
+    gADCSlaveHandle.Init.NbrOfConversion 		= ADC_FRAME_LENGTH;
+    gADCSlaveHandle.Init.DiscontinuousConvMode 	= DISABLE;
+    gADCSlaveHandle.Init.ExternalTrigConv 		= ADC_SOFTWARE_START;
+    gADCSlaveHandle.Init.ExternalTrigConvEdge 	= ADC_EXTERNALTRIGCONVEDGE_NONE;
+    gADCSlaveHandle.Init.DMAContinuousRequests 	= DISABLE;
+    gADCSlaveHandle.Init.Overrun 				= ADC_OVR_DATA_PRESERVED;
+    gADCSlaveHandle.Init.OversamplingMode 		= DISABLE;
+
+    if (HAL_ADC_Init(&gADCSlaveHandle) != HAL_OK)
+    {
+    	Error_Handler();
+    }
+
+	sConfig.Channel 			= ADC_CHANNEL_2;
+	sConfig.Rank 				= ADC_REGULAR_RANK_1;
+	sConfig.SamplingTime 		= ADC_SAMPLETIME_POSITION;
+	sConfig.SingleDiff 			= ADC_SINGLE_ENDED;
+	sConfig.OffsetNumber 		= ADC_OFFSET_1;
+	sConfig.Offset 				= ADC_OFFSET_LEVEL(gSensorCalibration[ADC_INPUT1].offset);
+	sConfig.OffsetSign 			= ADC_OFFSET_SIGN(gSensorCalibration[ADC_INPUT1].offset);
+	sConfig.OffsetSaturation 	= ENABLE;
+	if (HAL_ADC_ConfigChannel(&gADCSlaveHandle, &sConfig) != HAL_OK)
+	{
+		Error_Handler();
+	}
+}
+
+/**
+ * @brief Initializes the injected sequence of ADC1 with the internal channels
+ *
+ * The injected sequence is started by software (see adcStartHousekeeping)
+ * and is independent of the regular simultaneous mode of ADC1/ADC2. The long
+ * sampling time is required by the temperature sensor and VREFINT
+ */
+static void adcInitializeHousekeeping(void)
+{
+    ADC_InjectionConfTypeDef sConfigInjected = {0};
+
+    const uint32_t channels[ADC_HOUSEKEEPING_LENGTH] = {ADC_CHANNEL_TEMPSENSOR_ADC1, ADC_CHANNEL_VBAT, ADC_CHANNEL_VREFINT};
+    const uint32_t ranks[ADC_HOUSEKEEPING_LENGTH] = {ADC_INJECTED_RANK_1, ADC_INJECTED_RANK_2, ADC_INJECTED_RANK_3};
+
+	sConfigInjected.InjectedSamplingTime 			= ADC_SAMPLETIME_HOUSEKEEPING;
+	sConfigInjected.InjectedSingleDiff 				= ADC_SINGLE_ENDED;
+	sConfigInjected.InjectedOffsetNumber 			= ADC_OFFSET_NONE;
+	sConfigInjected.InjectedOffset 					= 0;
+	sConfigInjected.InjectedNbrOfConversion 		= ADC_HOUSEKEEPING_LENGTH;
+	sConfigInjected.InjectedDiscontinuousConvMode 	= DISABLE;
+	sConfigInjected.AutoInjectedConv 				= DISABLE;
+	sConfigInjected.QueueInjectedContext 			= DISABLE;
+	sConfigInjected.ExternalTrigInjecConv 			= ADC_INJECTED_SOFTWARE_START;
+	sConfigInjected.ExternalTrigInjecConvEdge 		= ADC_EXTERNALTRIGINJECCONV_EDGE_NONE;
+	sConfigInjected.InjecOversamplingMode 			= DISABLE;
+
+	for (int32_t i=0; i<ADC_HOUSEKEEPING_LENGTH; i++)
+	{
+		sConfigInjected.InjectedChannel = channels[i];
+		sConfigInjected.InjectedRank 	= ranks[i];
+		if (HAL_ADCEx_InjectedConfigChannel(&gADCHandle, &sConfigInjected) != HAL_OK)
+		{
+			Error_Handler();
+		}
+	}
+}
 
 /**
  * @brief Initializes the DMA peripheral (DMA1) for use with the ADC block
@@ -290,6 +1084,7 @@ void DMA1_Channel1_IRQHandler(void)
 void ADC1_2_IRQHandler(void)
 {
     HAL_ADC_IRQHandler(&gADCHandle);
+    HAL_ADC_IRQHandler(&gADCSlaveHandle);
 }
 
 
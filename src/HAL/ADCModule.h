@@ -12,6 +12,7 @@
 #ifndef _ADC_MODULE_H
 #define _ADC_MODULE_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 /*
@@ -19,6 +20,20 @@
 */
 #define ADC_ERR_OK                  0               //!< No error occured
 #define ADC_ERR_INIT_FAILURE        -1              //!< Error during ADC initialization
+#define ADC_ERR_INVALID_PTR         -2              //!< Invalid pointer (Null Pointer)
+#define ADC_ERR_INVALID_PARAM       -3              //!< Invalid parameter value
+#define ADC_ERR_BUSY                -4              //!< Data couldn't be read consistently (frame update in progress)
+#define ADC_ERR_STORE_FAILURE       -5              //!< Calibration is active but couldn't be stored persistently
+
+#define ADC_CHANNEL_COUNT           5               //!< Total number of used ADC channels
+#define ADC_SENSOR_COUNT            2               //!< Number of position sensors with hardware compensation (ADC_INPUT0, ADC_INPUT1)
+
+#define ADC_GAIN_UNITY              4096            //!< Gain compensation coefficient for a gain of 1.0
+
+#define ADC_SEQUENCE_MASK           0x7FFFFFFFUL    //!< Frame sequence numbers wrap at 2^31 (the seqlock counts two steps per frame)
+
+//! Number of frames from sequence number a to b, correct across the wrap
+#define ADC_SEQUENCE_DISTANCE(a, b) (((uint32_t)(b) - (uint32_t)(a)) & ADC_SEQUENCE_MASK)
 
 /**
  * @brief Enumeration for used ADC channels
@@ -33,6 +48,59 @@ typedef enum _ADC_Channel_
     ADC_VREF                //!< ADC Channel 4 used for internal reference voltage
 } ADC_Channel_t;
 
+/**
+ * @brief Struct which represents a coherent frame of all ADC channels,
+ * i.e. all values belong to the same scan
+ *
+ */
+typedef struct _ADCSnapshot
+{
+    uint32_t sequence;                          //!< Sequence number of the frame (incremented with every completed scan, see ADC_SEQUENCE_MASK)
+    bool newData;                               //!< Flag to indicate whether the frame is newer than the one of the previous read
+    int32_t raw[ADC_CHANNEL_COUNT];             //!< Raw values in digits, indexed by ADC_Channel_t
+    int32_t microVolt[ADC_CHANNEL_COUNT];       //!< Ratiometric converted values in microvolt [µV], indexed by ADC_Channel_t
+    int32_t supplyMicroVolt;                    //!< Analog supply voltage (VDDA) of the frame in microvolt [µV]
+    int32_t temperature;                        //!< Calibrated chip temperature of the frame in 0.1°C
+} ADCSnapshot_t;
+
+/**
+ * @brief Struct for one point of the two-point sensor calibration
+ *
+ */
+typedef struct _ADCCalibrationPoint
+{
+    int32_t measured;                           //!< Uncompensated ADC value in digits at the reference position
+    int32_t expected;                           //!< Expected ADC value in digits at the reference position
+} ADCCalibrationPoint_t;
+
+/**
+ * @brief Struct for the compensation of a position sensor, which is applied
+ * by the ADC itself: value = (raw - offset) * gain / ADC_GAIN_UNITY
+ *
+ */
+typedef struct _ADCSensorCalibration
+{
+    int32_t offset;                             //!< Offset in digits (OFR1 register of the ADC)
+    uint32_t gain;                              //!< Gain compensation coefficient (GCOMP register of the ADC)
+} ADCSensorCalibration_t;
+
+/**
+ * @brief Struct with the error counters of the ADC/DMA data path
+ *
+ */
+typedef struct _ADCErrorCounters
+{
+    uint32_t overrun;                           //!< Number of ADC overruns (conversion result not read by the DMA in time)
+    uint32_t dmaError;                          //!< Number of DMA transfer errors
+} ADCErrorCounters_t;
+
+/**
+ * @brief Function pointer for analog watchdog callbacks
+ *
+ * @remark The callback is executed in interrupt context
+ */
+typedef void (*ADCWatchdogCallback)(ADC_Channel_t adcChannel);
+
 /**
  * @brief Initialize the ADC peripheral block
  *
@@ -42,7 +110,10 @@ int32_t adcInitialize();
 
 /**
  * @brief Reads an ADC channel by returning the global ADC value read via
- * interrupt and DMA and converts it to millivolt
+ * interrupt and DMA and converts it to microvolt
+ *
+ * The conversion is ratiometric: the real VDDA is derived from the VREFINT
+ * channel of the housekeeping sequence and the factory calibration value VREFINT_CAL
  *
  * @param adcChannel Channel to read
  *
@@ -50,9 +121,150 @@ int32_t adcInitialize();
  */
 int32_t adcReadChannel(ADC_Channel_t adcChannel);
 
+/**
+ * @brief Copies a coherent frame of all ADC channels
+ *
+ * The copy is lock-free against the conversion complete interrupt which
+ * publishes the frames: if a frame update overlaps with the copy, the copy
+ * is retried.
+ *
+ * @remark The snapshot struct should be kept by the caller between calls
+ * (initialized with zero). The sequence of the previous read is used to set
+ * the newData flag, so callers can skip processing of an already known frame
+ *
+ * @param pSnapshot Pointer to the snapshot to update
+ *
+ * @return Returns ADC_ERR_OK if no error occured, ADC_ERR_BUSY if no
+ * consistent copy could be made
+ */
+int32_t adcReadSnapshot(ADCSnapshot_t* pSnapshot);
+
+/**
+ * @brief Copies the frame following the one of the previous read, so every
+ * frame can be processed in order
+ *
+ * The last frames are kept in a ring (see ADCFrame.h). A frame which has
+ * already been overwritten is skipped, the gap shows in the sequence. If no
+ * newer frame exists, the snapshot is kept and newData is cleared
+ *
+ * @param pSnapshot Pointer to the snapshot of the previous read
+ *
+ * @return Returns ADC_ERR_OK if no error occured, ADC_ERR_BUSY if no
+ * consistent copy could be made
+ */
+int32_t adcReadNextSnapshot(ADCSnapshot_t* pSnapshot);
+
+/**
+ * @brief Converts a voltage to ADC digits using the current ratiometric
+ * conversion factor (inverse of adcReadChannel)
+ *
+ * @param microVolt Voltage in microvolt [µV]
+ *
+ * @return Returns the corresponding ADC value in digits (limited to 0..4095)
+ */
+int32_t adcMicroVoltToDigits(int32_t microVolt);
+
+/**
+ * @brief Programs the hardware analog watchdog of a channel with the provided
+ * window. If a conversion falls outside the window, the callback is called
+ * directly from the ADC interrupt and the watchdog interrupt is disabled until
+ * the watchdog is configured again
+ *
+ * @remark Analog watchdogs are available for ADC_INPUT0/ADC_INPUT1 (AWD1, 12 bit),
+ * ADC_TEMP (AWD2, 8 bit) and ADC_VREF (AWD3, 8 bit). The window is kept in µV,
+ * its thresholds are reprogrammed with every housekeeping sequence, so they
+ * follow the measured VDDA
+ *
+ * @param adcChannel        Channel to monitor
+ * @param lowMicroVolt      Lower limit of the window in microvolt [µV]
+ * @param highMicroVolt     Upper limit of the window in microvolt [µV]
+ * @param pCallback         Callback for out-of-window events
+ *
+ * @return Returns ADC_ERR_OK if no error occured
+ */
+int32_t adcConfigureWatchdog(ADC_Channel_t adcChannel, int32_t lowMicroVolt, int32_t highMicroVolt, ADCWatchdogCallback pCallback);
+
+/**
+ * @brief Captures one point of the two-point calibration of a position sensor
+ *
+ * The sensor has to be held at the reference position while the point is
+ * captured. The currently active compensation is removed from the sample,
+ * so a sensor can be calibrated again at any time
+ *
+ * @param adcChannel            Position sensor (ADC_INPUT0 or ADC_INPUT1)
+ * @param expectedMicroVolt     Ideal sensor voltage at the reference position in microvolt [µV]
+ * @param pPoint                Pointer to store the calibration point
+ *
+ * @return Returns ADC_ERR_OK if no error occured
+ */
+int32_t adcCaptureCalibrationPoint(ADC_Channel_t adcChannel, int32_t expectedMicroVolt, ADCCalibrationPoint_t* pPoint);
+
+/**
+ * @brief Computes offset and gain of a position sensor from two calibration
+ * points, programs them into the compensation registers of the ADC and
+ * stores them in flash, so they are restored by adcInitialize after a reset
+ *
+ * @remark The conversions are stopped for a few microseconds while the
+ * registers are written
+ *
+ * @param adcChannel    Position sensor (ADC_INPUT0 or ADC_INPUT1)
+ * @param pLow          Calibration point at the lower reference position
+ * @param pHigh         Calibration point at the upper reference position
+ *
+ * @return Returns ADC_ERR_OK if no error occured, ADC_ERR_INVALID_PARAM if
+ * the points result in an implausible gain or offset
+ */
+int32_t adcCalibrateSensor(ADC_Channel_t adcChannel, const ADCCalibrationPoint_t* pLow, const ADCCalibrationPoint_t* pHigh);
+
+/**
+ * @brief Removes the calibration of a position sensor (offset 0, gain 1.0)
+ *
+ * @param adcChannel    Position sensor (ADC_INPUT0 or ADC_INPUT1)
+ *
+ * @return Returns ADC_ERR_OK if no error occured
+ */
+int32_t adcResetSensorCalibration(ADC_Channel_t adcChannel);
+
+/**
+ * @brief Copies the error counters of the ADC/DMA data path. After an
+ * error, the dual mode conversion is restarted automatically
+ *
+ * @param pCounters Pointer to store the counters
+ *
+ * @return Returns ADC_ERR_OK if no error occured
+ */
+int32_t adcReadErrorCounters(ADCErrorCounters_t* pCounters);
+
+/**
+ * @brief Returns the analog supply voltage (VDDA) measured via VREFINT
+ * in the latest frame
+ *
+ * @return Returns VDDA in microvolt [µV]
+ */
+int32_t adcReadSupplyVoltage();
+
+/**
+ * @brief Requests a conversion of the housekeeping channels (Temp, VBat and
+ * VREFINT). These channels are converted in the injected sequence of ADC1,
+ * which is started right after the next regular scan
+ *
+ * @remark Should be called periodically (e.g. every 100ms), the results are
+ * part of all frames published afterwards
+ */
+void adcStartHousekeeping();
+
+/**
+ * @brief Returns the chip temperature of the latest frame, calibrated
+ * with the factory values TS_CAL1 and TS_CAL2
+ *
+ * @return Returns the temperature in 0.1°C
+ */
+int32_t adcReadTemperature();
+
 /**
  * @brief Reads an ADC channel by returning the global ADC value read via
- * interrupt and DMA
+ * interrupt and DMA. For the position sensors the value already contains the
+ * offset and gain compensation
  *
  * @param adcChannel Channel to read
  *
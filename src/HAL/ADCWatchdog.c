@@ -0,0 +1,89 @@
+/**
+ * @file ADCWatchdog.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of the threshold calculation of the analog watchdogs
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "ADCWatchdog.h"
+
+/*
+ * Private Defines
+*/
+#define ADC_WDG_SHIFT_8BIT          4           //!< AWD2/AWD3 compare the result bits 11:4
+
+/*
+ * Private Module Functions
+*/
+static uint32_t adcWatchdogToDigits(int32_t microVolt, uint64_t divisor, uint32_t gain, uint64_t roundUp);
+
+/*
+ * Public Module Functions
+*/
+
+void adcWatchdogComputeThresholds(int32_t lowMicroVolt, int32_t highMicroVolt, uint32_t microVoltsPerDigitQ16,
+    uint32_t gain, ADCWatchdogThresholds_t* pThresholds)
+{
+    // digits = µV / (µV / digit) * gain / ADC_WDG_GAIN_UNITY, with a single division
+    uint64_t divisor = (uint64_t)microVoltsPerDigitQ16 * ADC_WDG_GAIN_UNITY;
+
+    pThresholds->low    = adcWatchdogToDigits(lowMicroVolt, divisor, gain, 0);
+    pThresholds->high   = adcWatchdogToDigits(highMicroVolt, divisor, gain, divisor - 1);
+}
+
+void adcWatchdogWriteThresholds(ADC_TypeDef* pInstance, uint32_t watchdog, const ADCWatchdogThresholds_t* pThresholds)
+{
+    if (watchdog == ADC_WDG_AWD1)
+    {
+        MODIFY_REG(pInstance->TR1, ADC_TR1_HT1 | ADC_TR1_LT1,
+            (pThresholds->high << ADC_TR1_HT1_Pos) | (pThresholds->low << ADC_TR1_LT1_Pos));
+        return;
+    }
+
+    // 8 bit thresholds: the low threshold is truncated, the high threshold rounded up
+    uint32_t low = pThresholds->low >> ADC_WDG_SHIFT_8BIT;
+    uint32_t high = (pThresholds->high + (1UL << ADC_WDG_SHIFT_8BIT) - 1) >> ADC_WDG_SHIFT_8BIT;
+
+    if (high > (ADC_WDG_FULL_SCALE >> ADC_WDG_SHIFT_8BIT))
+    {
+        high = ADC_WDG_FULL_SCALE >> ADC_WDG_SHIFT_8BIT;
+    }
+
+    if (watchdog == ADC_WDG_AWD2)
+    {
+        WRITE_REG(pInstance->TR2, (high << ADC_TR2_HT2_Pos) | (low << ADC_TR2_LT2_Pos));
+    }
+    else if (watchdog == ADC_WDG_AWD3)
+    {
+        WRITE_REG(pInstance->TR3, (high << ADC_TR3_HT3_Pos) | (low << ADC_TR3_LT3_Pos));
+    }
+}
+
+/**
+ * @brief Converts a voltage into compensated digits (inverse of the
+ * ratiometric conversion)
+ *
+ * @param microVolt     Voltage in µV
+ * @param divisor       Ratiometric conversion factor in µV / digit (Q16) times ADC_WDG_GAIN_UNITY
+ * @param gain          Gain compensation of the compared result
+ * @param roundUp       Added before the division (0 rounds down, divisor - 1 rounds up)
+ *
+ * @return Returns the digits limited to 0..ADC_WDG_FULL_SCALE
+ */
+static uint32_t adcWatchdogToDigits(int32_t microVolt, uint64_t divisor, uint32_t gain, uint64_t roundUp)
+{
+    if (microVolt <= 0 || divisor == 0)
+    {
+        return 0;
+    }
+
+    // µV < 2^31, gain < 2^14: the product fits into 64 bit
+    uint64_t digits = ((((uint64_t)microVolt << 16) * gain) + roundUp) / divisor;
+
+    return (digits > ADC_WDG_FULL_SCALE) ? ADC_WDG_FULL_SCALE : (uint32_t)digits;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file ADCWatchdog.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Header file for the threshold calculation of the analog watchdogs
+ *
+ * The watchdog windows are configured in µV, the ADC compares digits. The
+ * conversion depends on the measured VDDA, so the thresholds are recomputed
+ * whenever the housekeeping lane updates the ratiometric scale. The
+ * thresholds are written directly to the TRx registers (allowed while the
+ * ADC converts), so an update doesn't need the HAL handle and can be done
+ * from the ADC interrupt
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _ADC_WATCHDOG_H_
+#define _ADC_WATCHDOG_H_
+
+#include <stdint.h>
+
+#include "stm32g4xx_hal.h"
+
+/*
+ * Public Defines
+*/
+#define ADC_WDG_AWD1                1           //!< Analog watchdog 1 (12 bit thresholds in TR1)
+#define ADC_WDG_AWD2                2           //!< Analog watchdog 2 (8 bit thresholds in TR2, compares bits 11:4)
+#define ADC_WDG_AWD3                3           //!< Analog watchdog 3 (8 bit thresholds in TR3, compares bits 11:4)
+
+#define ADC_WDG_FULL_SCALE          4095        //!< Highest threshold in digits (12 bit ADC)
+#define ADC_WDG_GAIN_UNITY          4096        //!< Gain compensation coefficient (GCOMP) for a gain of 1.0
+
+/*
+ * Public Types
+*/
+
+/**
+ * @brief Thresholds of an analog watchdog in digits (12 bit)
+ *
+ */
+typedef struct _ADCWatchdogThresholds
+{
+    uint32_t low;                               //!< Lower threshold in digits
+    uint32_t high;                              //!< Upper threshold in digits
+} ADCWatchdogThresholds_t;
+
+/*
+ * Public Interface
+*/
+
+/**
+ * @brief Converts a window in µV into watchdog thresholds with the current
+ * ratiometric scale
+ *
+ * The watchdog compares the result after the gain compensation (GCOMP), so
+ * the thresholds are scaled with the gain of the monitored ADC. The window is
+ * rounded outwards (low threshold down, high threshold up), so a value inside
+ * the µV window never triggers the watchdog. The thresholds are limited to
+ * 0..ADC_WDG_FULL_SCALE
+ *
+ * @param lowMicroVolt              Lower limit of the window in µV
+ * @param highMicroVolt             Upper limit of the window in µV
+ * @param microVoltsPerDigitQ16     Ratiometric conversion factor in µV / digit (Q16)
+ * @param gain                      Gain compensation applied to the compared result (ADC_WDG_GAIN_UNITY for none)
+ * @param pThresholds               Pointer to store the thresholds
+ */
+void adcWatchdogComputeThresholds(int32_t lowMicroVolt, int32_t highMicroVolt, uint32_t microVoltsPerDigitQ16,
+    uint32_t gain, ADCWatchdogThresholds_t* pThresholds);
+
+/**
+ * @brief Writes the thresholds of an analog watchdog into its TRx register
+ *
+ * AWD2 and AWD3 only compare the upper 8 bits of the result, their window is
+ * rounded outwards as well. The filter setting of TR1 is kept
+ *
+ * @param pInstance     ADC instance of the watchdog
+ * @param watchdog      Watchdog number (ADC_WDG_AWD1..ADC_WDG_AWD3)
+ * @param pThresholds   Thresholds in digits (12 bit)
+ */
+void adcWatchdogWriteThresholds(ADC_TypeDef* pInstance, uint32_t watchdog, const ADCWatchdogThresholds_t* pThresholds);
+
+#endif
@@ -3,6 +3,13 @@
  * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
  * @brief Implementation of the Button Module
  *
+ * Every edge of a button raises an EXTI interrupt, which stores the button,
+ * its level and a µs timestamp in a single producer / single consumer
+ * queue. Both EXTI interrupts have the same priority and don't preempt each
+ * other, so they form a single producer. The queue is lock free: the
+ * interrupts only write the head index, buttonReadEvent only the tail
+ * index
+ *
  * @version 0.1
  * @date 2023-02-23
  *
@@ -10,11 +17,72 @@
  *
  */
 
+#include <stdbool.h>
+
 #include "stm32g4xx_hal.h"
 
 #include "HardwareConfig.h"
+#include "TimerModule.h"
 #include "ButtonModule.h"
 
+/*
+ * Private Defines
+*/
+#define BUTTON_QUEUE_SIZE       16          //!< Number of edges in the queue (power of two)
+#define BUTTON_EXTI_PRIORITY    1           //!< Priority of the EXTI interrupts (below the ADC, above the trigger timer)
+
+/*
+ * Private Types
+*/
+
+/**
+ * @brief Raw edge captured by the EXTI interrupt
+ *
+ */
+typedef struct _ButtonEdge
+{
+    uint32_t timestamp;                     //!< Time of the edge in µs
+    uint8_t button;                         //!< Button_t of the edge
+    uint8_t pressed;                        //!< Level after the edge (1 = pressed)
+} ButtonEdge_t;
+
+/**
+ * @brief Hardware configuration and debounce state of a button
+ *
+ */
+typedef struct _ButtonState
+{
+    GPIO_TypeDef* pPort;                    //!< GPIO port of the button
+    uint16_t pin;                           //!< GPIO pin of the button
+    bool activeHigh;                        //!< Level of a pressed button
+    Button_Status_t status;                 //!< Debounced state
+    uint32_t lastEdgeTime;                  //!< Time of the last accepted edge in µs
+    bool pendingChange;                     //!< The button settled in the other state while bouncing
+    uint32_t pendingTime;                   //!< Time of the first edge towards the pending state
+} ButtonState_t;
+
+/*
+ * Private Global Variables
+*/
+static ButtonState_t gButtons[BTN_COUNT] =
+{
+    {SW1_GPIO_PORT, SW1_PIN,    false,  BUTTON_RELEASED,    0,  false,  0},     // BTN_ACTIVATE (internal pull-up)
+    {SW2_GPIO_PORT, SW2_PIN,    false,  BUTTON_RELEASED,    0,  false,  0},     // BTN_RACE_MODE (internal pull-up)
+    {B1_GPIO_PORT,  B1_PIN,     true,   BUTTON_RELEASED,    0,  false,  0}      // BTN_USER (external pull-down)
+};
+
+static ButtonEdge_t gEdgeQueue[BUTTON_QUEUE_SIZE];     //!< Captured edges
+static volatile uint32_t gEdgeHead;                     //!< Write index (EXTI interrupts only)
+static volatile uint32_t gEdgeTail;                     //!< Read index (buttonReadEvent only)
+static volatile uint32_t gEdgeOverflows;                //!< Number of edges lost due to a full queue
+
+/*
+ * Private Functions
+*/
+static void buttonCaptureEdge(Button_t button, uint32_t timestamp);
+static bool buttonDebounceEdge(const ButtonEdge_t* pEdge, ButtonEvent_t* pEvent);
+static bool buttonCheckPending(uint32_t now, ButtonEvent_t* pEvent);
+
 
 int32_t buttonInitialize()
 {
@@ -26,58 +94,222 @@ int32_t buttonInitialize()
 	  __HAL_RCC_GPIOA_CLK_ENABLE();
 	  __HAL_RCC_GPIOB_CLK_ENABLE();
 
+	  gEdgeHead = 0;
+	  gEdgeTail = 0;
 
 	  /*Configure GPIO pin : PtPin */
 	  GPIO_InitStruct.Pin 	= B1_PIN;
-	  GPIO_InitStruct.Mode 	= GPIO_MODE_INPUT;
+	  GPIO_InitStruct.Mode 	= GPIO_MODE_IT_RISING_FALLING;
 	  GPIO_InitStruct.Pull 	= GPIO_NOPULL;
 	  HAL_GPIO_Init(B1_GPIO_PORT, &GPIO_InitStruct);
 
 
 	  /*Configure GPIO pin : PtPin */
 	  GPIO_InitStruct.Pin = SW1_PIN;
-	  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+	  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
 	  GPIO_InitStruct.Pull = GPIO_PULLUP;
 	  HAL_GPIO_Init(SW1_GPIO_PORT, &GPIO_InitStruct);
 
 	  /*Configure GPIO pin : PtPin */
 	  GPIO_InitStruct.Pin = SW2_PIN;
-	  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+	  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
 	  GPIO_InitStruct.Pull = GPIO_PULLUP;
 	  HAL_GPIO_Init(SW2_GPIO_PORT, &GPIO_InitStruct);
 
+	  // Start with the current levels, the first edges are accepted immediately
+	  for (uint32_t i=0; i<BTN_COUNT; i++)
+	  {
+	      bool level = (HAL_GPIO_ReadPin(gButtons[i].pPort, gButtons[i].pin) == GPIO_PIN_SET);
+	      gButtons[i].status = (level == gButtons[i].activeHigh) ? BUTTON_PRESSED : BUTTON_RELEASED;
+	      gButtons[i].lastEdgeTime = timerGetMicroseconds() - BUTTON_DEBOUNCE_US;
+	  }
+
+	  /* EXTI interrupt init: SW2 (PB3) on EXTI3, SW1 (PA10) and B1 (PC13) on EXTI15_10 */
+	  HAL_NVIC_SetPriority(EXTI3_IRQn, BUTTON_EXTI_PRIORITY, 0);
+	  HAL_NVIC_EnableIRQ(EXTI3_IRQn);
+	  HAL_NVIC_SetPriority(EXTI15_10_IRQn, BUTTON_EXTI_PRIORITY, 0);
+	  HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+
     return BUTTON_ERR_OK;
 }
 
 Button_Status_t buttonGetButtonStatus(Button_t button)
 {
-    GPIO_PinState gpioStatus = GPIO_PIN_RESET;
-    Button_Status_t buttonStatus = BUTTON_RELEASED;
+    if (button >= BTN_COUNT)
+    {
+        return BUTTON_RELEASED;
+    }
+
+    return gButtons[button].status;
+}
+
+int32_t buttonReadEvent(ButtonEvent_t* pEvent)
+{
+    if (pEvent == 0)
+    {
+        return BUTTON_ERR_INVALID_PTR;
+    }
 
-    switch (button)
+    while (gEdgeTail != gEdgeHead)
     {
-        // Read the Ground Floor button (internal pull-up --> GPIO=1 ==> Button released)
-        case BTN_ACTIVATE:
+        uint32_t tail = gEdgeTail;
+        ButtonEdge_t edge = gEdgeQueue[tail];
+
+        // A pending state which has settled before this edge is reported first (edge stays queued)
+        if (buttonCheckPending(edge.timestamp, pEvent))
+        {
+            return BUTTON_ERR_OK;
+        }
+
+        // The slot is copied before it is released to the producer
+        __DMB();
+        gEdgeTail = (tail + 1) & (BUTTON_QUEUE_SIZE - 1);
+
+        if (buttonDebounceEdge(&edge, pEvent))
         {
-            gpioStatus = HAL_GPIO_ReadPin(SW1_GPIO_PORT, SW1_PIN);
-            if (gpioStatus == GPIO_PIN_RESET)
-                buttonStatus = BUTTON_PRESSED;
-            else
-                buttonStatus = BUTTON_RELEASED;
+            return BUTTON_ERR_OK;
         }
-        break;
+    }
+
+    return buttonCheckPending(timerGetMicroseconds(), pEvent) ? BUTTON_ERR_OK : BUTTON_ERR_NO_EVENT;
+}
 
-        // Read the First Floor button (internal pull-up --> GPIO=1 ==> Button released)
-        case BTN_RACE_MODE:
+/**
+ * @brief Applies the debouncing to a captured edge
+ *
+ * @param pEdge     Pointer to the captured edge
+ * @param pEvent    Pointer to store the resulting event
+ *
+ * @return Returns true if the edge produced an event
+ */
+static bool buttonDebounceEdge(const ButtonEdge_t* pEdge, ButtonEvent_t* pEvent)
+{
+    ButtonState_t* pButton = &gButtons[pEdge->button];
+    Button_Status_t status = pEdge->pressed ? BUTTON_PRESSED : BUTTON_RELEASED;
+
+    if ((uint32_t)(pEdge->timestamp - pButton->lastEdgeTime) < BUTTON_DEBOUNCE_US)
+    {
+        // Bouncing: remember where the button settles, the first edge towards a new state counts
+        if (status == pButton->status)
+        {
+            pButton->pendingChange = false;
+        }
+        else if (!pButton->pendingChange)
         {
-            gpioStatus = HAL_GPIO_ReadPin(SW2_GPIO_PORT, SW2_PIN);
-            if (gpioStatus == GPIO_PIN_RESET)
-                buttonStatus = BUTTON_PRESSED;
-            else
-                buttonStatus = BUTTON_RELEASED;
+            pButton->pendingChange  = true;
+            pButton->pendingTime    = pEdge->timestamp;
         }
-        break;
+        return false;
     }
 
-    return buttonStatus;
+    pButton->pendingChange = false;
+
+    if (status == pButton->status)
+    {
+        return false;
+    }
+
+    pButton->status         = status;
+    pButton->lastEdgeTime   = pEdge->timestamp;
+
+    pEvent->button      = (Button_t)pEdge->button;
+    pEvent->status      = status;
+    pEvent->timestamp   = pEdge->timestamp;
+
+    return true;
+}
+
+/**
+ * @brief Reports a pending state change once the debounce time after the
+ * last accepted edge has elapsed
+ *
+ * @param now       Current time (or time of the next edge) in µs
+ * @param pEvent    Pointer to store the resulting event
+ *
+ * @return Returns true if a pending change was reported
+ */
+static bool buttonCheckPending(uint32_t now, ButtonEvent_t* pEvent)
+{
+    for (uint32_t i=0; i<BTN_COUNT; i++)
+    {
+        ButtonState_t* pButton = &gButtons[i];
+
+        if (pButton->pendingChange && (uint32_t)(now - pButton->lastEdgeTime) >= BUTTON_DEBOUNCE_US)
+        {
+            pButton->pendingChange  = false;
+            pButton->status         = (pButton->status == BUTTON_PRESSED) ? BUTTON_RELEASED : BUTTON_PRESSED;
+            pButton->lastEdgeTime   = pButton->lastEdgeTime + BUTTON_DEBOUNCE_US;
+
+            pEvent->button      = (Button_t)i;
+            pEvent->status      = pButton->status;
+            pEvent->timestamp   = pButton->pendingTime;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Stores an edge of a button in the queue (interrupt context)
+ *
+ * @param button    Button which raised the interrupt
+ * @param timestamp Time of the interrupt in µs
+ */
+static void buttonCaptureEdge(Button_t button, uint32_t timestamp)
+{
+    const ButtonState_t* pButton = &gButtons[button];
+    uint32_t head = gEdgeHead;
+    uint32_t next = (head + 1) & (BUTTON_QUEUE_SIZE - 1);
+
+    if (next == gEdgeTail)
+    {
+        gEdgeOverflows++;
+        return;
+    }
+
+    bool level = ((pButton->pPort->IDR & pButton->pin) != 0);
+
+    gEdgeQueue[head].timestamp  = timestamp;
+    gEdgeQueue[head].button     = (uint8_t)button;
+    gEdgeQueue[head].pressed    = (level == pButton->activeHigh) ? 1 : 0;
+
+    // The slot is written before it is published to the consumer
+    __DMB();
+    gEdgeHead = next;
+}
+
+/**
+  * @brief This function handles the EXTI line 3 interrupt (SW2)
+  */
+void EXTI3_IRQHandler(void)
+{
+    uint32_t timestamp = timerGetMicroseconds();
+
+    if (__HAL_GPIO_EXTI_GET_IT(SW2_PIN) != 0)
+    {
+        __HAL_GPIO_EXTI_CLEAR_IT(SW2_PIN);
+        buttonCaptureEdge(BTN_RACE_MODE, timestamp);
+    }
+}
+
+/**
+  * @brief This function handles the EXTI lines 10 to 15 interrupt (SW1, B1)
+  */
+void EXTI15_10_IRQHandler(void)
+{
+    uint32_t timestamp = timerGetMicroseconds();
+
+    if (__HAL_GPIO_EXTI_GET_IT(SW1_PIN) != 0)
+    {
+        __HAL_GPIO_EXTI_CLEAR_IT(SW1_PIN);
+        buttonCaptureEdge(BTN_ACTIVATE, timestamp);
+    }
+
+    if (__HAL_GPIO_EXTI_GET_IT(B1_PIN) != 0)
+    {
+        __HAL_GPIO_EXTI_CLEAR_IT(B1_PIN);
+        buttonCaptureEdge(BTN_USER, timestamp);
+    }
 }
@@ -3,6 +3,9 @@
  * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
  * @brief Header file for the Button Module
  *
+ * The buttons are captured by EXTI edge interrupts with a µs timestamp and
+ * debounced on these timestamps, there is no polling of the GPIOs
+ *
  * @version 0.1
  * @date 2023-02-23
  *
@@ -12,10 +15,16 @@
 #ifndef _BUTTON_MODULE_H_
 #define _BUTTON_MODULE_H_
 
+#include <stdint.h>
+
 /*
  * Public Defines
 */
-#define BUTTON_ERR_OK      0            //!< No error occured
+#define BUTTON_ERR_OK           0           //!< No error occured
+#define BUTTON_ERR_INVALID_PTR  -1          //!< Invalid pointer (Null Pointer)
+#define BUTTON_ERR_NO_EVENT     -2          //!< No new button event available
+
+#define BUTTON_DEBOUNCE_US      20000UL     //!< Edges within 20ms after an accepted edge are treated as bouncing
 
 /**
  * @brief Enumeration of available Buttons and their usage
@@ -24,7 +33,9 @@
 typedef enum _Button_t
 {
     BTN_ACTIVATE,                   	//!< Button used to activate/deactivate the system (SW1)
-    BTN_RACE_MODE                     	//!< Button used for race mode (SW2)
+    BTN_RACE_MODE,                     	//!< Button used for race mode (SW2)
+    BTN_USER,                           //!< User button of the Nucleo board (B1)
+    BTN_COUNT                           //!< Number of buttons
 } Button_t;
 
 /**
@@ -38,23 +49,47 @@ typedef enum _Button_Status_t
 } Button_Status_t;
 
 /**
- * @brief Initialize the GPIOs for the Button inputs
+ * @brief Debounced button event
+ *
+ */
+typedef struct _ButtonEvent
+{
+    Button_t button;                    //!< Button which changed its state
+    Button_Status_t status;             //!< New state of the button
+    uint32_t timestamp;                 //!< Time of the first edge of the change in µs (timerGetMicroseconds)
+} ButtonEvent_t;
+
+/**
+ * @brief Initialize the GPIOs and EXTI interrupts for the Button inputs
  *
  * @return Returns BUTTON_ERR_OK if no error occured
  */
 int32_t buttonInitialize();
 
 /**
- * @brief Reads the input status of the button
+ * @brief Returns the debounced status of the button
  *
  * @param button Button to read the status from
  *
  * @returns Returns the button status (pressed or released)
  *
- * @remark This function doesn't do any debouncing. It just reads
- * the pure GPIO state
+ * @remark The status is updated by buttonReadEvent, so the events must be
+ * read cyclically
  */
 Button_Status_t buttonGetButtonStatus(Button_t button);
 
+/**
+ * @brief Debounces the captured edges and returns the next button event.
+ * An edge is accepted immediately (with the timestamp of the interrupt) if
+ * the button was stable for BUTTON_DEBOUNCE_US, further edges within this
+ * time are bouncing. If the button settled in a different state during the
+ * bouncing, this state is reported once the time has elapsed
+ *
+ * @param pEvent     Pointer to store the event
+ *
+ * @return Returns BUTTON_ERR_OK if an event was read, BUTTON_ERR_NO_EVENT
+ * if no event is available
+ */
+int32_t buttonReadEvent(ButtonEvent_t* pEvent);
 
 #endif
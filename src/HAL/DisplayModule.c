@@ -3,6 +3,14 @@
  * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
  * @brief Implementation of the 7-Segement display module
  *
+ * Both displays share the segment lines, the COM pin selects the display
+ * (common anode floor display with inverted segments, common cathode error
+ * display). The update interrupt of TIM7 alternates between the displays
+ * and writes a precomputed glyph with one BSRR write per port, so the
+ * application only writes digits into the frame buffer. The display pins
+ * are owned by this interrupt and are not part of the process image (the
+ * image commit never touches pins it didn't change)
+ *
  * @version 0.1
  * @date 2023-02-22
  *
@@ -16,53 +24,110 @@
 #include "HardwareConfig.h"
 #include "DisplayModule.h"
 
+/*
+ * Private Defines
+*/
+#define DISPLAY_TIMER_CLOCK_HZ      1000000UL   //!< Counter clock of TIM7 after the prescaler
+#define DISPLAY_REFRESH_HZ          200UL       //!< Refresh rate of each display (flicker free)
+#define DISPLAY_COUNT               2           //!< Number of multiplexed displays
+#define DISPLAY_TIMER_PRIORITY      3           //!< Interrupt priority of the refresh timer
+
+/* Segment bits of the encoding table */
+#define SEG_A                       0x01
+#define SEG_B                       0x02
+#define SEG_C                       0x04
+#define SEG_D                       0x08
+#define SEG_E                       0x10
+#define SEG_F                       0x20
+#define SEG_G                       0x40
+
+/* Segments A-E are on _7SEGA_GPIO_PORT, F and G on _7SEGF_GPIO_PORT */
+#define SEG_PORT1_MASK              (_7SEGA_PIN | _7SEGB_PIN | _7SEGC_PIN | _7SEGD_PIN | _7SEGE_PIN)
+#define SEG_PORT2_MASK              (_7SEGF_PIN | _7SEGG_PIN)
+
+//! Pins of the first segment port which are set for the segment bits
+#define SEG_PORT1_PINS(seg)         ((((seg) & SEG_A) ? _7SEGA_PIN : 0) | (((seg) & SEG_B) ? _7SEGB_PIN : 0) | \
+                                     (((seg) & SEG_C) ? _7SEGC_PIN : 0) | (((seg) & SEG_D) ? _7SEGD_PIN : 0) | \
+                                     (((seg) & SEG_E) ? _7SEGE_PIN : 0))
+
+//! Pins of the second segment port which are set for the segment bits
+#define SEG_PORT2_PINS(seg)         ((((seg) & SEG_F) ? _7SEGF_PIN : 0) | (((seg) & SEG_G) ? _7SEGG_PIN : 0))
+
+/* MODER bits of the COM pin: the field of pin n starts at bit 2n, and for
+ * the single bit mask 2^n the square 2^2n is exactly that bit
+*/
+#define COM_MODER_MASK              ((uint32_t)_7SEG_COM_PIN * _7SEG_COM_PIN * 3UL)     //!< Mode field of the COM pin
+#define COM_MODER_OUTPUT            ((uint32_t)_7SEG_COM_PIN * _7SEG_COM_PIN)           //!< General purpose output mode
+
+//! BSRR word which sets the given pins and resets the other pins of the mask
+#define SEG_BSRR(mask, pins)        ((uint32_t)(pins) | ((uint32_t)((mask) & ~(pins)) << 16))
+
+//! Glyph of the floor display (segments inverted, COM high)
+#define GLYPH_FLOOR(seg)            {SEG_BSRR(SEG_PORT1_MASK, SEG_PORT1_PINS(~(seg))), SEG_BSRR(SEG_PORT2_MASK, SEG_PORT2_PINS(~(seg))), \
+                                     SEG_BSRR(_7SEG_COM_PIN, _7SEG_COM_PIN)}
+
+//! Glyph of the error display (COM low)
+#define GLYPH_ERROR(seg)            {SEG_BSRR(SEG_PORT1_MASK, SEG_PORT1_PINS(seg)), SEG_BSRR(SEG_PORT2_MASK, SEG_PORT2_PINS(seg)), \
+                                     SEG_BSRR(_7SEG_COM_PIN, 0)}
+
+//! Glyphs of both displays (indexed by Display_t)
+#define GLYPH(seg)                  {GLYPH_FLOOR(seg), GLYPH_ERROR(seg)}
+
+/*
+ * Private Types
+*/
+
 /**
- * @brief Internal type to represent the activation of the 7-segments
+ * @brief BSRR words to show a glyph on one of the displays
  *
- * A bit field is used to demonstrate the usage of such a bit field
- * Other implementations might be more efficient
  */
-typedef struct _SegmentEncodingEntry
+typedef struct _DisplayGlyph
 {
-    unsigned int segA : 1;      //!< Bit for activate/deactivate segment A
-    unsigned int segB : 1;      //!< Bit for activate/deactivate segment B
-    unsigned int segC : 1;      //!< Bit for activate/deactivate segment C
-    unsigned int segD : 1;      //!< Bit for activate/deactivate segment D
-    unsigned int segE : 1;      //!< Bit for activate/deactivate segment E
-    unsigned int segF : 1;      //!< Bit for activate/deactivate segment F
-    unsigned int segG : 1;      //!< Bit for activate/deactivate segment G
-} SegmentEncodingEntry;
+    uint32_t bsrrPort1;                 //!< Segments A-E
+    uint32_t bsrrPort2;                 //!< Segments F and G
+    uint32_t bsrrCom;                   //!< Display selection
+} DisplayGlyph_t;
+
+/*
+ * Private Module Variables
+*/
 
 /**
- * @brief Encoding table for the specific LED segments on a single 7-Segment
- * display
+ * @brief Glyph table for both display polarities
  *
  */
-static SegmentEncodingEntry gSegmentEncodingTable[] =
+static const DisplayGlyph_t gGlyphTable[DIGIT_OFF + 1][DISPLAY_COUNT] =
 {
-//   a, b, c, d, e, f, g
-    {1, 1, 1, 1, 1, 1, 0},  // 0
-    {0, 1, 1, 0, 0, 0, 0},  // 1
-    {1, 1, 0, 1, 1, 0, 1},  // 2
-    {1, 1, 1, 1, 0, 0, 1},  // 3
-    {0, 1, 1, 0, 0, 1, 1},  // 4
-    {1, 0, 1, 1, 0, 1, 1},  // 5
-    {1, 0, 1, 1, 1, 1, 1},  // 6
-    {1, 1, 1, 0, 0, 0, 0},  // 7
-    {1, 1, 1, 1, 1, 1, 1},  // 8
-    {1, 1, 1, 0, 0, 1, 1},  // 9
-    {1, 1, 1, 0, 1, 1, 1},  // A
-    {0, 0, 1, 1, 1, 1, 1},  // B
-    {1, 0, 0, 1, 1, 1, 0},  // C
-    {0, 1, 1, 1, 1, 0, 1},  // D
-    {1, 0, 0, 1, 1, 1, 1},  // E
-    {1, 0, 0, 0, 1, 1, 1},  // F
-    {0, 0, 0, 0, 0, 0, 1},  // - (DIGIT_DASH)
-    {1, 1, 0, 0, 0, 1, 1},  // o (DIGIT_UPPER_O)
-    {0, 0, 1, 1, 1, 0, 1},  // o (DIGIT_LOWER_O)
-    {0, 0, 0, 0, 0, 0, 0},  // Off (DIGIT_OFF)
+    GLYPH(SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F),           // 0
+    GLYPH(SEG_B | SEG_C),                                           // 1
+    GLYPH(SEG_A | SEG_B | SEG_D | SEG_E | SEG_G),                   // 2
+    GLYPH(SEG_A | SEG_B | SEG_C | SEG_D | SEG_G),                   // 3
+    GLYPH(SEG_B | SEG_C | SEG_F | SEG_G),                           // 4
+    GLYPH(SEG_A | SEG_C | SEG_D | SEG_F | SEG_G),                   // 5
+    GLYPH(SEG_A | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G),           // 6
+    GLYPH(SEG_A | SEG_B | SEG_C),                                   // 7
+    GLYPH(SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G),   // 8
+    GLYPH(SEG_A | SEG_B | SEG_C | SEG_F | SEG_G),                   // 9
+    GLYPH(SEG_A | SEG_B | SEG_C | SEG_E | SEG_F | SEG_G),           // A
+    GLYPH(SEG_C | SEG_D | SEG_E | SEG_F | SEG_G),                   // B
+    GLYPH(SEG_A | SEG_D | SEG_E | SEG_F),                           // C
+    GLYPH(SEG_B | SEG_C | SEG_D | SEG_E | SEG_G),                   // D
+    GLYPH(SEG_A | SEG_D | SEG_E | SEG_F | SEG_G),                   // E
+    GLYPH(SEG_A | SEG_E | SEG_F | SEG_G),                           // F
+    GLYPH(SEG_G),                                                   // - (DIGIT_DASH)
+    GLYPH(SEG_A | SEG_B | SEG_F | SEG_G),                           // o (DIGIT_UPPER_O)
+    GLYPH(SEG_C | SEG_D | SEG_E | SEG_G),                           // o (DIGIT_LOWER_O)
+    GLYPH(0),                                                       // Off (DIGIT_OFF)
 };
 
+static TIM_HandleTypeDef gTimer7Handle;                             //! Global handle for Timer 7 (TIM7) peripheral (refresh)
+static const DisplayGlyph_t* volatile gpFrame[DISPLAY_COUNT];       //!< Frame buffer (glyph of each display)
+static uint32_t gActiveDisplay;                                     //!< Display shown by the last refresh
+
+/*
+ * Public Module Functions
+*/
+
 int32_t displayInitialize()
 {
     GPIO_InitTypeDef GPIO_InitStruct = {0};
@@ -103,46 +168,69 @@ int32_t displayInitialize()
     GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
     HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 
+    gpFrame[FLOOR_DISPLAY] = &gGlyphTable[DIGIT_OFF][FLOOR_DISPLAY];
+    gpFrame[ERROR_DISPLAY] = &gGlyphTable[DIGIT_OFF][ERROR_DISPLAY];
+
+    /* Refresh timer: 128 MHz / 128 = 1 MHz counter clock, one interrupt per
+     * display ==> each display is refreshed with DISPLAY_REFRESH_HZ
+     * (HAL_TIM_Base_MspInit belongs to the Timer Module, so the clock and
+     * the interrupt are enabled here)
+    */
+    __HAL_RCC_TIM7_CLK_ENABLE();
+
+    gTimer7Handle.Instance                  = TIM7;
+    gTimer7Handle.Init.Prescaler            = (128000000UL / DISPLAY_TIMER_CLOCK_HZ) - 1;
+    gTimer7Handle.Init.CounterMode          = TIM_COUNTERMODE_UP;
+    gTimer7Handle.Init.Period               = (DISPLAY_TIMER_CLOCK_HZ / (DISPLAY_REFRESH_HZ * DISPLAY_COUNT)) - 1;
+    gTimer7Handle.Init.AutoReloadPreload    = TIM_AUTORELOAD_PRELOAD_ENABLE;
+
+    if (HAL_TIM_Base_Init(&gTimer7Handle) != HAL_OK)
+    {
+        return DISPLAY_ERR_INIT_FAILURE;
+    }
+
+    HAL_NVIC_SetPriority(TIM7_DAC_IRQn, DISPLAY_TIMER_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(TIM7_DAC_IRQn);
+
+    HAL_TIM_Base_Start_IT(&gTimer7Handle);
+
     return DISPLAY_ERR_OK;
 }
 
 int32_t displayShowDigit(Display_t outputDisplay, int8_t digit)
 {
-    if (digit >= 0 && digit <= DIGIT_OFF)
+    if ((uint32_t)outputDisplay >= DISPLAY_COUNT || digit < 0 || digit > DIGIT_OFF)
     {
-        // Get the entry out of the encoding table
-        SegmentEncodingEntry entry = gSegmentEncodingTable[digit];
-
-        // If the Floor Display is used, we need to invert all bits
-        // due to the differnce between common anode and common kathode
-        if (outputDisplay == FLOOR_DISPLAY)
-        {
-            entry.segA = !entry.segA;
-            entry.segB = !entry.segB;
-            entry.segC = !entry.segC;
-            entry.segD = !entry.segD;
-            entry.segE = !entry.segE;
-            entry.segF = !entry.segF;
-            entry.segG = !entry.segG;
-
-            /* Activate the Error Display */
-            HAL_GPIO_WritePin(GPIOB, _7SEG_COM_PIN, GPIO_PIN_SET);
-        }
-        else
-        {
-            /* Activate the Floor Display */
-            HAL_GPIO_WritePin(GPIOB, _7SEG_COM_PIN, GPIO_PIN_RESET);
-        }
-
-        // Write the single segments
-        HAL_GPIO_WritePin(_7SEGA_GPIO_PORT, _7SEGA_PIN, entry.segA);
-        HAL_GPIO_WritePin(_7SEGB_GPIO_PORT, _7SEGB_PIN, entry.segB);
-        HAL_GPIO_WritePin(_7SEGC_GPIO_PORT, _7SEGC_PIN, entry.segC);
-        HAL_GPIO_WritePin(_7SEGD_GPIO_PORT, _7SEGD_PIN, entry.segD);
-        HAL_GPIO_WritePin(_7SEGE_GPIO_PORT, _7SEGE_PIN, entry.segE);
-        HAL_GPIO_WritePin(_7SEGF_GPIO_PORT, _7SEGF_PIN, entry.segF);
-        HAL_GPIO_WritePin(_7SEGG_GPIO_PORT, _7SEGG_PIN, entry.segG);
+        return DISPLAY_ERR_INVALID_PARAM;
     }
 
+    // A pointer write is atomic, the refresh interrupt sees the old or the new glyph
+    gpFrame[outputDisplay] = &gGlyphTable[digit][outputDisplay];
+
     return DISPLAY_ERR_OK;
 }
+
+/**
+  * @brief This function handles TIM7 global interrupt (display refresh).
+  */
+void TIM7_DAC_IRQHandler(void)
+{
+    __HAL_TIM_CLEAR_IT(&gTimer7Handle, TIM_IT_UPDATE);
+
+    gActiveDisplay ^= 1;
+    const DisplayGlyph_t* pGlyph = gpFrame[gActiveDisplay];
+
+    /* The displays have opposite polarities on the shared lines, so there is
+     * no segment level which is dark for both COM levels. COM is released
+     * first (input mode), with the common line floating no display conducts
+     * while the segments change. The new COM level is latched in ODR and
+     * driven again after the segments
+    */
+    _7SEG_COM_GPIO_PORT->MODER &= ~COM_MODER_MASK;
+
+    _7SEGA_GPIO_PORT->BSRR      = pGlyph->bsrrPort1;
+    _7SEGF_GPIO_PORT->BSRR      = pGlyph->bsrrPort2;
+    _7SEG_COM_GPIO_PORT->BSRR   = pGlyph->bsrrCom;
+
+    _7SEG_COM_GPIO_PORT->MODER |= COM_MODER_OUTPUT;
+}
@@ -10,7 +10,7 @@
  *
  */
 #ifndef _DISPLAY_MODULE_H_
-#define _DISPLAC_MODULE_H_
+#define _DISPLAY_MODULE_H_
 
 #include <stdint.h>
 
@@ -19,6 +19,7 @@
 */
 #define DISPLAY_ERR_OK                  0           //!< No error occured
 #define DISPLAY_ERR_INIT_FAILURE        -1          //!< Error during display initialization
+#define DISPLAY_ERR_INVALID_PARAM       -2          //!< Invalid display or digit
 
 /* Defines for special digits for 7-Segment display */
 #define DIGIT_DASH                      (16)        //!< Index in the encoding table for "-"
@@ -37,19 +38,22 @@ typedef enum _Display
 } Display_t;
 
 /**
- * @brief Initializes the Display Module
+ * @brief Initializes the Display Module and starts the refresh timer
+ * (both displays off)
  *
  * @return Returns DISPLAY_ERR_OK if no error occured, otherwiese DISPLAY_ERR_INIT_FAILURE
  */
 int32_t displayInitialize();
 
 /**
- * @brief Displays a digit on the 7-Segment display
+ * @brief Displays a digit on the 7-Segment display. The digit is written
+ * into the frame buffer, the refresh interrupt multiplexes both displays
  *
  * @param outputDisplay Display to output to
- * @param digit The digit (0-9 and A-F)
+ * @param digit The digit (0-9 and A-F) or one of the special digits
  *
- * @return Returns DISPLAY_ERR_OK if no error occured
+ * @return Returns DISPLAY_ERR_OK if no error occured, DISPLAY_ERR_INVALID_PARAM
+ * for an invalid display or digit
  */
 int32_t displayShowDigit(Display_t outputDisplay, int8_t digit);
 
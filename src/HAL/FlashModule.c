@@ -0,0 +1,194 @@
+/**
+ * @file FlashModule.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of the Flash Module. The parameter block is stored
+ * in the last 4KB of the flash, which are excluded from the FLASH region of
+ * the linker script (see PARAM region in VP.ld)
+ *
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <string.h>
+
+#include "stm32g4xx_hal.h"
+
+#include "FlashModule.h"
+
+/*
+ * Private Defines
+*/
+#define FLASH_PARAM_ADDRESS         0x0807F000UL        //!< Start address of the parameter page (ORIGIN of PARAM in VP.ld)
+#define FLASH_PARAM_MAGIC           0x50415241UL        //!< Magic number of a valid parameter block ("PARA")
+
+#define FLASH_DUAL_BANK_PAGE_SIZE   0x800UL             //!< Page size in dual bank mode (DBANK = 1)
+#define FLASH_SINGLE_BANK_PAGE_SIZE 0x1000UL            //!< Page size in single bank mode (DBANK = 0)
+
+/*
+ * Private Types
+*/
+
+/**
+ * @brief Header stored in front of the parameter block, the size is a
+ * multiple of the flash programming unit (double word)
+ *
+ */
+typedef struct _FlashParamHeader
+{
+    uint32_t magic;                                 //!< FLASH_PARAM_MAGIC
+    uint32_t size;                                  //!< Size of the parameter block in bytes
+    uint32_t checksum;                              //!< Checksum of the parameter block
+    uint32_t checksumInv;                           //!< Inverted checksum (detects a page which has only been partially programmed)
+} FlashParamHeader_t;
+
+/*
+ * Private Module Variables
+*/
+
+/**
+ * @brief Image of the parameter page (header and block), padded to double words
+ */
+static uint64_t gFlashImage[(sizeof(FlashParamHeader_t) + FLASH_PARAM_MAX_SIZE) / sizeof(uint64_t)];
+
+/*
+ * Private Module Functions
+*/
+static uint32_t flashChecksum(const uint8_t* pData, uint32_t size);
+static void flashGetPage(uint32_t* pBank, uint32_t* pPage);
+
+/*
+ * Public Module Functions
+*/
+
+int32_t flashReadParameters(void* pData, uint32_t size)
+{
+    if (pData == 0)
+    {
+        return FLASH_ERR_INVALID_PTR;
+    }
+
+    if (size == 0 || size > FLASH_PARAM_MAX_SIZE)
+    {
+        return FLASH_ERR_INVALID_SIZE;
+    }
+
+    const FlashParamHeader_t* pHeader = (const FlashParamHeader_t*)FLASH_PARAM_ADDRESS;
+    const uint8_t* pBlock = (const uint8_t*)(FLASH_PARAM_ADDRESS + sizeof(FlashParamHeader_t));
+
+    if (pHeader->magic != FLASH_PARAM_MAGIC || pHeader->size != size)
+    {
+        return FLASH_ERR_NO_DATA;
+    }
+
+    uint32_t checksum = flashChecksum(pBlock, size);
+    if (pHeader->checksum != checksum || pHeader->checksumInv != ~checksum)
+    {
+        return FLASH_ERR_NO_DATA;
+    }
+
+    memcpy(pData, pBlock, size);
+
+    return FLASH_ERR_OK;
+}
+
+int32_t flashWriteParameters(const void* pData, uint32_t size)
+{
+    if (pData == 0)
+    {
+        return FLASH_ERR_INVALID_PTR;
+    }
+
+    if (size == 0 || size > FLASH_PARAM_MAX_SIZE)
+    {
+        return FLASH_ERR_INVALID_SIZE;
+    }
+
+    FlashParamHeader_t header;
+    header.magic        = FLASH_PARAM_MAGIC;
+    header.size         = size;
+    header.checksum     = flashChecksum((const uint8_t*)pData, size);
+    header.checksumInv  = ~header.checksum;
+
+    // Build the page image, unused bytes stay erased (0xFF)
+    memset(gFlashImage, 0xFF, sizeof(gFlashImage));
+    memcpy(gFlashImage, &header, sizeof(header));
+    memcpy((uint8_t*)gFlashImage + sizeof(header), pData, size);
+
+    uint32_t doubleWords = (sizeof(header) + size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    FLASH_EraseInitTypeDef eraseInit = {0};
+    uint32_t pageError = 0;
+    int32_t result = FLASH_ERR_OK;
+
+    flashGetPage(&eraseInit.Banks, &eraseInit.Page);
+    eraseInit.TypeErase = FLASH_TYPEERASE_PAGES;
+    eraseInit.NbPages   = 1;
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+
+    if (HAL_FLASHEx_Erase(&eraseInit, &pageError) != HAL_OK)
+    {
+        result = FLASH_ERR_WRITE_FAILURE;
+    }
+
+    for (uint32_t i=0; i<doubleWords && result == FLASH_ERR_OK; i++)
+    {
+        if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, FLASH_PARAM_ADDRESS + i * sizeof(uint64_t), gFlashImage[i]) != HAL_OK)
+        {
+            result = FLASH_ERR_WRITE_FAILURE;
+        }
+    }
+
+    HAL_FLASH_Lock();
+
+    return result;
+}
+
+/**
+ * @brief Calculates a simple additive checksum (Adler like) of a data block
+ *
+ * @param pData     Pointer to the data
+ * @param size      Size of the data in bytes
+ *
+ * @return Returns the checksum
+ */
+static uint32_t flashChecksum(const uint8_t* pData, uint32_t size)
+{
+    uint32_t sumA = 1;
+    uint32_t sumB = 0;
+
+    for (uint32_t i=0; i<size; i++)
+    {
+        sumA = (sumA + pData[i]) % 65521UL;
+        sumB = (sumB + sumA) % 65521UL;
+    }
+
+    return (sumB << 16) | sumA;
+}
+
+/**
+ * @brief Determines bank and page number of the parameter page, which depend
+ * on the bank configuration (option bit DBANK)
+ *
+ * @param pBank     Pointer to store the bank
+ * @param pPage     Pointer to store the page number within the bank
+ */
+static void flashGetPage(uint32_t* pBank, uint32_t* pPage)
+{
+    if (READ_BIT(FLASH->OPTR, FLASH_OPTR_DBANK) != 0)
+    {
+        uint32_t bankSize = FLASH_BANK_SIZE;
+        uint32_t offset = FLASH_PARAM_ADDRESS - FLASH_BASE;
+
+        *pBank = (offset >= bankSize) ? FLASH_BANK_2 : FLASH_BANK_1;
+        *pPage = (offset % bankSize) / FLASH_DUAL_BANK_PAGE_SIZE;
+    }
+    else
+    {
+        *pBank = FLASH_BANK_1;
+        *pPage = (FLASH_PARAM_ADDRESS - FLASH_BASE) / FLASH_SINGLE_BANK_PAGE_SIZE;
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ * @file FlashModule.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Header file for the Flash Module, which provides a small
+ * parameter block in a reserved flash page (persistent across resets)
+ *
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _FLASH_MODULE_H_
+#define _FLASH_MODULE_H_
+
+#include <stdint.h>
+
+/*
+ * Public Defines
+*/
+#define FLASH_ERR_OK                0           //!< No error occured
+#define FLASH_ERR_INVALID_PTR       -1          //!< Invalid pointer (Null Pointer)
+#define FLASH_ERR_INVALID_SIZE      -2          //!< Parameter block doesn't fit into the parameter page
+#define FLASH_ERR_NO_DATA           -3          //!< Parameter page is empty or doesn't contain a valid block of this size
+#define FLASH_ERR_WRITE_FAILURE     -4          //!< Erasing or programming the parameter page failed
+
+#define FLASH_PARAM_MAX_SIZE        256         //!< Maximum size of the parameter block in bytes
+
+/**
+ * @brief Reads the parameter block from the parameter page
+ *
+ * The block is only returned if the magic number, the size and the checksum
+ * stored with it are valid
+ *
+ * @param pData     Pointer to the buffer for the parameter block
+ * @param size      Size of the parameter block in bytes
+ *
+ * @return Returns FLASH_ERR_OK if a valid block was read, FLASH_ERR_NO_DATA
+ * if the page doesn't contain a valid block
+ */
+int32_t flashReadParameters(void* pData, uint32_t size);
+
+/**
+ * @brief Erases the parameter page and writes the parameter block to it
+ *
+ * @remark The erase stalls flash accesses of the CPU to the same bank for
+ * up to ~20ms, so this function should only be used during calibration
+ *
+ * @param pData     Pointer to the parameter block
+ * @param size      Size of the parameter block in bytes
+ *
+ * @return Returns FLASH_ERR_OK if no error occured
+ */
+int32_t flashWriteParameters(const void* pData, uint32_t size);
+
+#endif
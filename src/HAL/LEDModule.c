@@ -3,6 +3,14 @@
  * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
  * @brief Implementation of the LED module
  *
+ * Every LED has a channel with the running pattern. The update interrupt of
+ * TIM4 counts down the duration of the current step and applies the next
+ * step, a LED without pattern costs one compare per interrupt. PWM LEDs are
+ * written to the compare register (active at the next PWM period), the other
+ * LEDs to the process image. Changes by tasks are written with the commit at
+ * the end of the cycle, pattern steps of the interrupt are committed by the
+ * interrupt itself, so blinking doesn't depend on the task cycle
+ *
  * @version 0.1
  * @date 2023-02-13
  *
@@ -12,8 +20,95 @@
 
 #include "stm32g4xx_hal.h"
 
+#include "CriticalSection.h"
 #include "HardwareConfig.h"
 #include "LEDModule.h"
+#include "ProcessImage.h"
+
+/*
+ * Private Defines
+*/
+#define LED_PWM_CLOCK_HZ            1000000UL   //!< Counter clock of TIM4 after the prescaler
+#define LED_PWM_PERIOD              1000UL      //!< Counts per PWM period (1 kHz, also the pattern tick)
+
+//! Interrupt priority of the pattern timer (below the ADC and the buttons)
+#define LED_TIMER_PRIORITY          3
+
+/*
+ * Private Types
+*/
+
+/**
+ * @brief Hardware of a LED
+ *
+ */
+typedef struct _LEDPin
+{
+    GPIO_TypeDef* pPort;                //!< GPIO port of the LED
+    uint16_t pin;                       //!< GPIO pin of the LED
+    bool pwm;                           //!< LED is driven by a PWM channel of TIM4
+    uint32_t channel;                   //!< TIM4 channel of a PWM LED
+} LEDPin_t;
+
+/**
+ * @brief Runtime state of a LED
+ *
+ */
+typedef struct _LEDChannel
+{
+    const LEDPattern_t* pPattern;       //!< Running pattern (0 = constant brightness)
+    uint32_t step;                      //!< Current step of the pattern
+    uint32_t remainingMs;               //!< Remaining duration of the current step in ms
+    uint8_t brightness;                 //!< Current brightness
+} LEDChannel_t;
+
+/*
+ * Private Module Variables
+*/
+static TIM_HandleTypeDef gTimer4Handle;         //! Global handle for Timer 4 (TIM4) peripheral (PWM and pattern tick)
+
+//! Hardware of the LEDs (indexed by LED_t)
+static const LEDPin_t gLEDs[LED_COUNT] =
+{
+    {LED0_GPIO_PORT, LED0_PIN, false, 0},
+    {LED1_GPIO_PORT, LED1_PIN, false, 0},
+    {LED2_GPIO_PORT, LED2_PIN, false, 0},
+    {LED3_GPIO_PORT, LED3_PIN, true, TIM_CHANNEL_4},
+    {LED4_GPIO_PORT, LED4_PIN, true, TIM_CHANNEL_3}
+};
+
+static volatile LEDChannel_t gChannels[LED_COUNT];
+
+/*
+ * Predefined Patterns
+*/
+static const LEDPatternStep_t gBlinkSlowSteps[]     = {{LED_BRIGHTNESS_MAX, 500}, {0, 500}};
+static const LEDPatternStep_t gBlinkFastSteps[]     = {{LED_BRIGHTNESS_MAX, 100}, {0, 100}};
+static const LEDPatternStep_t gFlashSteps[]         = {{LED_BRIGHTNESS_MAX, 50}, {0, 950}};
+static const LEDPatternStep_t gDoubleFlashSteps[]   = {{LED_BRIGHTNESS_MAX, 50}, {0, 100}, {LED_BRIGHTNESS_MAX, 50}, {0, 800}};
+static const LEDPatternStep_t gBreatheSteps[]       =
+{
+    {0, 100}, {10, 100}, {25, 100}, {50, 100}, {75, 100},
+    {100, 100}, {75, 100}, {50, 100}, {25, 100}, {10, 100}
+};
+
+#define LED_STEPS(steps)            (steps), (uint8_t)(sizeof(steps) / sizeof((steps)[0]))
+
+const LEDPattern_t gLedPatternBlinkSlow     = {LED_STEPS(gBlinkSlowSteps), true};
+const LEDPattern_t gLedPatternBlinkFast     = {LED_STEPS(gBlinkFastSteps), true};
+const LEDPattern_t gLedPatternFlash         = {LED_STEPS(gFlashSteps), true};
+const LEDPattern_t gLedPatternDoubleFlash   = {LED_STEPS(gDoubleFlashSteps), true};
+const LEDPattern_t gLedPatternBreathe       = {LED_STEPS(gBreatheSteps), true};
+
+/*
+ * Private Module Functions
+*/
+static void ledApply(uint32_t led, uint8_t brightness);
+static void ledStartStep(uint32_t led, uint32_t step);
+
+/*
+ * Public Module Functions
+*/
 
 int32_t ledInitialize()
 {
@@ -32,7 +127,7 @@ int32_t ledInitialize()
 	HAL_GPIO_WritePin(GPIOA, _7SEGA_PIN | _7SEGB_PIN | _7SEGC_PIN | _7SEGD_PIN | _7SEGE_PIN, GPIO_PIN_RESET);
 
 	/*Configure GPIO pin Output Level */
-	HAL_GPIO_WritePin(GPIOB, _7SEG_COM_PIN | LED1_PIN | LED0_PIN | LED4_PIN | LED3_PIN, GPIO_PIN_RESET);
+	HAL_GPIO_WritePin(GPIOB, _7SEG_COM_PIN | LED1_PIN | LED0_PIN, GPIO_PIN_RESET);
 
 
 	/*Configure GPIO pins : PCPin PCPin PCPin */
@@ -50,71 +145,199 @@ int32_t ledInitialize()
 	GPIO_InitStruct.Speed	 = GPIO_SPEED_FREQ_LOW;
 	HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
-	/*Configure GPIO pins : PBPin PBPin PBPin PBPin
-						   PBPin PBPin */
-	GPIO_InitStruct.Pin 	= _7SEG_COM_PIN | LED1_PIN | LED0_PIN | LED4_PIN | LED3_PIN;
+	/*Configure GPIO pins : PBPin PBPin PBPin */
+	GPIO_InitStruct.Pin 	= _7SEG_COM_PIN | LED1_PIN | LED0_PIN;
 	GPIO_InitStruct.Mode 	= GPIO_MODE_OUTPUT_PP;
 	GPIO_InitStruct.Pull 	= GPIO_NOPULL;
 	GPIO_InitStruct.Speed 	= GPIO_SPEED_FREQ_LOW;
 	HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 
+	/*Configure GPIO pins : LED4 (TIM4_CH3) LED3 (TIM4_CH4) */
+	GPIO_InitStruct.Pin 	= LED4_PIN | LED3_PIN;
+	GPIO_InitStruct.Mode 	= GPIO_MODE_AF_PP;
+	GPIO_InitStruct.Pull 	= GPIO_NOPULL;
+	GPIO_InitStruct.Speed 	= GPIO_SPEED_FREQ_LOW;
+	GPIO_InitStruct.Alternate = GPIO_AF2_TIM4;
+	HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+    /* PWM and pattern timer: 128 MHz / 128 = 1 MHz counter clock, 1000 counts
+     * ==> 1 kHz PWM frequency and one update interrupt per ms
+    */
+    TIM_OC_InitTypeDef sConfigOC = {0};
+
+    gTimer4Handle.Instance                  = TIM4;
+    gTimer4Handle.Init.Prescaler            = (128000000UL / LED_PWM_CLOCK_HZ) - 1;
+    gTimer4Handle.Init.CounterMode          = TIM_COUNTERMODE_UP;
+    gTimer4Handle.Init.Period               = LED_PWM_PERIOD - 1;
+    gTimer4Handle.Init.ClockDivision        = TIM_CLOCKDIVISION_DIV1;
+    gTimer4Handle.Init.AutoReloadPreload    = TIM_AUTORELOAD_PRELOAD_ENABLE;
+
+    if (HAL_TIM_PWM_Init(&gTimer4Handle) != HAL_OK)
+    {
+        return LED_ERR_INIT_FAILURE;
+    }
+
+    sConfigOC.OCMode        = TIM_OCMODE_PWM1;
+    sConfigOC.Pulse         = 0;
+    sConfigOC.OCPolarity    = TIM_OCPOLARITY_HIGH;
+    sConfigOC.OCFastMode    = TIM_OCFAST_DISABLE;
+
+    if (HAL_TIM_PWM_ConfigChannel(&gTimer4Handle, &sConfigOC, TIM_CHANNEL_3) != HAL_OK ||
+        HAL_TIM_PWM_ConfigChannel(&gTimer4Handle, &sConfigOC, TIM_CHANNEL_4) != HAL_OK)
+    {
+        return LED_ERR_INIT_FAILURE;
+    }
+
+    __HAL_TIM_ENABLE_IT(&gTimer4Handle, TIM_IT_UPDATE);
+    HAL_TIM_PWM_Start(&gTimer4Handle, TIM_CHANNEL_3);
+    HAL_TIM_PWM_Start(&gTimer4Handle, TIM_CHANNEL_4);
+
     return LED_ERR_OK;
 }
 
 void ledToggleLED(LED_t led)
 {
-    switch(led)
+    if ((uint32_t)led < LED_COUNT)
     {
-        case LED0_APP_STATUS:
-            HAL_GPIO_TogglePin(LED0_GPIO_PORT, LED0_PIN);
-            break;
+        ledSetBrightness(led, (gChannels[led].brightness != 0) ? 0 : LED_BRIGHTNESS_MAX);
+    }
+}
 
-        case LED1_DOOR_STATUS:
-            HAL_GPIO_TogglePin(LED1_GPIO_PORT, LED1_PIN);
-            break;
+void ledSetLED(LED_t led, LED_Status_t ledStatus)
+{
+    ledSetBrightness(led, (ledStatus == LED_ON) ? LED_BRIGHTNESS_MAX : 0);
+}
 
-        case LED2_EMERGENCY:
-            HAL_GPIO_TogglePin(LED2_GPIO_PORT, LED2_PIN);
-            break;
+int32_t ledSetBrightness(LED_t led, uint8_t brightness)
+{
+    if ((uint32_t)led >= LED_COUNT || brightness > LED_BRIGHTNESS_MAX)
+    {
+        return LED_ERR_INVALID_PARAM;
+    }
 
-        case LED3_MOTOR_STATUS:
-            HAL_GPIO_TogglePin(LED3_GPIO_PORT, LED3_PIN);
-            break;
+    CRITICAL_SECTION_ENTER();
 
-        case LED4_BRAKE_STATUS:
-            HAL_GPIO_TogglePin(LED4_GPIO_PORT, LED4_PIN);
-            break;
+    gChannels[led].pPattern = 0;
+    ledApply(led, brightness);
 
-        default:
-            break;
+    CRITICAL_SECTION_EXIT();
+
+    return LED_ERR_OK;
+}
+
+int32_t ledSetPattern(LED_t led, const LEDPattern_t* pPattern)
+{
+    if ((uint32_t)led >= LED_COUNT || pPattern == 0 || pPattern->pSteps == 0 || pPattern->stepCount == 0)
+    {
+        return LED_ERR_INVALID_PARAM;
     }
+
+    // The pattern interrupt must not see a half updated channel
+    CRITICAL_SECTION_ENTER();
+
+    gChannels[led].pPattern = pPattern;
+    ledStartStep(led, 0);
+
+    CRITICAL_SECTION_EXIT();
+
+    return LED_ERR_OK;
 }
 
-void ledSetLED(LED_t led, LED_Status_t ledStatus)
+/**
+ * @brief Writes the brightness of a LED to the hardware
+ *
+ * @param led           LED to change
+ * @param brightness    New brightness
+ */
+static void ledApply(uint32_t led, uint8_t brightness)
+{
+    const LEDPin_t* pLED = &gLEDs[led];
+
+    gChannels[led].brightness = brightness;
+
+    if (pLED->pwm)
+    {
+        __HAL_TIM_SET_COMPARE(&gTimer4Handle, pLED->channel, (brightness * LED_PWM_PERIOD) / LED_BRIGHTNESS_MAX);
+    }
+    else
+    {
+        piWriteOutputs(pLED->pPort, pLED->pin, (brightness >= LED_BRIGHTNESS_MAX / 2) ? pLED->pin : 0);
+    }
+}
+
+/**
+ * @brief Applies a step of the running pattern of a LED
+ *
+ * @param led   LED to change
+ * @param step  Step of the pattern
+ */
+static void ledStartStep(uint32_t led, uint32_t step)
 {
-    switch(led)
+    volatile LEDChannel_t* pChannel = &gChannels[led];
+    const LEDPatternStep_t* pStep = &pChannel->pPattern->pSteps[step];
+
+    pChannel->step          = step;
+    pChannel->remainingMs   = (pStep->durationMs != 0) ? pStep->durationMs : 1;
+    ledApply(led, pStep->brightness);
+}
+
+/**
+* @brief TIM_PWM MSP Initialization
+*
+* @param htim_pwm: TIM_PWM handle pointer
+*
+* @remark: this HAL_TIM_PWM_MspInit function is called automatically by the
+* STM32 HAL library
+*/
+void HAL_TIM_PWM_MspInit(TIM_HandleTypeDef* htim_pwm)
+{
+    if(htim_pwm->Instance==TIM4)
     {
-        case LED0_APP_STATUS:
-            HAL_GPIO_WritePin(LED0_GPIO_PORT, LED0_PIN, ledStatus);
-            break;
+        /* Peripheral clock enable */
+        __HAL_RCC_TIM4_CLK_ENABLE();
+
+        /* TIM4 interrupt Init */
+        HAL_NVIC_SetPriority(TIM4_IRQn, LED_TIMER_PRIORITY, 0);
+        HAL_NVIC_EnableIRQ(TIM4_IRQn);
+    }
+}
 
-        case LED1_DOOR_STATUS:
-            HAL_GPIO_WritePin(LED1_GPIO_PORT, LED1_PIN, ledStatus);
-            break;
+/**
+  * @brief This function handles TIM4 global interrupt (pattern tick, 1 ms).
+  */
+void TIM4_IRQHandler(void)
+{
+    __HAL_TIM_CLEAR_IT(&gTimer4Handle, TIM_IT_UPDATE);
+
+    for (uint32_t led=0; led<LED_COUNT; led++)
+    {
+        volatile LEDChannel_t* pChannel = &gChannels[led];
 
-        case LED2_EMERGENCY:
-            HAL_GPIO_WritePin(LED2_GPIO_PORT, LED2_PIN, ledStatus);
-            break;
+        if (pChannel->pPattern == 0 || --pChannel->remainingMs != 0)
+        {
+            continue;
+        }
 
-        case LED3_MOTOR_STATUS:
-            HAL_GPIO_WritePin(LED3_GPIO_PORT, LED3_PIN, ledStatus);
-            break;
+        uint32_t step = pChannel->step + 1;
 
-        case LED4_BRAKE_STATUS:
-            HAL_GPIO_WritePin(LED4_GPIO_PORT, LED4_PIN, ledStatus);
-            break;
+        if (step < pChannel->pPattern->stepCount)
+        {
+            ledStartStep(led, step);
+        }
+        else if (pChannel->pPattern->repeat)
+        {
+            ledStartStep(led, 0);
+        }
+        else
+        {
+            // A single shot pattern keeps the brightness of its last step
+            pChannel->pPattern = 0;
+            continue;
+        }
 
-        default:
-            break;
+        if (!gLEDs[led].pwm)
+        {
+            piCommitOutputPins(gLEDs[led].pPort, gLEDs[led].pin);
+        }
     }
 }
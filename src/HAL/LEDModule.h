@@ -3,6 +3,11 @@
  * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
  * @brief Header file for the LED module
  *
+ * The LEDs are driven by a pattern engine in the update interrupt of TIM4
+ * (1 kHz), so blinking LEDs don't need any task time. LED3 and LED4 are
+ * connected to PWM channels of TIM4 and support brightness levels, the
+ * other LEDs are on for a brightness of at least LED_BRIGHTNESS_MAX / 2
+ *
  * @version 0.1
  * @date 2023-02-13
  *
@@ -14,12 +19,17 @@
 
 #include "stm32g4xx_hal.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 
 /*
  * Public Defines
 */
-#define LED_ERR_OK      0               //!< No error occured
+#define LED_ERR_OK              0               //!< No error occured
+#define LED_ERR_INIT_FAILURE    -1              //!< Error during initialization of the PWM timer
+#define LED_ERR_INVALID_PARAM   -2              //!< Invalid LED or pattern
+
+#define LED_BRIGHTNESS_MAX      100             //!< Brightness of a fully turned on LED (%)
 
 /**
  * @brief Enumeration of available LEDs and their usage
@@ -31,7 +41,8 @@ typedef enum _LED_t
     LED1_DOOR_STATUS,                   //!< LED1 used for Door Status (0 = Door Close, 1 = Door Open)
     LED2_EMERGENCY,                     //!< LED2 used for Emergency Status (0 = No emergency, Flashing = Emergency)
     LED3_MOTOR_STATUS,                  //!< LED3 used for Motor Status (0 = Motor torque off, 1 = Motor torque on (movin))
-    LED4_BRAKE_STATUS                   //!< LED4 used for Brake Status (0 = Brake closed, 1 = Brake open)
+    LED4_BRAKE_STATUS,                  //!< LED4 used for Brake Status (0 = Brake closed, 1 = Brake open)
+    LED_COUNT                           //!< Number of LEDs
 } LED_t;
 
 /**
@@ -45,25 +56,77 @@ typedef enum _LED_Status_t
 } LED_Status_t;
 
 /**
- * @brief Initialize the GPIOs for the LED outouts
+ * @brief Step of a LED pattern
+ *
+ */
+typedef struct _LEDPatternStep
+{
+    uint8_t brightness;                 //!< Brightness of the step (0 .. LED_BRIGHTNESS_MAX)
+    uint16_t durationMs;                //!< Duration of the step in ms
+} LEDPatternStep_t;
+
+/**
+ * @brief LED pattern (sequence of brightness steps)
+ *
+ */
+typedef struct _LEDPattern
+{
+    const LEDPatternStep_t* pSteps;     //!< Steps of the pattern
+    uint8_t stepCount;                  //!< Number of steps
+    bool repeat;                        //!< Restart after the last step (otherwise the last brightness is kept)
+} LEDPattern_t;
+
+/*
+ * Predefined Patterns
+*/
+extern const LEDPattern_t gLedPatternBlinkSlow;     //!< 1 Hz, 50% duty
+extern const LEDPattern_t gLedPatternBlinkFast;     //!< 5 Hz, 50% duty
+extern const LEDPattern_t gLedPatternFlash;         //!< 50 ms flash every second
+extern const LEDPattern_t gLedPatternDoubleFlash;   //!< Two 50 ms flashes every second
+extern const LEDPattern_t gLedPatternBreathe;       //!< Brightness ramp up and down within one second (PWM LEDs)
+
+/**
+ * @brief Initialize the GPIOs for the LED outouts and the pattern timer
  *
  * @return Returns LED_ERR_OK if no error occured
  */
 int32_t ledInitialize();
 
 /**
- * @brief Toggles the provided LED
+ * @brief Toggles the provided LED (stops a running pattern)
  *
  * @param led LED to toggle
  */
 void ledToggleLED(LED_t led);
 
 /**
- * @brief Allows to set (turn on) or reset (turn off) a LED
+ * @brief Allows to set (turn on) or reset (turn off) a LED (stops a running
+ * pattern)
  *
  * @param led LED which should be changed
  * @param ledStatus New status of the LED
  */
 void ledSetLED(LED_t led, LED_Status_t ledStatus);
 
+/**
+ * @brief Sets a constant brightness of a LED (stops a running pattern)
+ *
+ * @param led LED which should be changed
+ * @param brightness Brightness (0 .. LED_BRIGHTNESS_MAX)
+ *
+ * @return Returns LED_ERR_OK if no error occured
+ */
+int32_t ledSetBrightness(LED_t led, uint8_t brightness);
+
+/**
+ * @brief Starts a pattern on a LED. The first step is applied immediately,
+ * the following steps are run by the timer interrupt
+ *
+ * @param led LED which should be changed
+ * @param pPattern Pattern to run (must stay valid while it runs)
+ *
+ * @return Returns LED_ERR_OK if no error occured
+ */
+int32_t ledSetPattern(LED_t led, const LEDPattern_t* pPattern);
+
 #endif
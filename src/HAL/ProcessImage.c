@@ -0,0 +1,182 @@
+/**
+ * @file ProcessImage.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of the Process Image Module
+ *
+ * The port of a GPIO_TypeDef pointer is found by address arithmetic (the
+ * ports are 0x400 apart), ports outside of the image are ignored. Outputs
+ * are committed through BSRR, which sets and resets the changed pins in one
+ * atomic write. Pins which are not changed in the image are never touched,
+ * so interrupts may still drive other pins of the same port directly. The
+ * image is shared with the LED pattern interrupt, which commits its pins
+ * itself, every read-modify-write of it runs in a critical section
+ *
+ * @version 0.1
+ * @date 2023-03-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include "CriticalSection.h"
+#include "ProcessImage.h"
+
+/*
+ * Private Defines
+*/
+#define PI_PORT_SPACING_SHIFT       10          //!< Distance of the GPIO ports in the address space (0x400)
+
+//! Index of a GPIO port in the image
+#define PI_PORT_INDEX(pPort)        ((uint32_t)((uintptr_t)(pPort) - GPIOA_BASE) >> PI_PORT_SPACING_SHIFT)
+
+/*
+ * Private Types
+*/
+
+/**
+ * @brief Image of a GPIO port
+ *
+ */
+typedef struct _ProcessImagePort
+{
+    GPIO_TypeDef* pPort;                        //!< GPIO port
+    uint32_t input;                             //!< Input levels latched at the start of the cycle
+    uint32_t output;                            //!< Output levels of the current cycle
+    uint32_t committed;                         //!< Output levels written to the port
+} ProcessImagePort_t;
+
+/*
+ * Private Module Variables
+*/
+static ProcessImagePort_t gPorts[PI_PORT_COUNT] =
+{
+    {GPIOA, 0, 0, 0},
+    {GPIOB, 0, 0, 0},
+    {GPIOC, 0, 0, 0}
+};
+
+static ProcessImageStats_t gStats;
+
+/*
+ * Public Module Functions
+*/
+
+int32_t piInitialize()
+{
+    for (uint32_t i=0; i<PI_PORT_COUNT; i++)
+    {
+        gPorts[i].input     = gPorts[i].pPort->IDR;
+        gPorts[i].output    = gPorts[i].pPort->ODR;
+        gPorts[i].committed = gPorts[i].output;
+    }
+
+    return PI_ERR_OK;
+}
+
+void piReadInputs()
+{
+    for (uint32_t i=0; i<PI_PORT_COUNT; i++)
+    {
+        gPorts[i].input = gPorts[i].pPort->IDR;
+    }
+
+    gStats.inputReads = PI_PORT_COUNT;
+}
+
+void piCommitOutputs()
+{
+    uint32_t writes = 0;
+
+    for (uint32_t i=0; i<PI_PORT_COUNT; i++)
+    {
+        ProcessImagePort_t* pImage = &gPorts[i];
+
+        // A change by the pattern interrupt between the compare and the write would be lost
+        CRITICAL_SECTION_ENTER();
+
+        uint32_t output = pImage->output;
+        uint32_t changed = output ^ pImage->committed;
+
+        if (changed != 0)
+        {
+            // Lower half sets, upper half resets the pins
+            pImage->pPort->BSRR = (changed & output) | ((changed & ~output) << 16);
+            pImage->committed = output;
+            writes++;
+        }
+
+        CRITICAL_SECTION_EXIT();
+    }
+
+    gStats.outputWrites = writes;
+}
+
+void piCommitOutputPins(GPIO_TypeDef* pPort, uint16_t pins)
+{
+    uint32_t index = PI_PORT_INDEX(pPort);
+
+    if (index < PI_PORT_COUNT)
+    {
+        ProcessImagePort_t* pImage = &gPorts[index];
+
+        CRITICAL_SECTION_ENTER();
+
+        uint32_t output = pImage->output;
+        uint32_t changed = (output ^ pImage->committed) & pins;
+
+        if (changed != 0)
+        {
+            pImage->pPort->BSRR = (changed & output) | ((changed & ~output) << 16);
+            pImage->committed ^= changed;
+        }
+
+        CRITICAL_SECTION_EXIT();
+    }
+}
+
+bool piReadInput(GPIO_TypeDef* pPort, uint16_t pins)
+{
+    uint32_t index = PI_PORT_INDEX(pPort);
+
+    if (index >= PI_PORT_COUNT)
+    {
+        return false;
+    }
+
+    return (gPorts[index].input & pins) != 0;
+}
+
+void piWriteOutputs(GPIO_TypeDef* pPort, uint16_t pins, uint16_t values)
+{
+    uint32_t index = PI_PORT_INDEX(pPort);
+
+    if (index < PI_PORT_COUNT)
+    {
+        CRITICAL_SECTION_ENTER();
+        gPorts[index].output = (gPorts[index].output & ~(uint32_t)pins) | (values & pins);
+        CRITICAL_SECTION_EXIT();
+    }
+}
+
+void piToggleOutputs(GPIO_TypeDef* pPort, uint16_t pins)
+{
+    uint32_t index = PI_PORT_INDEX(pPort);
+
+    if (index < PI_PORT_COUNT)
+    {
+        CRITICAL_SECTION_ENTER();
+        gPorts[index].output ^= pins;
+        CRITICAL_SECTION_EXIT();
+    }
+}
+
+int32_t piReadStats(ProcessImageStats_t* pStats)
+{
+    if (pStats == 0)
+    {
+        return PI_ERR_INVALID_PTR;
+    }
+
+    *pStats = gStats;
+
+    return PI_ERR_OK;
+}
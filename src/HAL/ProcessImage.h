@@ -0,0 +1,111 @@
+/**
+ * @file ProcessImage.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Header file for the Process Image Module
+ *
+ * The GPIO ports are accessed through an image in RAM (PLC style): all
+ * input registers are latched once at the start of a cycle and all changed
+ * outputs are written once at the end of a cycle, so the application sees
+ * consistent inputs and each port is written at most once per cycle
+ *
+ * @version 0.1
+ * @date 2023-03-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _PROCESS_IMAGE_H_
+#define _PROCESS_IMAGE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "stm32g4xx_hal.h"
+
+/*
+ * Public Defines
+*/
+#define PI_ERR_OK                   0           //!< No error occured
+#define PI_ERR_INVALID_PTR          -1          //!< Invalid pointer (Null Pointer)
+
+#define PI_PORT_COUNT               3           //!< Number of ports in the image (GPIOA..GPIOC)
+
+/*
+ * Public Types
+*/
+
+/**
+ * @brief Number of GPIO register accesses of the last cycle
+ *
+ */
+typedef struct _ProcessImageStats
+{
+    uint32_t inputReads;                        //!< IDR reads of the last piReadInputs
+    uint32_t outputWrites;                      //!< BSRR writes of the last piCommitOutputs
+} ProcessImageStats_t;
+
+/**
+ * @brief Initializes the image from the current port registers
+ *
+ * @return Returns PI_ERR_OK if no error occured
+ */
+int32_t piInitialize();
+
+/**
+ * @brief Latches the input registers (one IDR read per port). Called at
+ * the start of a cycle
+ */
+void piReadInputs();
+
+/**
+ * @brief Writes the outputs which changed since the last commit (at most
+ * one BSRR write per port). Called at the end of a cycle
+ */
+void piCommitOutputs();
+
+/**
+ * @brief Writes changed output pins of one port immediately instead of at
+ * the end of the cycle (may be called from interrupts)
+ *
+ * @param pPort     GPIO port (GPIOA..GPIOC)
+ * @param pins      Pin mask (GPIO_PIN_x)
+ */
+void piCommitOutputPins(GPIO_TypeDef* pPort, uint16_t pins);
+
+/**
+ * @brief Returns the latched level of input pins
+ *
+ * @param pPort     GPIO port (GPIOA..GPIOC)
+ * @param pins      Pin mask (GPIO_PIN_x)
+ *
+ * @return Returns true if any of the pins was high at the start of the cycle
+ */
+bool piReadInput(GPIO_TypeDef* pPort, uint16_t pins);
+
+/**
+ * @brief Changes output pins in the image (may be called from interrupts)
+ *
+ * @param pPort     GPIO port (GPIOA..GPIOC)
+ * @param pins      Pin mask (GPIO_PIN_x)
+ * @param values    New levels of the pins (bits outside of the pin mask are ignored)
+ */
+void piWriteOutputs(GPIO_TypeDef* pPort, uint16_t pins, uint16_t values);
+
+/**
+ * @brief Toggles output pins in the image (may be called from interrupts)
+ *
+ * @param pPort     GPIO port (GPIOA..GPIOC)
+ * @param pins      Pin mask (GPIO_PIN_x)
+ */
+void piToggleOutputs(GPIO_TypeDef* pPort, uint16_t pins);
+
+/**
+ * @brief Copies the register access counters of the last cycle
+ *
+ * @param pStats    Pointer to store the counters
+ *
+ * @return Returns PI_ERR_OK if no error occured
+ */
+int32_t piReadStats(ProcessImageStats_t* pStats);
+
+#endif
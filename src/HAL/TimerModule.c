@@ -2,7 +2,8 @@
  * @file TimerModule.c
  * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
  * @brief Implementation of the Timer Module to trigger ADC conversion
- * based on DMA
+ * based on DMA and to provide the µs timebase (TIM2, free running 32 bit
+ * counter)
  *
  * @version 0.1
  * @date 2023-02-21
@@ -17,10 +18,18 @@
 #include "HardwareConfig.h"
 #include "TimerModule.h"
 
+/*
+ * Private Defines
+*/
+#define TIMER_TRIGGER_CLOCK_HZ      100000UL    //!< Counter clock of TIM3 after the prescaler
+#define TIMER_TRIGGER_RATE_DEFAULT  100UL       //!< ADC trigger rate after initialization in Hz
+#define TIMER_TIMEBASE_CLOCK_HZ     1000000UL   //!< Counter clock of TIM2 after the prescaler (1µs resolution)
+
 /*
  * Private Global Variables
 */
 static TIM_HandleTypeDef gTimer3Handle;         //! Global handle for Timer 3 (TIM3) peripheral
+static TIM_HandleTypeDef gTimer2Handle;         //! Global handle for Timer 2 (TIM2) peripheral (timebase)
 
 int32_t timerInitialize()
 {
@@ -29,13 +38,14 @@ int32_t timerInitialize()
 
     /* Initialize the Timer to get a 10ms cycle
      * 128 MHz Peripheral Clock ==> divided by Prescaler ==> 128e6 / 1280 = 100000
+     * (the prescaler register divides by value + 1)
      * Timer Frequency of 100.000 = 100kHz to count to 1000 (0-999) and then generate interrupt
      * ==> 100kHz / 1000 = 100Hz ==> 10ms
     */
     gTimer3Handle.Instance                  = TIM3;
-    gTimer3Handle.Init.Prescaler            = 1280;
+    gTimer3Handle.Init.Prescaler            = (128000000UL / TIMER_TRIGGER_CLOCK_HZ) - 1;
     gTimer3Handle.Init.CounterMode          = TIM_COUNTERMODE_UP;
-    gTimer3Handle.Init.Period               = 999;
+    gTimer3Handle.Init.Period               = (TIMER_TRIGGER_CLOCK_HZ / TIMER_TRIGGER_RATE_DEFAULT) - 1;
     gTimer3Handle.Init.ClockDivision        = TIM_CLOCKDIVISION_DIV1;
     gTimer3Handle.Init.AutoReloadPreload    = TIM_AUTORELOAD_PRELOAD_ENABLE;
 
@@ -59,6 +69,41 @@ int32_t timerInitialize()
 
     HAL_TIM_Base_Start_IT(&gTimer3Handle);
 
+    /* Free running µs timebase: 128 MHz / 128 = 1 MHz, the 32 bit counter
+     * wraps after 71 minutes (differences of timestamps are wrap safe)
+    */
+    gTimer2Handle.Instance                  = TIM2;
+    gTimer2Handle.Init.Prescaler            = (128000000UL / TIMER_TIMEBASE_CLOCK_HZ) - 1;
+    gTimer2Handle.Init.CounterMode          = TIM_COUNTERMODE_UP;
+    gTimer2Handle.Init.Period               = 0xFFFFFFFFUL;
+    gTimer2Handle.Init.ClockDivision        = TIM_CLOCKDIVISION_DIV1;
+    gTimer2Handle.Init.AutoReloadPreload    = TIM_AUTORELOAD_PRELOAD_DISABLE;
+
+    if (HAL_TIM_Base_Init(&gTimer2Handle) != HAL_OK)
+    {
+        return TIMER_ERR_INIT_FAILURE;
+    }
+
+    HAL_TIM_Base_Start(&gTimer2Handle);
+
+    return TIMER_ERR_OK;
+}
+
+uint32_t timerGetMicroseconds()
+{
+    return TIM2->CNT;
+}
+
+int32_t timerSetTriggerRate(uint32_t rateHz)
+{
+    if (rateHz < TIMER_TRIGGER_RATE_MIN || rateHz > TIMER_TRIGGER_RATE_MAX)
+    {
+        return TIMER_ERR_INVALID_PARAM;
+    }
+
+    // ARR is written to the preload register and becomes active at the next update event
+    __HAL_TIM_SET_AUTORELOAD(&gTimer3Handle, (TIMER_TRIGGER_CLOCK_HZ / rateHz) - 1);
+
     return TIMER_ERR_OK;
 }
 
@@ -82,6 +127,11 @@ void HAL_TIM_Base_MspInit(TIM_HandleTypeDef* htim_base)
         HAL_NVIC_SetPriority(TIM3_IRQn, 2, 0);
         HAL_NVIC_EnableIRQ(TIM3_IRQn);
     }
+    else if(htim_base->Instance==TIM2)
+    {
+        /* Peripheral clock enable (no interrupt, the counter is only read) */
+        __HAL_RCC_TIM2_CLK_ENABLE();
+    }
 }
 
 /**
@@ -90,6 +140,4 @@ void HAL_TIM_Base_MspInit(TIM_HandleTypeDef* htim_base)
 void TIM3_IRQHandler(void)
 {
     HAL_TIM_IRQHandler(&gTimer3Handle);
-
-    HAL_GPIO_TogglePin(LED0_GPIO_PORT, LED0_PIN);
 }
@@ -19,6 +19,10 @@
 */
 #define TIMER_ERR_OK                  0         //!< No error occured
 #define TIMER_ERR_INIT_FAILURE        -1        //!< Error during timer initialization
+#define TIMER_ERR_INVALID_PARAM       -2        //!< Invalid parameter value
+
+#define TIMER_TRIGGER_RATE_MIN        2         //!< Lowest ADC trigger rate in Hz (limited by the 16 bit auto reload register)
+#define TIMER_TRIGGER_RATE_MAX        10000     //!< Highest ADC trigger rate in Hz
 
 /**
  * @brief Initializes the Timer Module
@@ -27,4 +31,26 @@
  */
 int32_t timerInitialize();
 
+/**
+ * @brief Changes the rate of the ADC trigger (TIM3 TRGO)
+ *
+ * The auto reload register is preloaded, so the new period starts with the
+ * next update event and the running period is not shortened or stretched
+ *
+ * @param rateHz    New trigger rate in Hz (TIMER_TRIGGER_RATE_MIN..TIMER_TRIGGER_RATE_MAX)
+ *
+ * @return Returns TIMER_ERR_OK if no error occured
+ */
+int32_t timerSetTriggerRate(uint32_t rateHz);
+
+/**
+ * @brief Returns the current value of the µs timebase (TIM2). The counter
+ * wraps around, time differences must be computed as uint32_t subtraction
+ *
+ * @remark Can be called from interrupt context
+ *
+ * @return Returns the timestamp in µs
+ */
+uint32_t timerGetMicroseconds();
+
 #endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+/**
+ * @file CriticalSection.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Critical section hook for data shared with interrupts
+ *
+ * Generic modules (e.g. the state table) use these macros instead of the
+ * CMSIS intrinsics, so they stay independent of the target. The host tests
+ * provide their own version of this header
+ *
+ * @version 0.1
+ * @date 2023-03-08
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _CRITICAL_SECTION_H_
+#define _CRITICAL_SECTION_H_
+
+#include <stdint.h>
+
+#include "cmsis_compiler.h"
+
+/*
+ * Public Defines
+*/
+
+//! Disables all maskable interrupts, the previous state is kept in a local variable (sections can be nested)
+#define CRITICAL_SECTION_ENTER()    uint32_t criticalPrimask = __get_PRIMASK(); __disable_irq()
+
+//! Restores the interrupt state of the matching CRITICAL_SECTION_ENTER in the same scope
+#define CRITICAL_SECTION_EXIT()     __set_PRIMASK(criticalPrimask)
+
+#endif
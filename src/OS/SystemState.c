@@ -17,7 +17,11 @@
 #include "ADCModule.h"
 #include "TimerModule.h"
 #include "DisplayModule.h"
+#include "ProcessImage.h"
 #include "Util/Filter/Filter.h"
+#include "SensorDiagnostics.h"
+#include "AcquisitionRate.h"
+#include "VibrationAnalysis.h"
 #include "Tasks.h"
 
 #include "Scheduler.h"
@@ -40,14 +44,16 @@ static int32_t initializePeripherals()
 {
     // Initializue UART used for Debug-Outputs
     uartInitialize(115200);
-    // Initialize GPIOs for Buttons
-    buttonInitialize();
     // Initialize GPIOs for LED and 7-Segment output
     ledInitialize();
     // Initialize Display
-    //displayInitialize();
+    displayInitialize();
     // Initialize Timer, DMA and ADC for sensor measurements
     timerInitialize();
+    // Initialize GPIOs and EXTI for Buttons (timestamps need the timebase of the Timer Module)
+    buttonInitialize();
+    // Initialize the process image from the configured GPIO ports
+    piInitialize();
     // Initialize ADC
     adcInitialize();
 
@@ -75,6 +81,9 @@ static int32_t performStartup(){
 	schedInitialize(&myScheduler);
 
 	initFilters();
+	sensorDiagInitialize();
+	acqInitialize();
+	vibInitialize();
 	sampleAppInitialize();
 
 
@@ -95,6 +104,7 @@ static int32_t performStartup(){
 static void performStartupTransition(int32_t initResult){
 	if (initResult == ERROR_OK){
 		gSystemState = Sysstate_Running;
+		ledSetLED(LED0_APP_STATUS, LED_ON);
 	}
 	else{
 		gSystemState = Sysstate_Failure;
@@ -103,7 +113,10 @@ static void performStartupTransition(int32_t initResult){
 
 static int32_t performRunningState(){
 	//HAL_GPIO_TogglePin(LED0_GPIO_PORT, LED0_PIN);
+	// Inputs are latched once before and outputs written once after the tasks
+	piReadInputs();
 	schedCycle(&myScheduler);
+	piCommitOutputs();
 	//HAL_Delay(250);
 	return ERROR_OK;
 
@@ -114,6 +127,7 @@ static void SafeState()
 
 	ledSetLED(LED4_BRAKE_STATUS, LED_OFF);
 	ledSetLED(LED1_DOOR_STATUS, LED_OFF);
+	piCommitOutputs();
 	while(true)
 	{
 
@@ -19,24 +19,37 @@
 #include "HardwareConfig.h"
 #include "ADCModule.h"
 #include "ADCValues.h"
+#include "AcquisitionRate.h"
+#include "SensorPipeline.h"
+#include "VibrationAnalysis.h"
 #include "SampleApplication.h"
+#include "ButtonGesture.h"
 
 
 
 
 void myTask1ms(void){
 //	HAL_GPIO_TogglePin(LED0_GPIO_PORT, LED0_PIN);
+	// One frame per call, at 1kHz a delayed task finds more than one frame
+	while (updateFilters()){
+		acqProcessFrame(filteredChannel1());
+		vibCaptureSample(sensorPipelineGetInputValue(SENSOR_POT1));
+	}
 	sampleAppRun();
 }
 void myTask10ms(void){
 	//HAL_GPIO_TogglePin(LED1_GPIO_PORT, LED1_PIN);
+	gestureProcess();
 }
 void myTask100ms(void){
 	//HAL_GPIO_TogglePin(LED1_GPIO_PORT, LED1_PIN);
+	adcStartHousekeeping();
 }
 void myTask250ms(void){
 	//HAL_GPIO_TogglePin(LED2_GPIO_PORT, LED2_PIN);
 }
 void myTask1000ms(void){
 	//HAL_GPIO_TogglePin(LED3_GPIO_PORT, LED3_PIN);
+	// Background slot, the analysis of a block takes about 1ms
+	vibProcess();
 }
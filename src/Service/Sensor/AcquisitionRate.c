@@ -0,0 +1,230 @@
+/**
+ * @file AcquisitionRate.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of the Acquisition Rate Module
+ *
+ * The velocity is estimated from the displacement of the filtered position
+ * over a window of ACQ_WINDOW_US. Above ACQ_VELOCITY_MOVING the normal
+ * profile is selected, the idle profile only after the velocity stayed below
+ * ACQ_VELOCITY_IDLE for ACQ_IDLE_HOLD_US (hysteresis)
+ *
+ * @version 0.1
+ * @date 2023-03-09
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdbool.h>
+
+#include "TimerModule.h"
+#include "ADCValues.h"
+#include "SensorDiagnostics.h"
+
+#include "AcquisitionRate.h"
+
+/*
+ * Private Defines
+*/
+#define ACQ_WINDOW_US               250000UL    //!< Length of the velocity estimation window in µs
+#define ACQ_VELOCITY_MOVING         1000LL      //!< Velocity above which the sensors are considered moving in mm/s
+#define ACQ_VELOCITY_IDLE           500LL       //!< Velocity below which the sensors are considered at rest in mm/s
+#define ACQ_IDLE_HOLD_US            2000000UL   //!< Time at rest before switching to the idle profile in µs
+
+/*
+ * Private Types
+*/
+
+/**
+ * @brief Configuration of a sampling rate profile
+ *
+ * The EMA alpha keeps the filter time constant close to tau = 14.4ms for all
+ * rates (alpha = 1 - exp(-T / tau), rounded to a power of two), which is the
+ * time constant of alpha = 0.5 at 100Hz
+ *
+ * The spike rejection window covers about 50ms (at least 3 frames, at most
+ * FILTER_MEDIAN_MAX_WINDOW), so a glitch of the same duration is rejected
+ * at every rate
+ *
+ * The Kalman gains are the steady state gains for the sample period with a
+ * fused measurement noise of 1.1mV and an acceleration noise of 20m/s²
+ * (421000µV/s²). The gains only depend on the ratio of both, so they are
+ * the same for the linearized position in mm
+ */
+typedef struct _AcqProfileConfig
+{
+    uint32_t rateHz;                            //!< ADC trigger rate in Hz
+    uint32_t periodUs;                          //!< Frame period in µs
+    uint32_t filterShift;                       //!< EMA alpha of the position filters for this rate (alpha = 2^-filterShift)
+    uint32_t spikeWindow;                       //!< Window of the spike rejection in frames (odd)
+    int32_t kalmanAlphaQ15;                     //!< Position gain of the sensor fusion (Q15)
+    int32_t kalmanBetaQ16;                      //!< Velocity gain of the sensor fusion divided by the period in 1/s (Q16)
+} AcqProfileConfig_t;
+
+/*
+ * Private Module Variables
+*/
+static const AcqProfileConfig_t gProfileConfig[ACQ_PROFILE_COUNT] =
+{
+    {10,    100000,     0,  3,  30217,  681303},    // ACQ_PROFILE_IDLE (alpha = 1)
+    {100,   10000,      1,  5,  7823,   213037},    // ACQ_PROFILE_NORMAL (alpha = 0.5)
+    {1000,  1000,       4,  31, 882,    24086}      // ACQ_PROFILE_RACE (alpha = 0.0625, tau = 15.5ms)
+};
+
+static AcqProfile_t gProfile;                   //!< Active profile
+static AcqProfile_t gMinimumProfile;            //!< Lowest profile allowed by the application state
+static AcqProfile_t gMotionProfile;             //!< Profile requested by the sensor motion
+
+static bool gWindowValid;                       //!< Flag to indicate whether the window start position is valid
+static int32_t gWindowStartPosition;            //!< Position at the start of the velocity window in mm
+static uint32_t gWindowElapsedUs;               //!< Elapsed time in the velocity window in µs
+static uint32_t gIdleElapsedUs;                 //!< Time the velocity is below ACQ_VELOCITY_IDLE in µs
+
+/*
+ * Private Module Functions
+*/
+static int32_t acqSelectProfile(void);
+static int32_t acqApplyProfile(AcqProfile_t profile);
+
+/*
+ * Public Module Functions
+*/
+
+int32_t acqInitialize()
+{
+    gProfile            = ACQ_PROFILE_NORMAL;
+    gMinimumProfile     = ACQ_PROFILE_IDLE;
+    gMotionProfile      = ACQ_PROFILE_NORMAL;
+    gWindowValid        = false;
+    gWindowElapsedUs    = 0;
+    gIdleElapsedUs      = 0;
+
+    if (acqApplyProfile(gProfile) != ACQ_ERR_OK)
+    {
+        return ACQ_ERR_CONFIG_FAILURE;
+    }
+
+    return ACQ_ERR_OK;
+}
+
+int32_t acqSetMinimumProfile(AcqProfile_t minimumProfile)
+{
+    if (minimumProfile < ACQ_PROFILE_IDLE || minimumProfile >= ACQ_PROFILE_COUNT)
+    {
+        return ACQ_ERR_INVALID_PARAM;
+    }
+
+    gMinimumProfile = minimumProfile;
+
+    return acqSelectProfile();
+}
+
+int32_t acqProcessFrame(int32_t positionMm)
+{
+    if (!gWindowValid)
+    {
+        gWindowStartPosition    = positionMm;
+        gWindowElapsedUs        = 0;
+        gWindowValid            = true;
+        return ACQ_ERR_OK;
+    }
+
+    gWindowElapsedUs += gProfileConfig[gProfile].periodUs;
+
+    if (gWindowElapsedUs < ACQ_WINDOW_US)
+    {
+        return ACQ_ERR_OK;
+    }
+
+    int32_t displacement = positionMm - gWindowStartPosition;
+    if (displacement < 0)
+    {
+        displacement = -displacement;
+    }
+
+    // Only one division per window
+    int64_t velocity = ((int64_t)displacement * 1000000LL) / gWindowElapsedUs;
+
+    if (velocity >= ACQ_VELOCITY_MOVING)
+    {
+        gMotionProfile  = ACQ_PROFILE_NORMAL;
+        gIdleElapsedUs  = 0;
+    }
+    else if (velocity < ACQ_VELOCITY_IDLE)
+    {
+        gIdleElapsedUs += gWindowElapsedUs;
+
+        if (gIdleElapsedUs >= ACQ_IDLE_HOLD_US)
+        {
+            gMotionProfile = ACQ_PROFILE_IDLE;
+        }
+    }
+    else
+    {
+        gIdleElapsedUs = 0;
+    }
+
+    gWindowStartPosition    = positionMm;
+    gWindowElapsedUs        = 0;
+
+    return acqSelectProfile();
+}
+
+AcqProfile_t acqGetProfile()
+{
+    return gProfile;
+}
+
+uint32_t acqGetRate()
+{
+    return gProfileConfig[gProfile].rateHz;
+}
+
+/**
+ * @brief Activates the higher one of the minimum and the motion profile.
+ * On a change the trigger timer is retimed (effective with the next update
+ * event) and the filter coefficients are rescaled to the new rate
+ *
+ * @return Returns ACQ_ERR_OK if no error occured
+ */
+static int32_t acqSelectProfile(void)
+{
+    AcqProfile_t profile = (gMotionProfile > gMinimumProfile) ? gMotionProfile : gMinimumProfile;
+
+    if (profile == gProfile)
+    {
+        return ACQ_ERR_OK;
+    }
+
+    if (acqApplyProfile(profile) != ACQ_ERR_OK)
+    {
+        return ACQ_ERR_CONFIG_FAILURE;
+    }
+
+    gProfile = profile;
+
+    return ACQ_ERR_OK;
+}
+
+/**
+ * @brief Programs the trigger timer, the filter coefficients, the fusion
+ * gains and the frame based diagnostic limits of a profile
+ *
+ * @param profile   Profile to apply
+ *
+ * @return Returns ACQ_ERR_OK if no error occured
+ */
+static int32_t acqApplyProfile(AcqProfile_t profile)
+{
+    const AcqProfileConfig_t* pConfig = &gProfileConfig[profile];
+
+    if (timerSetTriggerRate(pConfig->rateHz) != TIMER_ERR_OK ||
+        configureFilters(pConfig->filterShift) != SENSOR_ERR_OK ||
+        sensorPipelineConfigureSpikeWindow(pConfig->spikeWindow) != SENSOR_ERR_OK ||
+        sensorPipelineConfigureFusion(pConfig->kalmanAlphaQ15, pConfig->kalmanBetaQ16, pConfig->periodUs) != SENSOR_ERR_OK ||
+        sensorDiagConfigureRate(pConfig->periodUs) != DIAG_ERR_OK)
+    {
+        return ACQ_ERR_CONFIG_FAILURE;
+    }
+
+    return ACQ_ERR_OK;
+}
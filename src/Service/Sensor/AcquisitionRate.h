@@ -0,0 +1,84 @@
+/**
+ * @file AcquisitionRate.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Header file for the Acquisition Rate Module, which selects the
+ * ADC sampling rate profile from the sensor motion and the application state
+ *
+ * @version 0.1
+ * @date 2023-03-09
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _ACQUISITION_RATE_H_
+#define _ACQUISITION_RATE_H_
+
+#include <stdint.h>
+
+/*
+ * Public Defines
+*/
+#define ACQ_ERR_OK                  0           //!< No error occured
+#define ACQ_ERR_INVALID_PARAM       -1          //!< Invalid parameter value
+#define ACQ_ERR_CONFIG_FAILURE      -2          //!< Timer or filters couldn't be reconfigured
+
+/*
+ * Public Types
+*/
+
+/**
+ * @brief Enumeration of the sampling rate profiles (ordered by rate)
+ *
+ */
+typedef enum _AcqProfile
+{
+    ACQ_PROFILE_IDLE,           //!< Sensors at rest (10Hz)
+    ACQ_PROFILE_NORMAL,         //!< Sensors moving (100Hz)
+    ACQ_PROFILE_RACE,           //!< Race mode (1kHz)
+    ACQ_PROFILE_COUNT           //!< Number of profiles
+} AcqProfile_t;
+
+/**
+ * @brief Initializes the module with the normal profile and a minimum
+ * profile of ACQ_PROFILE_IDLE
+ *
+ * @return Returns ACQ_ERR_OK if no error occured
+ */
+int32_t acqInitialize();
+
+/**
+ * @brief Sets the lowest profile which may be selected. The application
+ * uses this to force a profile for a state (e.g. race mode), above the
+ * minimum the profile follows the sensor motion
+ *
+ * @param minimumProfile    Lowest allowed profile
+ *
+ * @return Returns ACQ_ERR_OK if no error occured
+ */
+int32_t acqSetMinimumProfile(AcqProfile_t minimumProfile);
+
+/**
+ * @brief Estimates the sensor velocity and switches the profile if needed.
+ * Must be called once per new ADC frame
+ *
+ * @param positionMm    Filtered position of the leading sensor in millimetre [mm]
+ *
+ * @return Returns ACQ_ERR_OK if no error occured
+ */
+int32_t acqProcessFrame(int32_t positionMm);
+
+/**
+ * @brief Returns the active profile
+ *
+ * @return Returns the active profile
+ */
+AcqProfile_t acqGetProfile();
+
+/**
+ * @brief Returns the sampling rate of the active profile
+ *
+ * @return Returns the sampling rate in Hz
+ */
+uint32_t acqGetRate();
+
+#endif
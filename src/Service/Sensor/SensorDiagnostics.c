@@ -0,0 +1,253 @@
+/**
+ * @file SensorDiagnostics.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of the Sensor Diagnostics Module
+ *
+ * All statistics are updated with shifts, additions and one multiplication
+ * per sensor and frame (no division), so the diagnostics can run for every
+ * frame of the fast lane
+ *
+ * The stuck and slew limits are defined in time and per second, they are
+ * converted into frames for the active acquisition rate by
+ * sensorDiagConfigureRate
+ *
+ * @version 0.1
+ * @date 2023-03-08
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <string.h>
+
+#include "SensorDiagnostics.h"
+
+/*
+ * Private Defines
+*/
+#define DIAG_WEIGHT_SHIFT           4           //!< Weight of a new sample in mean and variance (2^-4 = 1/16)
+#define DIAG_NOISE_LIMIT_Q8         (128 << 8)  //!< Variance limit of the frame-to-frame difference in digits² (Q8), ~8 digits noise
+#define DIAG_STUCK_TIME_US          2000000UL   //!< Time with identical value until a sensor is reported as stuck in µs
+#define DIAG_MAX_SLEW_RATE          40000UL     //!< Maximum plausible change of the raw value in digits/s (~32V/s)
+#define DIAG_MIN_SLEW               100         //!< Lower limit of the slew per frame in digits (noise margin at high rates)
+#define DIAG_DEFAULT_PERIOD_US      10000UL     //!< Frame period until the first sensorDiagConfigureRate (100Hz)
+#define DIAG_RAW_MIN                0           //!< Lower limit of the ADC range in digits
+#define DIAG_RAW_MAX                4095        //!< Upper limit of the ADC range in digits
+
+/*
+ * Private Types
+*/
+
+/**
+ * @brief Internal state of one position sensor
+ *
+ */
+typedef struct _SensorDiagState
+{
+    SensorDiagRecord_t record;                  //!< Public part of the diagnostics
+    int32_t meanDeltaQ8;                        //!< Running mean of the frame-to-frame difference (Q8)
+    int32_t previousRaw;                        //!< Raw value of the previous frame
+} SensorDiagState_t;
+
+/*
+ * Private Module Variables
+*/
+static SensorDiagState_t gSensorState[ADC_SENSOR_COUNT];   //!< State of the position sensors, indexed by ADC_Channel_t
+static SensorDiagDataPath_t gDataPath;                      //!< Diagnostics of the ADC/DMA data path
+static uint32_t gLastSequence;                              //!< Sequence number of the last processed frame
+static uint32_t gStuckFrames;                               //!< Number of frames with identical value until a sensor is reported as stuck
+static uint32_t gMaxSlew;                                   //!< Maximum plausible change between two frames in digits
+
+/*
+ * Private Module Functions
+*/
+static void sensorDiagUpdateSensor(SensorDiagState_t* pState, int32_t raw);
+
+/*
+ * Public Module Functions
+*/
+
+int32_t sensorDiagInitialize()
+{
+    memset(gSensorState, 0, sizeof(gSensorState));
+    memset(&gDataPath, 0, sizeof(gDataPath));
+    gLastSequence = 0;
+
+    return sensorDiagConfigureRate(DIAG_DEFAULT_PERIOD_US);
+}
+
+int32_t sensorDiagConfigureRate(uint32_t periodUs)
+{
+    if (periodUs == 0)
+    {
+        return DIAG_ERR_INVALID_PARAM;
+    }
+
+    // Divisions only on a rate change
+    gStuckFrames = DIAG_STUCK_TIME_US / periodUs;
+    if (gStuckFrames == 0)
+    {
+        gStuckFrames = 1;
+    }
+
+    gMaxSlew = (uint32_t)(((uint64_t)DIAG_MAX_SLEW_RATE * periodUs) / 1000000UL);
+    if (gMaxSlew < DIAG_MIN_SLEW)
+    {
+        gMaxSlew = DIAG_MIN_SLEW;
+    }
+
+    return DIAG_ERR_OK;
+}
+
+int32_t sensorDiagProcessFrame(const ADCSnapshot_t* pSnapshot)
+{
+    if (pSnapshot == 0)
+    {
+        return DIAG_ERR_INVALID_PTR;
+    }
+
+    // Frames which were overwritten before they could be processed
+    uint32_t gap = ADC_SEQUENCE_DISTANCE(gLastSequence, pSnapshot->sequence);
+
+    if (gDataPath.frames != 0 && gap > 1)
+    {
+        gDataPath.missedFrames += gap - 1;
+    }
+    gLastSequence = pSnapshot->sequence;
+
+    for (int32_t i=0; i<ADC_SENSOR_COUNT; i++)
+    {
+        if (gDataPath.frames == 0)
+        {
+            // Start the statistics at the first value instead of zero
+            gSensorState[i].record.meanQ8   = pSnapshot->raw[i] << 8;
+            gSensorState[i].previousRaw     = pSnapshot->raw[i];
+        }
+
+        sensorDiagUpdateSensor(&gSensorState[i], pSnapshot->raw[i]);
+    }
+
+    ADCErrorCounters_t errorCounters;
+    if (adcReadErrorCounters(&errorCounters) == ADC_ERR_OK)
+    {
+        gDataPath.adcOverruns   = errorCounters.overrun;
+        gDataPath.dmaErrors     = errorCounters.dmaError;
+    }
+
+    gDataPath.frames++;
+
+    return DIAG_ERR_OK;
+}
+
+int32_t sensorDiagReadRecord(ADC_Channel_t adcChannel, SensorDiagRecord_t* pRecord)
+{
+    if (pRecord == 0)
+    {
+        return DIAG_ERR_INVALID_PTR;
+    }
+
+    if (adcChannel < 0 || adcChannel >= ADC_SENSOR_COUNT)
+    {
+        return DIAG_ERR_INVALID_PARAM;
+    }
+
+    *pRecord = gSensorState[adcChannel].record;
+
+    return DIAG_ERR_OK;
+}
+
+int32_t sensorDiagReadDataPath(SensorDiagDataPath_t* pDataPath)
+{
+    if (pDataPath == 0)
+    {
+        return DIAG_ERR_INVALID_PTR;
+    }
+
+    *pDataPath = gDataPath;
+
+    return DIAG_ERR_OK;
+}
+
+uint32_t sensorDiagGetFlags()
+{
+    uint32_t flags = 0;
+
+    for (int32_t i=0; i<ADC_SENSOR_COUNT; i++)
+    {
+        flags |= gSensorState[i].record.flags;
+    }
+
+    return flags;
+}
+
+/**
+ * @brief Updates the statistics of one position sensor with a new raw value
+ *
+ * The noise is estimated with an exponentially weighted Welford update over
+ * the frame-to-frame difference. Unlike the variance of the value itself,
+ * this variance is hardly affected by the motion of the sensor (it mainly
+ * contains 2 * sigma² of the sensor noise)
+ *
+ * @param pState    Pointer to the state of the sensor
+ * @param raw       New raw value in digits
+ */
+static void sensorDiagUpdateSensor(SensorDiagState_t* pState, int32_t raw)
+{
+    SensorDiagRecord_t* pRecord = &pState->record;
+    int32_t delta = raw - pState->previousRaw;
+    uint32_t slew = (uint32_t)((delta < 0) ? -delta : delta);
+    uint32_t flags = 0;
+
+    pState->previousRaw = raw;
+
+    // Running mean of the value
+    pRecord->meanQ8 += ((raw << 8) - pRecord->meanQ8) >> DIAG_WEIGHT_SHIFT;
+
+    // Welford update (exponentially weighted) of mean and variance of the difference
+    int32_t deltaQ8 = delta << 8;
+    int32_t diffOld = deltaQ8 - pState->meanDeltaQ8;
+    pState->meanDeltaQ8 += diffOld >> DIAG_WEIGHT_SHIFT;
+    int32_t diffNew = deltaQ8 - pState->meanDeltaQ8;
+
+    int64_t varianceSample = ((int64_t)diffOld * diffNew) >> 8;
+    int64_t variance = (int64_t)pRecord->varianceQ8 + ((varianceSample - (int64_t)pRecord->varianceQ8) >> DIAG_WEIGHT_SHIFT);
+    pRecord->varianceQ8 = (variance > (int64_t)UINT32_MAX) ? UINT32_MAX : (uint32_t)variance;
+
+    if (pRecord->varianceQ8 > DIAG_NOISE_LIMIT_Q8)
+    {
+        flags |= DIAG_FLAG_NOISY;
+    }
+
+    // A working pot always shows some LSB noise, a constant value indicates a stuck input
+    if (delta == 0)
+    {
+        pRecord->stuckFrames++;
+    }
+    else
+    {
+        pRecord->stuckFrames = 0;
+    }
+
+    if (pRecord->stuckFrames >= gStuckFrames)
+    {
+        flags |= DIAG_FLAG_STUCK;
+    }
+
+    if (slew > pRecord->maxSlew)
+    {
+        pRecord->maxSlew = slew;
+    }
+
+    if (slew > gMaxSlew)
+    {
+        pRecord->slewViolations++;
+        flags |= DIAG_FLAG_SLEW;
+    }
+
+    if (raw <= DIAG_RAW_MIN || raw >= DIAG_RAW_MAX)
+    {
+        pRecord->saturationCount++;
+        flags |= DIAG_FLAG_SATURATED;
+    }
+
+    pRecord->flags = flags;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file SensorDiagnostics.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Header file for the Sensor Diagnostics Module, which monitors the
+ * raw ADC stream of the position sensors (noise, stuck-at, slew rate and
+ * saturation) and the ADC/DMA data path (overrun, missed frames)
+ *
+ * @version 0.1
+ * @date 2023-03-08
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _SENSOR_DIAGNOSTICS_H_
+#define _SENSOR_DIAGNOSTICS_H_
+
+#include <stdint.h>
+
+#include "ADCModule.h"
+
+/*
+ * Public Defines
+*/
+#define DIAG_ERR_OK                     0           //!< No error occured
+#define DIAG_ERR_INVALID_PTR            -1          //!< Invalid pointer (Null Pointer)
+#define DIAG_ERR_INVALID_PARAM          -2          //!< Invalid parameter value
+
+#define DIAG_FLAG_NOISY                 0x01        //!< Noise of the sensor is above the limit
+#define DIAG_FLAG_STUCK                 0x02        //!< Sensor value didn't change for too long
+#define DIAG_FLAG_SLEW                  0x04        //!< Sensor value changed faster than plausible between two frames
+#define DIAG_FLAG_SATURATED             0x08        //!< Sensor value is at the limit of the ADC range (0 or 4095)
+
+/*
+ * Public Types
+*/
+
+/**
+ * @brief Diagnostic record of one position sensor
+ *
+ * Mean and variance are exponentially weighted, so they follow the recent
+ * samples. The variance is taken over the frame-to-frame difference, so it
+ * reflects the sensor noise rather than the motion
+ */
+typedef struct _SensorDiagRecord
+{
+    int32_t meanQ8;                             //!< Running mean of the raw value in digits (Q8)
+    uint32_t varianceQ8;                        //!< Running variance of the frame-to-frame difference in digits² (Q8)
+    uint32_t stuckFrames;                       //!< Number of consecutive frames with identical raw value
+    uint32_t maxSlew;                           //!< Largest change of the raw value between two frames in digits
+    uint32_t slewViolations;                    //!< Number of frames with an implausible change
+    uint32_t saturationCount;                   //!< Number of frames with a raw value of 0 or 4095
+    uint32_t flags;                             //!< Currently active DIAG_FLAG_xxx flags
+} SensorDiagRecord_t;
+
+/**
+ * @brief Diagnostic record of the ADC/DMA data path
+ *
+ */
+typedef struct _SensorDiagDataPath
+{
+    uint32_t frames;                            //!< Number of frames processed
+    uint32_t missedFrames;                      //!< Number of frames published by the ADC but never processed
+    uint32_t adcOverruns;                       //!< Number of ADC overruns
+    uint32_t dmaErrors;                         //!< Number of DMA transfer errors
+} SensorDiagDataPath_t;
+
+/**
+ * @brief Resets all diagnostic records, the limits are set for 100Hz
+ *
+ * @return Returns DIAG_ERR_OK if no error occured
+ */
+int32_t sensorDiagInitialize();
+
+/**
+ * @brief Converts the stuck and slew limits into frames for a new
+ * acquisition rate (the records are kept)
+ *
+ * @param periodUs      Frame period in µs
+ *
+ * @return Returns DIAG_ERR_OK if no error occured
+ */
+int32_t sensorDiagConfigureRate(uint32_t periodUs);
+
+/**
+ * @brief Updates the diagnostic records with a new ADC frame. Must be called
+ * exactly once for every new frame (see newData of ADCSnapshot_t)
+ *
+ * @param pSnapshot     Pointer to the new frame
+ *
+ * @return Returns DIAG_ERR_OK if no error occured
+ */
+int32_t sensorDiagProcessFrame(const ADCSnapshot_t* pSnapshot);
+
+/**
+ * @brief Copies the diagnostic record of a position sensor
+ *
+ * @param adcChannel    Position sensor (ADC_INPUT0 or ADC_INPUT1)
+ * @param pRecord       Pointer to store the record
+ *
+ * @return Returns DIAG_ERR_OK if no error occured
+ */
+int32_t sensorDiagReadRecord(ADC_Channel_t adcChannel, SensorDiagRecord_t* pRecord);
+
+/**
+ * @brief Copies the diagnostic record of the ADC/DMA data path
+ *
+ * @param pDataPath     Pointer to store the record
+ *
+ * @return Returns DIAG_ERR_OK if no error occured
+ */
+int32_t sensorDiagReadDataPath(SensorDiagDataPath_t* pDataPath);
+
+/**
+ * @brief Returns the combined DIAG_FLAG_xxx flags of all position sensors
+ *
+ * @return Returns the active flags
+ */
+uint32_t sensorDiagGetFlags();
+
+#endif
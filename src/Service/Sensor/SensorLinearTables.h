@@ -0,0 +1,27 @@
+/**
+ * @file SensorLinearTables.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Header file for the linearization tables of the sensor pipeline
+ *
+ * The tables are generated during the build by tools/linear_table.py from
+ * the calibration files in calibration/ (one CSV per sensor) and placed in
+ * flash. A new calibration only requires an updated CSV
+ *
+ * @version 0.1
+ * @date 2023-03-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _SENSOR_LINEAR_TABLES_H_
+#define _SENSOR_LINEAR_TABLES_H_
+
+#include "SensorPipeline.h"
+
+/*
+ * Public Variables
+*/
+extern const SensorLinearTable_t gSensorLinearPot1;    //!< Characteristic of pot 1 (µV to mm, calibration/pot1.csv)
+extern const SensorLinearTable_t gSensorLinearPot2;    //!< Characteristic of pot 2 (µV to mm, calibration/pot2.csv)
+
+#endif
@@ -0,0 +1,527 @@
+/**
+ * @file SensorPipeline.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of the Sensor Pipeline Module
+ *
+ * The stages of a channel are executed by one loop over its slice of the
+ * constant stage table, the stage type is dispatched by a switch (compiled
+ * to a jump table) instead of function pointers. The filter objects are
+ * statically allocated in the configuration section below
+ *
+ * The pots are converted from µV into mm by their calibrated
+ * characteristic before the tap stages, which feed the Kalman filter of the
+ * sensor fusion (runs after all chains of a frame)
+ *
+ * The CPU cycles of every chain execution are measured with the DWT cycle
+ * counter and can be read with sensorPipelineReadStats
+ *
+ * Builds with hardware FPU (FPU=hard defines SENSOR_USE_FLOAT) run the
+ * scale and EMA stages and the sensor fusion in single
+ * precision, the interface stays integer (µV). Both variants report their
+ * cycles through the same statistics, so they can be compared on target
+ *
+ * @version 0.1
+ * @date 2023-03-12
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <string.h>
+
+#include "stm32g4xx_hal.h"
+
+#include "Util/Filter/Filter.h"
+#include "SensorDiagnostics.h"
+#include "SensorLinearTables.h"
+
+#include "SensorPipeline.h"
+
+/*
+ * Private Defines
+*/
+#define SENSOR_STAGE_COUNT          (sizeof(gStages) / sizeof(gStages[0]))     //!< Number of stages of all chains
+
+#define SENSOR_POT_ALPHA_SHIFT      1           //!< Initial EMA alpha of the pots (2^-1, adjusted by the acquisition rate)
+#define SENSOR_SPIKE_WINDOW         5           //!< Initial median window of the spike rejection (frames at 100Hz, adjusted by the acquisition rate)
+#define SENSOR_SPIKE_THRESHOLD_Q3   40          //!< Spike threshold relative to the mean absolute deviation (5.0, Q3)
+#define SENSOR_SPIKE_MIN_DEVIATION  20000       //!< Deviations below 20mV are never treated as spikes (noise floor)
+#define SENSOR_POT_MIN_UV           0           //!< Lower limit of a plausible pot voltage in µV
+#define SENSOR_POT_MAX_UV           3400000     //!< Upper limit of a plausible pot voltage in µV (supply plus tolerance)
+
+#define SENSOR_FUSION_INPUT1        SENSOR_POT1 //!< First input channel of the sensor fusion
+#define SENSOR_FUSION_INPUT2        SENSOR_POT2 //!< Second input channel of the sensor fusion
+#define SENSOR_FUSION_ALPHA_Q15     7823        //!< Initial position gain of the fusion (steady state at 100Hz)
+#define SENSOR_FUSION_BETA_Q16      213037      //!< Initial velocity gain of the fusion (steady state at 100Hz)
+#define SENSOR_FUSION_PERIOD_US     10000       //!< Initial sample period of the fusion in µs
+
+#ifdef SENSOR_USE_FLOAT
+#define SENSOR_EMA_ALPHA(shift)     (1.0f / (float)(1UL << (shift)))    //!< Alpha of a float EMA stage for a shift value
+#endif
+
+/*
+ * Private Types
+*/
+
+/**
+ * @brief Runtime state of a sensor channel
+ *
+ */
+typedef struct _SensorChannelState
+{
+    int32_t inputValue;                         //!< Input of the chain for the last frame
+    int32_t value;                              //!< Output of the chain for the last frame
+    int32_t tapValue;                           //!< Value at the tap stage for the last frame (input of the fusion)
+    SensorChannelStats_t stats;                 //!< Runtime statistics
+} SensorChannelState_t;
+
+/*
+ * Configuration
+*/
+static HampelFilterData_t gSpikePot1;
+static HampelFilterData_t gSpikePot2;
+#ifdef SENSOR_USE_FLOAT
+static EMAFFilterData_t gEMAPot1;
+static EMAFFilterData_t gEMAPot2;
+static KalmanFFilterData_t gFusionFilter;
+#else
+static EMAQFilterData_t gEMAPot1;
+static EMAQFilterData_t gEMAPot2;
+static KalmanFilterData_t gFusionFilter;
+#endif
+
+//! Stages of all channels, the chain of a channel is a contiguous slice
+static const SensorStage_t gStages[] =
+{
+    // SENSOR_POT1
+    {SENSOR_STAGE_HAMPEL,   &gSpikePot1,    0,                      {SENSOR_SPIKE_WINDOW, SENSOR_SPIKE_THRESHOLD_Q3, SENSOR_SPIKE_MIN_DEVIATION}},
+    {SENSOR_STAGE_RANGE,    0,              0,                      {SENSOR_POT_MIN_UV, SENSOR_POT_MAX_UV, 0}},
+    {SENSOR_STAGE_LINEARIZE, 0,             &gSensorLinearPot1,     {0, 0, 0}},
+    {SENSOR_STAGE_TAP,      0,              0,                      {0, 0, 0}},
+    {SENSOR_STAGE_EMA,      &gEMAPot1,      0,                      {SENSOR_POT_ALPHA_SHIFT, 0, 0}},
+
+    // SENSOR_POT2
+    {SENSOR_STAGE_HAMPEL,   &gSpikePot2,    0,                      {SENSOR_SPIKE_WINDOW, SENSOR_SPIKE_THRESHOLD_Q3, SENSOR_SPIKE_MIN_DEVIATION}},
+    {SENSOR_STAGE_RANGE,    0,              0,                      {SENSOR_POT_MIN_UV, SENSOR_POT_MAX_UV, 0}},
+    {SENSOR_STAGE_LINEARIZE, 0,             &gSensorLinearPot2,     {0, 0, 0}},
+    {SENSOR_STAGE_TAP,      0,              0,                      {0, 0, 0}},
+    {SENSOR_STAGE_EMA,      &gEMAPot2,      0,                      {SENSOR_POT_ALPHA_SHIFT, 0, 0}}
+};
+
+//! Channel table, indexed by SensorId_t
+static const SensorChannelConfig_t gChannels[SENSOR_COUNT] =
+{
+    {ADC_INPUT0,    0,  5},         // SENSOR_POT1
+    {ADC_INPUT1,    5,  5}          // SENSOR_POT2
+};
+
+/*
+ * Private Module Variables
+*/
+static ADCSnapshot_t gSnapshot;                             //!< Last frame read from the ADC (sequence is used to detect new frames)
+static SensorChannelState_t gChannelState[SENSOR_COUNT];    //!< Runtime state of the channels
+static SensorFusion_t gFusion;                              //!< Output of the sensor fusion for the last frame
+
+/*
+ * Private Module Functions
+*/
+static int32_t sensorInitStage(const SensorStage_t* pStage);
+static int32_t sensorRunChain(const SensorChannelConfig_t* pChannel, SensorChannelState_t* pState, int32_t value);
+static int32_t sensorLinearize(const SensorLinearTable_t* pTable, int32_t value);
+static int32_t sensorInitFusion(int32_t alphaQ15, int32_t betaQ16, uint32_t periodUs, bool resetFilter);
+#ifdef SENSOR_USE_FLOAT
+static int32_t sensorRound(float value);
+#endif
+
+/*
+ * Public Module Functions
+*/
+
+int32_t sensorPipelineInitialize()
+{
+    memset(gChannelState, 0, sizeof(gChannelState));
+    memset(&gSnapshot, 0, sizeof(gSnapshot));
+    memset(&gFusion, 0, sizeof(gFusion));
+
+    for (uint32_t i=0; i<SENSOR_COUNT; i++)
+    {
+        if (gChannels[i].firstStage + gChannels[i].stageCount > SENSOR_STAGE_COUNT)
+        {
+            return SENSOR_ERR_CONFIG;
+        }
+    }
+
+    for (uint32_t i=0; i<SENSOR_STAGE_COUNT; i++)
+    {
+        if (sensorInitStage(&gStages[i]) != SENSOR_ERR_OK)
+        {
+            return SENSOR_ERR_CONFIG;
+        }
+    }
+
+    if (sensorInitFusion(SENSOR_FUSION_ALPHA_Q15, SENSOR_FUSION_BETA_Q16, SENSOR_FUSION_PERIOD_US, true) != FILTER_ERR_OK)
+    {
+        return SENSOR_ERR_CONFIG;
+    }
+
+    // Cycle counter for the runtime measurement
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    return SENSOR_ERR_OK;
+}
+
+int32_t sensorPipelineConfigureEMA(uint32_t alphaShift)
+{
+    for (uint32_t i=0; i<SENSOR_STAGE_COUNT; i++)
+    {
+        if (gStages[i].type == SENSOR_STAGE_EMA)
+        {
+            // Only the coefficient is changed, the filter state is kept
+#ifdef SENSOR_USE_FLOAT
+            if (alphaShift > FILTER_EMAQ_MAX_SHIFT ||
+                filterInitEMAF((EMAFFilterData_t*)gStages[i].pState, SENSOR_EMA_ALPHA(alphaShift), false) != FILTER_ERR_OK)
+#else
+            if (filterInitEMAQ((EMAQFilterData_t*)gStages[i].pState, alphaShift, false) != FILTER_ERR_OK)
+#endif
+            {
+                return SENSOR_ERR_INVALID_PARAM;
+            }
+        }
+    }
+
+    return SENSOR_ERR_OK;
+}
+
+int32_t sensorPipelineConfigureSpikeWindow(uint32_t windowSize)
+{
+    if ((windowSize & 1UL) == 0)
+    {
+        return SENSOR_ERR_INVALID_PARAM;
+    }
+
+    for (uint32_t i=0; i<SENSOR_STAGE_COUNT; i++)
+    {
+        const SensorStage_t* pStage = &gStages[i];
+
+        // The window of the median is resized by a new initialization, the rest of the stage configuration is kept
+        if (pStage->type == SENSOR_STAGE_HAMPEL &&
+            filterInitHampel((HampelFilterData_t*)pStage->pState, windowSize, pStage->param[1], pStage->param[2]) != FILTER_ERR_OK)
+        {
+            return SENSOR_ERR_INVALID_PARAM;
+        }
+    }
+
+    return SENSOR_ERR_OK;
+}
+
+int32_t sensorPipelineConfigureFusion(int32_t alphaQ15, int32_t betaQ16, uint32_t periodUs)
+{
+    if (sensorInitFusion(alphaQ15, betaQ16, periodUs, false) != FILTER_ERR_OK)
+    {
+        return SENSOR_ERR_INVALID_PARAM;
+    }
+
+    return SENSOR_ERR_OK;
+}
+
+bool sensorPipelineUpdate()
+{
+    // The snapshot keeps the sequence of the previous read, so a frame is only processed once
+    if (adcReadNextSnapshot(&gSnapshot) != ADC_ERR_OK || !gSnapshot.newData)
+    {
+        return false;
+    }
+
+    sensorDiagProcessFrame(&gSnapshot);
+
+    // All samples come from the same simultaneous ADC1/ADC2 conversion
+    for (uint32_t i=0; i<SENSOR_COUNT; i++)
+    {
+        const SensorChannelConfig_t* pChannel = &gChannels[i];
+        SensorChannelState_t* pState = &gChannelState[i];
+
+        uint32_t startCycles = DWT->CYCCNT;
+
+        pState->inputValue = gSnapshot.microVolt[pChannel->adcChannel];
+        pState->value = sensorRunChain(pChannel, pState, pState->inputValue);
+
+        uint32_t cycles = DWT->CYCCNT - startCycles;
+        pState->stats.cycles = cycles;
+        if (cycles > pState->stats.maxCycles)
+        {
+            pState->stats.maxCycles = cycles;
+        }
+    }
+
+#ifdef SENSOR_USE_FLOAT
+    gFusion.position = sensorRound(filterKalmanF(&gFusionFilter, (float)gChannelState[SENSOR_FUSION_INPUT1].tapValue, (float)gChannelState[SENSOR_FUSION_INPUT2].tapValue));
+    gFusion.velocity = sensorRound(gFusionFilter.velocity);
+    gFusion.innovation[0] = sensorRound(gFusionFilter.innovation[0]);
+    gFusion.innovation[1] = sensorRound(gFusionFilter.innovation[1]);
+#else
+    gFusion.position = filterKalman(&gFusionFilter, gChannelState[SENSOR_FUSION_INPUT1].tapValue, gChannelState[SENSOR_FUSION_INPUT2].tapValue);
+    gFusion.velocity = filterKalmanVelocity(&gFusionFilter);
+    gFusion.innovation[0] = gFusionFilter.innovation[0];
+    gFusion.innovation[1] = gFusionFilter.innovation[1];
+#endif
+
+    return true;
+}
+
+int32_t sensorPipelineGetValue(SensorId_t sensor)
+{
+    if (sensor < 0 || sensor >= SENSOR_COUNT)
+    {
+        return 0;
+    }
+
+    return gChannelState[sensor].value;
+}
+
+int32_t sensorPipelineGetInputValue(SensorId_t sensor)
+{
+    if (sensor < 0 || sensor >= SENSOR_COUNT)
+    {
+        return 0;
+    }
+
+    return gChannelState[sensor].inputValue;
+}
+
+int32_t sensorPipelineReadFusion(SensorFusion_t* pFusion)
+{
+    if (pFusion == 0)
+    {
+        return SENSOR_ERR_INVALID_PTR;
+    }
+
+    *pFusion = gFusion;
+
+    return SENSOR_ERR_OK;
+}
+
+int32_t sensorPipelineReadStats(SensorId_t sensor, SensorChannelStats_t* pStats)
+{
+    if (pStats == 0)
+    {
+        return SENSOR_ERR_INVALID_PTR;
+    }
+
+    if (sensor < 0 || sensor >= SENSOR_COUNT)
+    {
+        return SENSOR_ERR_INVALID_PARAM;
+    }
+
+    *pStats = gChannelState[sensor].stats;
+
+    return SENSOR_ERR_OK;
+}
+
+/**
+ * @brief Initializes the filter object of a stage and checks its configuration
+ *
+ * @param pStage    Pointer to the stage
+ *
+ * @return Returns SENSOR_ERR_OK if no error occured
+ */
+static int32_t sensorInitStage(const SensorStage_t* pStage)
+{
+    int32_t result = FILTER_ERR_OK;
+
+    switch (pStage->type)
+    {
+        case SENSOR_STAGE_SCALE:
+        case SENSOR_STAGE_RANGE:
+        case SENSOR_STAGE_TAP:
+            break;
+
+        case SENSOR_STAGE_HAMPEL:
+            result = filterInitHampel((HampelFilterData_t*)pStage->pState, (uint32_t)pStage->param[0], pStage->param[1], pStage->param[2]);
+            break;
+
+        case SENSOR_STAGE_MEDIAN:
+            result = filterInitMedian((MedianFilterData_t*)pStage->pState, (uint32_t)pStage->param[0]);
+            break;
+
+        case SENSOR_STAGE_BIQUAD:
+        {
+            BiquadQ31Data_t* pBiquad = (BiquadQ31Data_t*)pStage->pState;
+            result = (pBiquad == 0) ? FILTER_ERR_INVALID_PTR :
+                filterInitBiquadQ31(pBiquad, (uint32_t)pStage->param[0], (const int32_t*)pStage->pData, pBiquad->pState, pStage->param[1]);
+            break;
+        }
+
+        case SENSOR_STAGE_EMA:
+#ifdef SENSOR_USE_FLOAT
+            result = ((uint32_t)pStage->param[0] > FILTER_EMAQ_MAX_SHIFT) ? FILTER_ERR_INVALID_PARAM :
+                filterInitEMAF((EMAFFilterData_t*)pStage->pState, SENSOR_EMA_ALPHA((uint32_t)pStage->param[0]), true);
+#else
+            result = filterInitEMAQ((EMAQFilterData_t*)pStage->pState, (uint32_t)pStage->param[0], true);
+#endif
+            break;
+
+        case SENSOR_STAGE_LINEARIZE:
+        {
+            const SensorLinearTable_t* pTable = (const SensorLinearTable_t*)pStage->pData;
+            if (pTable == 0 || pTable->pOutput == 0 || pTable->segmentCount == 0 ||
+                pTable->segmentShift == 0 || pTable->segmentShift > 30)
+            {
+                result = FILTER_ERR_INVALID_PARAM;
+            }
+            break;
+        }
+
+        default:
+            result = FILTER_ERR_INVALID_PARAM;
+            break;
+    }
+
+    return (result == FILTER_ERR_OK) ? SENSOR_ERR_OK : SENSOR_ERR_CONFIG;
+}
+
+/**
+ * @brief Executes the chain of a channel for a new input value
+ *
+ * @param pChannel  Pointer to the channel configuration
+ * @param pState    Pointer to the runtime state of the channel
+ * @param value     Input value (ADC value in µV)
+ *
+ * @return Returns the output of the last stage
+ */
+static int32_t sensorRunChain(const SensorChannelConfig_t* pChannel, SensorChannelState_t* pState, int32_t value)
+{
+    const SensorStage_t* pStage = &gStages[pChannel->firstStage];
+    const SensorStage_t* pEnd = pStage + pChannel->stageCount;
+    uint32_t flags = 0;
+
+    for (; pStage<pEnd; pStage++)
+    {
+        switch (pStage->type)
+        {
+            case SENSOR_STAGE_SCALE:
+#ifdef SENSOR_USE_FLOAT
+                value = sensorRound((float)(value - pStage->param[0]) * ((float)pStage->param[1] * (1.0f / 65536.0f)));
+#else
+                value = (int32_t)(((int64_t)(value - pStage->param[0]) * pStage->param[1]) >> 16);
+#endif
+                break;
+
+            case SENSOR_STAGE_HAMPEL:
+                value = filterHampel((HampelFilterData_t*)pStage->pState, value);
+                break;
+
+            case SENSOR_STAGE_MEDIAN:
+                value = filterMedian((MedianFilterData_t*)pStage->pState, value);
+                break;
+
+            case SENSOR_STAGE_BIQUAD:
+                filterBiquadQ31((BiquadQ31Data_t*)pStage->pState, &value, &value, 1);
+                break;
+
+            case SENSOR_STAGE_EMA:
+#ifdef SENSOR_USE_FLOAT
+                value = sensorRound(filterEMAF((EMAFFilterData_t*)pStage->pState, (float)value));
+#else
+                value = filterEMAQ((EMAQFilterData_t*)pStage->pState, value);
+#endif
+                break;
+
+            case SENSOR_STAGE_LINEARIZE:
+                value = sensorLinearize((const SensorLinearTable_t*)pStage->pData, value);
+                break;
+
+            case SENSOR_STAGE_RANGE:
+                if (value < pStage->param[0] || value > pStage->param[1])
+                {
+                    value = (value < pStage->param[0]) ? pStage->param[0] : pStage->param[1];
+                    flags |= SENSOR_FLAG_RANGE;
+                    pState->stats.rangeViolations++;
+                }
+                break;
+
+            case SENSOR_STAGE_TAP:
+                pState->tapValue = value;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    pState->stats.flags = flags;
+
+    return value;
+}
+
+/**
+ * @brief Maps a value with a piecewise linear characteristic curve
+ *
+ * @param pTable    Pointer to the characteristic curve
+ * @param value     Input value
+ *
+ * @return Returns the interpolated output value
+ */
+static int32_t sensorLinearize(const SensorLinearTable_t* pTable, int32_t value)
+{
+    // Segment by shift (first/last segment for extrapolation)
+    int32_t offset = (int32_t)((int64_t)value - pTable->inputBase);
+    int32_t segment = offset >> pTable->segmentShift;
+
+    if (segment < 0)
+    {
+        segment = 0;
+    }
+    else if ((uint32_t)segment >= pTable->segmentCount)
+    {
+        segment = (int32_t)pTable->segmentCount - 1;
+    }
+
+    int32_t delta = offset - (segment << pTable->segmentShift);
+    int32_t y0 = pTable->pOutput[segment];
+    int32_t y1 = pTable->pOutput[segment + 1];
+
+    // Interpolation with one multiplication, the division by the segment width is a shift
+    return y0 + (int32_t)(((int64_t)delta * (y1 - y0) + (1LL << (pTable->segmentShift - 1))) >> pTable->segmentShift);
+}
+
+/**
+ * @brief Changes the gains of the sensor fusion (the fixed-point gains are
+ * converted for the float variant)
+ *
+ * @param alphaQ15      Position gain (Q15)
+ * @param betaQ16       Velocity gain divided by the sample period in 1/s (Q16)
+ * @param periodUs      Sample period in µs
+ * @param resetFilter   Flag to indicate whether the estimated state should be reset
+ *
+ * @return Returns FILTER_ERR_OK if no error occured
+ */
+static int32_t sensorInitFusion(int32_t alphaQ15, int32_t betaQ16, uint32_t periodUs, bool resetFilter)
+{
+#ifdef SENSOR_USE_FLOAT
+    return filterInitKalmanF(&gFusionFilter, (float)alphaQ15 * (1.0f / 32768.0f), (float)betaQ16 * (1.0f / 65536.0f),
+        (float)periodUs * 1.0e-6f, resetFilter);
+#else
+    return filterInitKalman(&gFusionFilter, alphaQ15, betaQ16, periodUs, resetFilter);
+#endif
+}
+
+#ifdef SENSOR_USE_FLOAT
+/**
+ * @brief Rounds a float value to the nearest integer (saturated to the
+ * int32_t range)
+ */
+static int32_t sensorRound(float value)
+{
+    if (value >= 2147483520.0f)
+    {
+        return INT32_MAX;
+    }
+
+    if (value <= -2147483648.0f)
+    {
+        return INT32_MIN;
+    }
+
+    return (int32_t)((value >= 0.0f) ? (value + 0.5f) : (value - 0.5f));
+}
+#endif
@@ -0,0 +1,228 @@
+/**
+ * @file SensorPipeline.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Header file for the Sensor Pipeline Module, which processes every
+ * registered sensor channel with a constant configured chain of stages
+ * (offset/gain, spike rejection, median, IIR, EMA, linearization and range
+ * diagnostics). Both pots are additionally fused by a Kalman filter into a
+ * position and velocity estimate
+ *
+ * The chains of all channels are stored in one flat stage table, each
+ * channel references a slice of it. Adding a sensor only requires a new
+ * entry in the channel table and its stages, no new code
+ *
+ * @version 0.1
+ * @date 2023-03-12
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _SENSOR_PIPELINE_H_
+#define _SENSOR_PIPELINE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ADCModule.h"
+
+/*
+ * Public Defines
+*/
+#define SENSOR_ERR_OK                   0           //!< No error occured
+#define SENSOR_ERR_INVALID_PTR          -1          //!< Invalid pointer (Null Pointer)
+#define SENSOR_ERR_INVALID_PARAM        -2          //!< Invalid parameter value
+#define SENSOR_ERR_CONFIG               -3          //!< Invalid stage configuration
+
+#define SENSOR_FLAG_RANGE               0x01        //!< Value was outside the plausible range of a range stage
+
+/*
+ * Public Types
+*/
+
+/**
+ * @brief Enumeration of the registered sensor channels
+ *
+ */
+typedef enum _SensorId
+{
+    SENSOR_POT1,                //!< Pot 1 (Position Sensor, ADC_INPUT0)
+    SENSOR_POT2,                //!< Pot 2 (Force Sensor, ADC_INPUT1)
+    SENSOR_COUNT                //!< Number of sensor channels
+} SensorId_t;
+
+/**
+ * @brief Enumeration of the stage types of a sensor chain
+ *
+ */
+typedef enum _SensorStageType
+{
+    SENSOR_STAGE_SCALE,         //!< value = (value - param[0]) * param[1] / 2^16 (offset and gain Q16)
+    SENSOR_STAGE_HAMPEL,        //!< Spike rejection: window param[0], threshold param[1] (Q3), noise floor param[2]
+    SENSOR_STAGE_MEDIAN,        //!< Median filter with window param[0]
+    SENSOR_STAGE_BIQUAD,        //!< Biquad cascade (Q31 coefficients) with param[0] stages, post shift param[1]
+    SENSOR_STAGE_EMA,           //!< Division free EMA filter with alpha 2^-param[0]
+    SENSOR_STAGE_LINEARIZE,     //!< Piecewise linear characteristic with equidistant points (SensorLinearTable_t)
+    SENSOR_STAGE_RANGE,         //!< Plausibility check: values outside param[0]..param[1] set SENSOR_FLAG_RANGE and are clamped
+    SENSOR_STAGE_TAP            //!< Provides the intermediate value as input of the sensor fusion (value is passed unchanged)
+} SensorStageType_t;
+
+/**
+ * @brief Characteristic curve of a linearization stage (generated from a
+ * calibration file, see SensorLinearTables.h)
+ *
+ * The points are spaced by 2^segmentShift starting at inputBase, so the
+ * segment of a value is found with a shift and interpolated with one
+ * multiplication. Values outside of the table are extrapolated with the
+ * first/last segment
+ */
+typedef struct _SensorLinearTable
+{
+    int32_t inputBase;                          //!< Input value of the first point
+    uint32_t segmentShift;                      //!< Distance of the points as shift value (1..30)
+    uint32_t segmentCount;                      //!< Number of segments (>= 1)
+    const int32_t* pOutput;                     //!< Output values of the points (segmentCount + 1)
+} SensorLinearTable_t;
+
+/**
+ * @brief Configuration of one stage of a sensor chain
+ *
+ * @remark The state buffer of a biquad stage must be assigned to the pState
+ * member of its BiquadQ31Data_t object (static initializer)
+ */
+typedef struct _SensorStage
+{
+    SensorStageType_t type;                     //!< Type of the stage
+    void* pState;                               //!< Filter object of the stage (type depends on the stage type), 0 for stateless stages
+    const void* pData;                          //!< Constant data of the stage (coefficients, characteristic curve), 0 if not used
+    int32_t param[3];                           //!< Parameters of the stage (see SensorStageType_t)
+} SensorStage_t;
+
+/**
+ * @brief Configuration of a sensor channel
+ *
+ */
+typedef struct _SensorChannelConfig
+{
+    ADC_Channel_t adcChannel;                   //!< ADC channel of the sensor
+    uint32_t firstStage;                        //!< Index of the first stage in the stage table
+    uint32_t stageCount;                        //!< Number of stages of the chain
+} SensorChannelConfig_t;
+
+/**
+ * @brief Runtime statistics of a sensor channel
+ *
+ */
+typedef struct _SensorChannelStats
+{
+    uint32_t cycles;                            //!< CPU cycles of the last chain execution
+    uint32_t maxCycles;                         //!< Maximum CPU cycles of a chain execution
+    uint32_t rangeViolations;                   //!< Number of values outside the range of a range stage
+    uint32_t flags;                             //!< SENSOR_FLAG_xxx flags of the last value
+} SensorChannelStats_t;
+
+/**
+ * @brief Output of the sensor fusion (Kalman filter over both pots)
+ *
+ */
+typedef struct _SensorFusion
+{
+    int32_t position;                           //!< Estimated position in mm
+    int32_t velocity;                           //!< Estimated velocity in mm/s
+    int32_t innovation[2];                      //!< Residual of each pot against the predicted position in mm
+} SensorFusion_t;
+
+/**
+ * @brief Initializes the filter objects of all stages and the statistics.
+ * The configuration tables are checked for consistency
+ *
+ * @return Returns SENSOR_ERR_OK if no error occured
+ */
+int32_t sensorPipelineInitialize();
+
+/**
+ * @brief Changes the alpha value of all EMA stages, the filter states are
+ * kept for a seamless transition
+ *
+ * @param alphaShift    Alpha as shift value (alpha = 2^-alphaShift)
+ *
+ * @return Returns SENSOR_ERR_OK if no error occured
+ */
+int32_t sensorPipelineConfigureEMA(uint32_t alphaShift);
+
+/**
+ * @brief Changes the window of all spike rejection (Hampel) stages, so it
+ * covers about the same time at a new acquisition rate. The windows are
+ * cleared, spikes are detected again once they are filled
+ *
+ * @param windowSize    Window in frames (1..FILTER_MEDIAN_MAX_WINDOW, odd)
+ *
+ * @return Returns SENSOR_ERR_OK if no error occured
+ */
+int32_t sensorPipelineConfigureSpikeWindow(uint32_t windowSize);
+
+/**
+ * @brief Changes the steady state gains of the sensor fusion for a new
+ * sample period, the estimated state is kept
+ *
+ * @param alphaQ15      Position gain (Q15)
+ * @param betaQ16       Velocity gain divided by the sample period in 1/s (Q16)
+ * @param periodUs      Sample period in µs
+ *
+ * @return Returns SENSOR_ERR_OK if no error occured
+ */
+int32_t sensorPipelineConfigureFusion(int32_t alphaQ15, int32_t betaQ16, uint32_t periodUs);
+
+/**
+ * @brief Processes all sensor channels with the next frame the ADC has
+ * published since the last call. Each frame is processed exactly once and in
+ * order (including the frame based sensor diagnostics), the results are
+ * cached
+ *
+ * @remark Only one frame is processed per call, so the caller can handle the
+ * results of every frame. It has to call again while it returns true (the
+ * ADC keeps the last frames, see ADCFrame.h)
+ *
+ * @return Returns true if a new frame has been processed
+ */
+bool sensorPipelineUpdate();
+
+/**
+ * @brief Returns the output value of a sensor channel for the last frame
+ *
+ * @param sensor    Sensor channel
+ *
+ * @return Returns the output of the chain, the position in mm for the pots
+ * (0 for an invalid channel)
+ */
+int32_t sensorPipelineGetValue(SensorId_t sensor);
+
+/**
+ * @brief Returns the input value of a sensor channel for the last frame
+ * (unfiltered ADC value)
+ *
+ * @param sensor    Sensor channel
+ *
+ * @return Returns the input of the chain in µV (0 for an invalid channel)
+ */
+int32_t sensorPipelineGetInputValue(SensorId_t sensor);
+
+/**
+ * @brief Copies the output of the sensor fusion for the last frame
+ *
+ * @param pFusion   Pointer to store the fusion output
+ *
+ * @return Returns SENSOR_ERR_OK if no error occured
+ */
+int32_t sensorPipelineReadFusion(SensorFusion_t* pFusion);
+
+/**
+ * @brief Copies the runtime statistics of a sensor channel
+ *
+ * @param sensor    Sensor channel
+ * @param pStats    Pointer to store the statistics
+ *
+ * @return Returns SENSOR_ERR_OK if no error occured
+ */
+int32_t sensorPipelineReadStats(SensorId_t sensor, SensorChannelStats_t* pStats);
+
+#endif
@@ -0,0 +1,272 @@
+/**
+ * @file VibrationAnalysis.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of the Vibration Analysis Module
+ *
+ * A block is captured with a resolution of VIB_LSB_UV, the mean is removed
+ * and the block is normalized to the Q15 range of the FFT (block floating
+ * point), so small vibrations keep their resolution. After a Hann window the
+ * watched frequency is measured with the Goertzel algorithm and the full
+ * spectrum with the real FFT
+ *
+ * For a sinusoid of amplitude a the Hann windowed bin has the magnitude
+ * a / 4 (FFT scaling 1 / N), which is used to convert bins into amplitudes
+ *
+ * @version 0.1
+ * @date 2023-03-15
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <string.h>
+
+#include "Util/Spectrum/Spectrum.h"
+#include "AcquisitionRate.h"
+
+#include "VibrationAnalysis.h"
+
+/*
+ * Private Defines
+*/
+#define VIB_FFT_SIZE                512         //!< Number of samples per block
+#define VIB_LSB_UV                  100         //!< Resolution of the captured samples in µV
+#define VIB_NORM_LIMIT              16383       //!< Maximum sample value after normalization (FFT input limit)
+#define VIB_FIRST_BIN               2           //!< First bin used for peaks and noise floor (bins below contain DC leakage)
+#define VIB_PEAK_GUARD              2           //!< Bins on each side of a peak excluded from the noise floor
+#define VIB_WATCH_FREQUENCY_MHZ     25000       //!< Watched frequency in mHz (rope resonance)
+
+/*
+ * Private Module Variables
+*/
+static SpectrumFFTData_t gFFT;                          //!< FFT instance (sine table)
+static int16_t gCapture[VIB_FFT_SIZE];                  //!< Captured samples (VIB_LSB_UV)
+static uint32_t gCaptureCount;                          //!< Number of captured samples
+static uint32_t gCaptureRateHz;                         //!< Sampling rate of the current block
+static int16_t gWork[VIB_FFT_SIZE];                     //!< Working buffer (samples, then bins)
+static uint32_t gPower[VIB_FFT_SIZE / 2];               //!< Power of the bins
+static VibSpectrum_t gSpectrum;                         //!< Result of the last block
+
+/*
+ * Private Module Functions
+*/
+static int32_t vibNormalize(void);
+static uint32_t vibAmplitude(uint32_t power, int32_t normShift);
+static void vibFindPeaks(int32_t normShift);
+
+/*
+ * Public Module Functions
+*/
+
+int32_t vibInitialize()
+{
+    memset(&gSpectrum, 0, sizeof(gSpectrum));
+    gCaptureCount   = 0;
+    gCaptureRateHz  = acqGetRate();
+
+    if (spectrumInitFFT(&gFFT, VIB_FFT_SIZE) != SPECTRUM_ERR_OK)
+    {
+        return VIB_ERR_INIT_FAILURE;
+    }
+
+    return VIB_ERR_OK;
+}
+
+void vibCaptureSample(int32_t microVolt)
+{
+    uint32_t rateHz = acqGetRate();
+
+    // A block must have a constant sampling rate
+    if (rateHz != gCaptureRateHz)
+    {
+        gCaptureRateHz  = rateHz;
+        gCaptureCount   = 0;
+    }
+
+    if (gCaptureCount >= VIB_FFT_SIZE)
+    {
+        return;
+    }
+
+    int32_t sample = microVolt / VIB_LSB_UV;
+    gCapture[gCaptureCount++] = (int16_t)((sample > INT16_MAX) ? INT16_MAX : ((sample < 0) ? 0 : sample));
+}
+
+bool vibProcess()
+{
+    if (gCaptureCount < VIB_FFT_SIZE)
+    {
+        return false;
+    }
+
+    int32_t normShift = vibNormalize();
+
+    // The capture buffer is free again
+    uint32_t rateHz = gCaptureRateHz;
+    gCaptureCount = 0;
+
+    spectrumWindowHann(&gFFT, gWork);
+
+    // Watched frequency (time domain, before the FFT overwrites the samples)
+    uint32_t watchBin = (uint32_t)(((uint64_t)VIB_WATCH_FREQUENCY_MHZ * VIB_FFT_SIZE + rateHz * 500UL) / (rateHz * 1000UL));
+    uint32_t watchPower = 0;
+
+    if (spectrumGoertzel(&gFFT, gWork, watchBin, &watchPower) != SPECTRUM_ERR_OK)
+    {
+        watchPower = 0;
+    }
+
+    spectrumRealFFT(&gFFT, gWork);
+    spectrumPower(&gFFT, gWork, gPower);
+
+    gSpectrum.sampleRateHz      = rateHz;
+    gSpectrum.resolutionMilliHz = (rateHz * 1000UL) / VIB_FFT_SIZE;
+    gSpectrum.watchAmplitude    = vibAmplitude(watchPower, normShift);
+
+    vibFindPeaks(normShift);
+
+    gSpectrum.blockCount++;
+
+    return true;
+}
+
+int32_t vibReadSpectrum(VibSpectrum_t* pSpectrum)
+{
+    if (pSpectrum == 0)
+    {
+        return VIB_ERR_INVALID_PTR;
+    }
+
+    *pSpectrum = gSpectrum;
+
+    return VIB_ERR_OK;
+}
+
+/**
+ * @brief Copies the captured block into the working buffer without mean
+ * and scales it to the FFT input range
+ *
+ * @return Returns the applied normalization shift (-1 .. 15, negative for a
+ * right shift)
+ */
+static int32_t vibNormalize(void)
+{
+    int32_t sum = 0;
+    for (uint32_t i=0; i<VIB_FFT_SIZE; i++)
+    {
+        sum += gCapture[i];
+    }
+
+    int32_t mean = sum / VIB_FFT_SIZE;
+    int32_t maxAbs = 0;
+
+    for (uint32_t i=0; i<VIB_FFT_SIZE; i++)
+    {
+        int32_t value = gCapture[i] - mean;
+        int32_t absValue = (value < 0) ? -value : value;
+
+        if (absValue > maxAbs)
+        {
+            maxAbs = absValue;
+        }
+    }
+
+    int32_t normShift = 0;
+
+    if (maxAbs > VIB_NORM_LIMIT)
+    {
+        normShift = -1;
+    }
+    else if (maxAbs != 0)
+    {
+        while (normShift < 15 && (maxAbs << (normShift + 1)) <= VIB_NORM_LIMIT)
+        {
+            normShift++;
+        }
+    }
+
+    for (uint32_t i=0; i<VIB_FFT_SIZE; i++)
+    {
+        int32_t value = gCapture[i] - mean;
+        gWork[i] = (int16_t)((normShift >= 0) ? (value << normShift) : (value >> 1));
+    }
+
+    return normShift;
+}
+
+/**
+ * @brief Converts the power of a bin into the amplitude of a sinusoid in µV
+ *
+ * @param power     Power of the bin (Q15²)
+ * @param normShift Normalization shift of the block
+ *
+ * @return Returns the amplitude in µV
+ */
+static uint32_t vibAmplitude(uint32_t power, int32_t normShift)
+{
+    uint64_t amplitude = (uint64_t)spectrumSqrt(power) * 4 * VIB_LSB_UV;
+
+    return (uint32_t)((normShift >= 0) ? (amplitude >> normShift) : (amplitude << 1));
+}
+
+/**
+ * @brief Searches the largest local maxima of the spectrum and computes
+ * the noise floor from the remaining bins
+ *
+ * @param normShift Normalization shift of the block
+ */
+static void vibFindPeaks(int32_t normShift)
+{
+    uint32_t peakBins[VIB_PEAK_COUNT] = {0};
+
+    for (uint32_t k=VIB_FIRST_BIN; k<VIB_FFT_SIZE/2-1; k++)
+    {
+        if (gPower[k] <= gPower[k - 1] || gPower[k] < gPower[k + 1])
+        {
+            continue;
+        }
+
+        // Insert into the ordered peak list
+        for (uint32_t p=0; p<VIB_PEAK_COUNT; p++)
+        {
+            if (peakBins[p] == 0 || gPower[k] > gPower[peakBins[p]])
+            {
+                for (uint32_t q=VIB_PEAK_COUNT-1; q>p; q--)
+                {
+                    peakBins[q] = peakBins[q - 1];
+                }
+                peakBins[p] = k;
+                break;
+            }
+        }
+    }
+
+    uint64_t noiseSum = 0;
+    uint32_t noiseBins = 0;
+
+    for (uint32_t k=VIB_FIRST_BIN; k<VIB_FFT_SIZE/2; k++)
+    {
+        bool isPeak = false;
+
+        for (uint32_t p=0; p<VIB_PEAK_COUNT; p++)
+        {
+            if (peakBins[p] != 0 && k + VIB_PEAK_GUARD >= peakBins[p] && k <= peakBins[p] + VIB_PEAK_GUARD)
+            {
+                isPeak = true;
+            }
+        }
+
+        if (!isPeak)
+        {
+            noiseSum += gPower[k];
+            noiseBins++;
+        }
+    }
+
+    for (uint32_t p=0; p<VIB_PEAK_COUNT; p++)
+    {
+        gSpectrum.peaks[p].frequencyMilliHz = (uint32_t)(((uint64_t)peakBins[p] * gSpectrum.sampleRateHz * 1000UL) / VIB_FFT_SIZE);
+        gSpectrum.peaks[p].amplitude        = (peakBins[p] != 0) ? vibAmplitude(gPower[peakBins[p]], normShift) : 0;
+    }
+
+    gSpectrum.noiseFloor = (noiseBins != 0) ? vibAmplitude((uint32_t)(noiseSum / noiseBins), normShift) : 0;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file VibrationAnalysis.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Header file for the Vibration Analysis Module, which captures
+ * blocks of the unfiltered position signal and reports the dominant
+ * vibration frequencies, the noise floor and the amplitude at a watched
+ * frequency (e.g. a rope resonance)
+ *
+ * @version 0.1
+ * @date 2023-03-15
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _VIBRATION_ANALYSIS_H_
+#define _VIBRATION_ANALYSIS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Public Defines
+*/
+#define VIB_ERR_OK                  0           //!< No error occured
+#define VIB_ERR_INVALID_PTR         -1          //!< Invalid pointer (Null Pointer)
+#define VIB_ERR_INIT_FAILURE        -2          //!< FFT couldn't be initialized
+
+#define VIB_PEAK_COUNT              3           //!< Number of reported spectral peaks
+
+/*
+ * Public Types
+*/
+
+/**
+ * @brief Spectral peak
+ *
+ */
+typedef struct _VibPeak
+{
+    uint32_t frequencyMilliHz;                  //!< Frequency of the peak in mHz (0 if no peak was found)
+    uint32_t amplitude;                         //!< Amplitude of the vibration in µV
+} VibPeak_t;
+
+/**
+ * @brief Result of the last analyzed block
+ *
+ * @remark The noise floor is the mean bin magnitude (without DC and peaks),
+ * expressed as amplitude of a sinusoid with the same bin magnitude
+ */
+typedef struct _VibSpectrum
+{
+    uint32_t blockCount;                        //!< Number of analyzed blocks
+    uint32_t sampleRateHz;                      //!< Sampling rate of the last block in Hz
+    uint32_t resolutionMilliHz;                 //!< Bin width of the last block in mHz
+    VibPeak_t peaks[VIB_PEAK_COUNT];            //!< Dominant peaks, ordered by amplitude
+    uint32_t noiseFloor;                        //!< Noise floor in µV
+    uint32_t watchAmplitude;                    //!< Amplitude at the watched frequency in µV (0 if above Nyquist)
+} VibSpectrum_t;
+
+/**
+ * @brief Initializes the FFT and starts the capture of the first block
+ *
+ * @return Returns VIB_ERR_OK if no error occured
+ */
+int32_t vibInitialize();
+
+/**
+ * @brief Adds a sample of a new ADC frame to the capture block. The capture
+ * restarts if the sampling rate changes during a block
+ *
+ * @param microVolt     Unfiltered position sensor value in µV
+ */
+void vibCaptureSample(int32_t microVolt);
+
+/**
+ * @brief Analyzes the captured block if it is complete and restarts the
+ * capture. Intended for a background task (runtime in the range of 1ms)
+ *
+ * @return Returns true if a new block has been analyzed
+ */
+bool vibProcess();
+
+/**
+ * @brief Copies the result of the last analyzed block
+ *
+ * @param pSpectrum     Pointer to store the result
+ *
+ * @return Returns VIB_ERR_OK if no error occured
+ */
+int32_t vibReadSpectrum(VibSpectrum_t* pSpectrum);
+
+#endif
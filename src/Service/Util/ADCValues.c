@@ -1,35 +1,34 @@
 #include "ADCModule.h"
-#include "Util/Filter/Filter.h"
-
-
-EMAFilterData_t Input_Pot1;
-EMAFilterData_t Input_Pot2;
+#include "ADCValues.h"
+#include "SensorPipeline.h"
 
 
 void initFilters(){
 
-	 filterInitEMA(&Input_Pot1, 10, 5, false);
-	 filterInitEMA(&Input_Pot2, 10, 5, false);
+	 sensorPipelineInitialize();
 }
 
 
-int32_t filteredChannel1(){
+int32_t configureFilters(uint32_t alphaShift){
 
-	int32_t adcMicroVoltValue=adcReadChannel(ADC_INPUT0);
+	return sensorPipelineConfigureEMA(alphaShift);
+}
 
-	int32_t filteredValue = filterEMA(&Input_Pot1, adcMicroVoltValue);
 
-	return filteredValue;
+bool updateFilters(){
 
+	return sensorPipelineUpdate();
 }
 
-int32_t filteredChannel2(){
-
-	int32_t adcMicroVoltValue=adcReadChannel(ADC_INPUT1);
 
-	int32_t filteredValue = filterEMA(&Input_Pot2, adcMicroVoltValue);
+int32_t filteredChannel1(){
 
-	return filteredValue;
+	return sensorPipelineGetValue(SENSOR_POT1);
 
 }
 
+int32_t filteredChannel2(){
+
+	return sensorPipelineGetValue(SENSOR_POT2);
+
+}
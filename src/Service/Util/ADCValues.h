@@ -1,10 +1,32 @@
 #ifndef _ADCVALUES_H_
 #define _ADCVALUES_H_
 
+#include <stdbool.h>
+#include <stdint.h>
 
+#include "SensorPipeline.h"
 
 void initFilters();
 
+/**
+ * @brief Changes the EMA coefficient of the position sensor filters
+ *
+ * @param alphaShift    Alpha as shift value (alpha = 2^-alphaShift)
+ *
+ * @return Returns SENSOR_ERR_OK if no error occured
+ */
+int32_t configureFilters(uint32_t alphaShift);
+
+/**
+ * @brief Filters the position sensors with the next frame the ADC has
+ * published since the last call (see sensorPipelineUpdate). Each frame is
+ * filtered exactly once, the results are cached for filteredChannel1 and
+ * filteredChannel2. Call again while it returns true
+ *
+ * @return Returns true if a new frame has been filtered
+ */
+bool updateFilters();
+
 int32_t filteredChannel1();
 
 int32_t filteredChannel2();
@@ -0,0 +1,275 @@
+/**
+ * @file ButtonGesture.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of the Button Gesture Module
+ *
+ * Every button has a small state machine with fixed memory. The gestures
+ * are decided on the µs timestamps of the debounced edges, timeouts (long
+ * press, end of the double click window) are checked against the timestamp
+ * of the next edge and at the end of every gestureProcess call. A click is
+ * only delayed by the double click window if a double click is mapped for
+ * the button
+ *
+ * The CPU cycles per button event are measured with the DWT cycle counter
+ * (enabled by the sensor pipeline)
+ *
+ * @version 0.1
+ * @date 2023-03-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "stm32g4xx_hal.h"
+
+#include "TimerModule.h"
+#include "ButtonGesture.h"
+
+/*
+ * Private Types
+*/
+
+/**
+ * @brief States of the gesture recognition of a button
+ *
+ */
+typedef enum _GestureState
+{
+    GESTURE_STATE_IDLE,             //!< Button released, no gesture in progress
+    GESTURE_STATE_PRESSED,          //!< Button pressed (click, long press or chord possible)
+    GESTURE_STATE_WAIT_SECOND,      //!< Released after a short press, waiting for a second press
+    GESTURE_STATE_HELD,             //!< Gesture decided, waiting for the release
+    GESTURE_STATE_CHORD             //!< Part of a chord, waiting for the release
+} GestureState_t;
+
+/**
+ * @brief Runtime state of a button
+ *
+ */
+typedef struct _GestureButton
+{
+    GestureState_t state;           //!< State of the recognition
+    uint32_t pressTime;             //!< Time of the last press in µs
+    uint32_t releaseTime;           //!< Time of the last release in µs
+    bool doubleClickMapped;         //!< A double click is mapped for the button (clicks wait for the second press)
+} GestureButton_t;
+
+/*
+ * Private Module Variables
+*/
+static const GestureMapping_t* gpMapping;           //!< Mapping table
+static uint32_t gMappingCount;                      //!< Number of entries of the mapping table
+static GesturePostEvent gPostEvent;                 //!< Function to post the mapped events
+static GestureButton_t gButtons[BTN_COUNT];         //!< Runtime state of the buttons
+static GestureStats_t gStats;                       //!< Runtime statistics
+
+/*
+ * Private Module Functions
+*/
+static void gestureHandleEvent(const ButtonEvent_t* pEvent);
+static void gestureCheckTimeout(uint32_t button, uint32_t now);
+static void gestureEmit(uint32_t buttonMask, Gesture_t gesture, uint32_t decisionTime);
+
+/*
+ * Public Module Functions
+*/
+
+int32_t gestureInitialize(const GestureMapping_t* pMapping, uint32_t mappingCount, GesturePostEvent postEvent)
+{
+    if ((pMapping == 0 && mappingCount != 0) || postEvent == 0)
+    {
+        return GESTURE_ERR_INVALID_PTR;
+    }
+
+    memset(gButtons, 0, sizeof(gButtons));
+    memset(&gStats, 0, sizeof(gStats));
+
+    for (uint32_t i=0; i<mappingCount; i++)
+    {
+        if (pMapping[i].buttonMask == 0 || pMapping[i].buttonMask >= GESTURE_BUTTON(BTN_COUNT))
+        {
+            return GESTURE_ERR_INVALID_PARAM;
+        }
+
+        for (uint32_t b=0; b<BTN_COUNT; b++)
+        {
+            if (pMapping[i].gesture == GESTURE_DOUBLE_CLICK && pMapping[i].buttonMask == GESTURE_BUTTON(b))
+            {
+                gButtons[b].doubleClickMapped = true;
+            }
+        }
+    }
+
+    gpMapping       = pMapping;
+    gMappingCount   = mappingCount;
+    gPostEvent      = postEvent;
+
+    return GESTURE_ERR_OK;
+}
+
+void gestureProcess()
+{
+    if (gPostEvent == 0)
+    {
+        return;
+    }
+
+    ButtonEvent_t event;
+
+    while (buttonReadEvent(&event) == BUTTON_ERR_OK)
+    {
+        uint32_t startCycles = DWT->CYCCNT;
+
+        gestureHandleEvent(&event);
+
+        uint32_t cycles = DWT->CYCCNT - startCycles;
+        gStats.cycles = cycles;
+        if (cycles > gStats.maxCycles)
+        {
+            gStats.maxCycles = cycles;
+        }
+    }
+
+    uint32_t now = timerGetMicroseconds();
+
+    for (uint32_t b=0; b<BTN_COUNT; b++)
+    {
+        gestureCheckTimeout(b, now);
+    }
+}
+
+int32_t gestureReadStats(GestureStats_t* pStats)
+{
+    if (pStats == 0)
+    {
+        return GESTURE_ERR_INVALID_PTR;
+    }
+
+    *pStats = gStats;
+
+    return GESTURE_ERR_OK;
+}
+
+/**
+ * @brief Advances the state machines with a debounced button event
+ *
+ * @param pEvent    Pointer to the button event
+ */
+static void gestureHandleEvent(const ButtonEvent_t* pEvent)
+{
+    uint32_t button = (uint32_t)pEvent->button;
+    uint32_t time = pEvent->timestamp;
+
+    if (button >= BTN_COUNT)
+    {
+        return;
+    }
+
+    // Timeouts which expired before this edge are decided first
+    for (uint32_t b=0; b<BTN_COUNT; b++)
+    {
+        gestureCheckTimeout(b, time);
+    }
+
+    GestureButton_t* pButton = &gButtons[button];
+
+    if (pEvent->status == BUTTON_PRESSED)
+    {
+        gestureEmit(GESTURE_BUTTON(button), GESTURE_PRESS, time);
+
+        if (pButton->state == GESTURE_STATE_WAIT_SECOND)
+        {
+            gestureEmit(GESTURE_BUTTON(button), GESTURE_DOUBLE_CLICK, time);
+            pButton->state = GESTURE_STATE_HELD;
+            return;
+        }
+
+        // A second button pressed shortly after the first one forms a chord
+        for (uint32_t b=0; b<BTN_COUNT; b++)
+        {
+            if (b != button && gButtons[b].state == GESTURE_STATE_PRESSED && (uint32_t)(time - gButtons[b].pressTime) <= GESTURE_CHORD_US)
+            {
+                gestureEmit(GESTURE_BUTTON(button) | GESTURE_BUTTON(b), GESTURE_CHORD, time);
+                gButtons[b].state   = GESTURE_STATE_CHORD;
+                pButton->state      = GESTURE_STATE_CHORD;
+                return;
+            }
+        }
+
+        pButton->state      = GESTURE_STATE_PRESSED;
+        pButton->pressTime  = time;
+    }
+    else
+    {
+        gestureEmit(GESTURE_BUTTON(button), GESTURE_RELEASE, time);
+
+        if (pButton->state == GESTURE_STATE_PRESSED)
+        {
+            if (pButton->doubleClickMapped)
+            {
+                pButton->state          = GESTURE_STATE_WAIT_SECOND;
+                pButton->releaseTime    = time;
+                return;
+            }
+
+            gestureEmit(GESTURE_BUTTON(button), GESTURE_CLICK, time);
+        }
+
+        pButton->state = GESTURE_STATE_IDLE;
+    }
+}
+
+/**
+ * @brief Decides the gestures of a button which depend on a timeout
+ *
+ * @param button    Button to check
+ * @param now       Current time (or time of the next edge) in µs
+ */
+static void gestureCheckTimeout(uint32_t button, uint32_t now)
+{
+    GestureButton_t* pButton = &gButtons[button];
+
+    if (pButton->state == GESTURE_STATE_PRESSED && (uint32_t)(now - pButton->pressTime) >= GESTURE_LONG_PRESS_US)
+    {
+        gestureEmit(GESTURE_BUTTON(button), GESTURE_LONG_PRESS, pButton->pressTime + GESTURE_LONG_PRESS_US);
+        pButton->state = GESTURE_STATE_HELD;
+    }
+    else if (pButton->state == GESTURE_STATE_WAIT_SECOND && (uint32_t)(now - pButton->releaseTime) > GESTURE_DOUBLE_CLICK_US)
+    {
+        gestureEmit(GESTURE_BUTTON(button), GESTURE_CLICK, pButton->releaseTime + GESTURE_DOUBLE_CLICK_US);
+        pButton->state = GESTURE_STATE_IDLE;
+    }
+}
+
+/**
+ * @brief Posts the mapped event of a recognized gesture and updates the
+ * recognition time
+ *
+ * @param buttonMask    Buttons of the gesture
+ * @param gesture       Recognized gesture
+ * @param decisionTime  Time of the deciding edge or timeout in µs
+ */
+static void gestureEmit(uint32_t buttonMask, Gesture_t gesture, uint32_t decisionTime)
+{
+    gStats.gestureCount++;
+
+    for (uint32_t i=0; i<gMappingCount; i++)
+    {
+        if (gpMapping[i].buttonMask == buttonMask && gpMapping[i].gesture == gesture)
+        {
+            if (gPostEvent(gpMapping[i].eventID) != 0)
+            {
+                gStats.postFailures++;
+            }
+        }
+    }
+
+    uint32_t recognitionUs = timerGetMicroseconds() - decisionTime;
+    gStats.recognitionUs = recognitionUs;
+    if (recognitionUs > gStats.maxRecognitionUs)
+    {
+        gStats.maxRecognitionUs = recognitionUs;
+    }
+}
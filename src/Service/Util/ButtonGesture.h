@@ -0,0 +1,112 @@
+/**
+ * @file ButtonGesture.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Header file for the Button Gesture Module, which recognizes
+ * gestures (press, release, click, double click, long press and chords of
+ * two buttons) on the debounced button events and posts the mapped events
+ * into the event queue of a state machine
+ *
+ * @version 0.1
+ * @date 2023-03-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _BUTTON_GESTURE_H_
+#define _BUTTON_GESTURE_H_
+
+#include <stdint.h>
+
+#include "ButtonModule.h"
+
+/*
+ * Public Defines
+*/
+#define GESTURE_ERR_OK                  0           //!< No error occured
+#define GESTURE_ERR_INVALID_PTR         -1          //!< Invalid pointer (Null Pointer)
+#define GESTURE_ERR_INVALID_PARAM       -2          //!< Invalid parameter value
+
+#define GESTURE_LONG_PRESS_US           800000UL    //!< Hold time of a long press in µs
+#define GESTURE_DOUBLE_CLICK_US         300000UL    //!< Maximum time between the release and the second press of a double click in µs
+#define GESTURE_CHORD_US                100000UL    //!< Maximum time between the presses of a chord in µs
+
+//! Button mask of a mapping entry
+#define GESTURE_BUTTON(button)          (1UL << (button))
+
+/*
+ * Public Types
+*/
+
+/**
+ * @brief Enumeration of the recognized gestures
+ *
+ */
+typedef enum _Gesture
+{
+    GESTURE_PRESS,                  //!< Button pressed (immediately, also as part of other gestures)
+    GESTURE_RELEASE,                //!< Button released (immediately, also as part of other gestures)
+    GESTURE_CLICK,                  //!< Short press (delayed by GESTURE_DOUBLE_CLICK_US if a double click is mapped for the button)
+    GESTURE_DOUBLE_CLICK,           //!< Two short presses
+    GESTURE_LONG_PRESS,             //!< Button held for GESTURE_LONG_PRESS_US (no click on the release)
+    GESTURE_CHORD                   //!< Two buttons pressed within GESTURE_CHORD_US (no other gestures until both are released)
+} Gesture_t;
+
+/**
+ * @brief Entry of the mapping table from gestures to state machine events
+ *
+ */
+typedef struct _GestureMapping
+{
+    uint32_t buttonMask;            //!< GESTURE_BUTTON of the button, or of both buttons of a chord
+    Gesture_t gesture;              //!< Recognized gesture
+    int32_t eventID;                //!< Event which is posted for the gesture
+} GestureMapping_t;
+
+/**
+ * @brief Function which posts an event into the queue of a state machine
+ *
+ */
+typedef int32_t (*GesturePostEvent)(int32_t eventID);
+
+/**
+ * @brief Runtime statistics of the gesture recognition
+ *
+ */
+typedef struct _GestureStats
+{
+    uint32_t gestureCount;          //!< Number of recognized gestures (mapped or not)
+    uint32_t postFailures;          //!< Number of mapped events which couldn't be posted
+    uint32_t recognitionUs;         //!< Recognition time of the last gesture in µs (deciding edge or timeout until posting)
+    uint32_t maxRecognitionUs;      //!< Maximum recognition time in µs
+    uint32_t cycles;                //!< CPU cycles of the last processed button event
+    uint32_t maxCycles;             //!< Maximum CPU cycles of a processed button event
+} GestureStats_t;
+
+/**
+ * @brief Initializes the gesture recognition with a mapping table
+ *
+ * @param pMapping      Pointer to the mapping table (must stay valid)
+ * @param mappingCount  Number of entries of the mapping table
+ * @param postEvent     Function to post the mapped events
+ *
+ * @return Returns GESTURE_ERR_OK if no error occured
+ */
+int32_t gestureInitialize(const GestureMapping_t* pMapping, uint32_t mappingCount, GesturePostEvent postEvent);
+
+/**
+ * @brief Reads all pending button events, recognizes the gestures and posts
+ * the mapped events. Intended for a cyclic task (the period only affects
+ * the timeouts of long press and click, the presses are timestamped)
+ */
+void gestureProcess();
+
+/**
+ * @brief Copies the runtime statistics of the gesture recognition
+ *
+ * @param pStats    Pointer to store the statistics
+ *
+ * @return Returns GESTURE_ERR_OK if no error occured
+ */
+int32_t gestureReadStats(GestureStats_t* pStats);
+
+#endif
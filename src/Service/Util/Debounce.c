@@ -3,6 +3,15 @@
  * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
  * @brief Implementation of the generic debouncer
  *
+ * Every input has a counter of DEBOUNCE_COUNTER_BITS bits, stored as bit
+ * planes over all inputs (vertical counter). A cycle increments the counters
+ * of all inputs which differ from their output and clears the others, so
+ * the counter holds the number of consecutive cycles with a new value. An
+ * output toggles when its counter reaches the press or release time
+ * selected by the current output. The whole cycle consists of logical
+ * operations on 32 bit words, there are no loops over the inputs and no
+ * divisions
+ *
  * @version 0.1
  * @date 2023-02-26
  *
@@ -12,89 +21,117 @@
 
 #include "Debounce.h"
 
-static int32_t debounceInternalDebounce(DebounceInstance_t* pDebounceInstance, DebounceInputValue_t pInput, DebounceOutputValue_t* pOutput);
-
-int32_t debounceInitialize(Debouncer_t* pDebouncer, DebounceInstance_t* pDebounceList, int16_t debounceCount, int16_t debounceMainCycle)
+int32_t debounceInitialize(Debouncer_t* pDebouncer, uint32_t cycleTime, uint32_t pressTime, uint32_t releaseTime, uint32_t invertMask)
 {
-    if (pDebouncer == 0 || pDebounceList == 0)
+    if (pDebouncer == 0)
         return DEBOUNCE_ERR_INVALID_PTR;
 
-    pDebouncer->pDebounceList       = pDebounceList;
-    pDebouncer->debouncerCount      = debounceCount;
-    pDebouncer->mainDebounceCycle   = debounceMainCycle;
+    if (cycleTime == 0)
+        return DEBOUNCE_ERR_INVALUD_PARAMETER;
+
+    pDebouncer->cycleTime       = cycleTime;
+    pDebouncer->invertMask      = invertMask;
+    pDebouncer->state           = 0;
+    pDebouncer->pressedMask     = 0;
+    pDebouncer->releasedMask    = 0;
 
-    for (int32_t i=0; i<debounceCount; i++)
+    for (int32_t i=0; i<DEBOUNCE_COUNTER_BITS; i++)
     {
-        pDebouncer->pDebounceList[i].debounceCycle  = pDebouncer->mainDebounceCycle;
+        pDebouncer->counter[i] = 0;
     }
 
-    return DEBOUNCE_ERR_OK;
+    return debounceConfigureInputs(pDebouncer, 0xFFFFFFFFUL, pressTime, releaseTime);
 }
 
-int32_t debounceCycle(Debouncer_t* pDebouncer, DebounceInputValue_t* pInputValues)
+int32_t debounceConfigureInputs(Debouncer_t* pDebouncer, uint32_t inputMask, uint32_t pressTime, uint32_t releaseTime)
 {
-    if (pDebouncer == 0 || pInputValues == 0)
+    if (pDebouncer == 0)
         return DEBOUNCE_ERR_INVALID_PTR;
 
-    for (int32_t i=0; i<pDebouncer->debouncerCount; i++)
+    // Times are rounded up to full cycles, at least one cycle
+    uint32_t pressCycles = (pressTime + pDebouncer->cycleTime - 1) / pDebouncer->cycleTime;
+    uint32_t releaseCycles = (releaseTime + pDebouncer->cycleTime - 1) / pDebouncer->cycleTime;
+
+    pressCycles     = (pressCycles == 0) ? 1 : pressCycles;
+    releaseCycles   = (releaseCycles == 0) ? 1 : releaseCycles;
+
+    if (pressCycles > DEBOUNCE_MAX_CYCLES || releaseCycles > DEBOUNCE_MAX_CYCLES)
+        return DEBOUNCE_ERR_INVALUD_PARAMETER;
+
+    for (int32_t i=0; i<DEBOUNCE_COUNTER_BITS; i++)
     {
-        DebounceInstance_t* pInstance = &(pDebouncer->pDebounceList[i]);
-        DebounceInputValue_t input = pInputValues[i];
-        DebounceOutputValue_t output = DEBOUNCE_OUTPUT_DEACTIVATE;
+        uint32_t pressPlane = ((pressCycles >> i) & 1) ? inputMask : 0;
+        uint32_t releasePlane = ((releaseCycles >> i) & 1) ? inputMask : 0;
 
-        debounceInternalDebounce(pInstance, input, &output);
+        pDebouncer->pressTime[i]    = (pDebouncer->pressTime[i] & ~inputMask) | pressPlane;
+        pDebouncer->releaseTime[i]  = (pDebouncer->releaseTime[i] & ~inputMask) | releasePlane;
     }
 
     return DEBOUNCE_ERR_OK;
 }
 
-int32_t debounceGetValue(Debouncer_t* pDebouncer, int32_t debounceID, DebounceOutputValue_t* pDebounceValue)
+uint32_t debounceCycle(Debouncer_t* pDebouncer, uint32_t inputs)
 {
-    if (pDebouncer == 0 || pDebounceValue == 0)
+    uint32_t state = pDebouncer->state;
+
+    // Inputs which differ from their output, all other counters restart
+    uint32_t changed = (inputs ^ pDebouncer->invertMask) ^ state;
+
+    // Increment (ripple carry over the bit planes) and compare with the time of the pending transition
+    uint32_t carry = changed;
+    uint32_t match = changed;
+
+    for (int32_t i=0; i<DEBOUNCE_COUNTER_BITS; i++)
+    {
+        uint32_t plane = pDebouncer->counter[i];
+        uint32_t next = (plane ^ carry) & changed;
+
+        carry &= plane;
+        pDebouncer->counter[i] = next;
+
+        // Time plane selected by the output: release time for active, press time for inactive outputs
+        uint32_t limit = (pDebouncer->releaseTime[i] & state) | (pDebouncer->pressTime[i] & ~state);
+        match &= ~(next ^ limit);
+    }
+
+    // Accepted transitions toggle their output and restart their counter
+    for (int32_t i=0; i<DEBOUNCE_COUNTER_BITS; i++)
+    {
+        pDebouncer->counter[i] &= ~match;
+    }
+
+    state ^= match;
+
+    pDebouncer->state           = state;
+    pDebouncer->pressedMask     = match & state;
+    pDebouncer->releasedMask    = match & ~state;
+
+    return state;
+}
+
+int32_t debounceGetEdges(Debouncer_t* pDebouncer, uint32_t* pPressedMask, uint32_t* pReleasedMask)
+{
+    if (pDebouncer == 0)
         return DEBOUNCE_ERR_INVALID_PTR;
 
+    if (pPressedMask != 0)
+        *pPressedMask = pDebouncer->pressedMask;
+
+    if (pReleasedMask != 0)
+        *pReleasedMask = pDebouncer->releasedMask;
+
     return DEBOUNCE_ERR_OK;
 }
 
-static int32_t debounceInternalDebounce(DebounceInstance_t* pDebounceInstance, DebounceInputValue_t input, DebounceOutputValue_t* pOutput)
+int32_t debounceGetValue(Debouncer_t* pDebouncer, int32_t debounceID, DebounceOutputValue_t* pDebounceValue)
 {
-    if (pDebounceInstance == 0)
+    if (pDebouncer == 0 || pDebounceValue == 0)
         return DEBOUNCE_ERR_INVALID_PTR;
 
-    if (pDebounceInstance->lastInputValue != input)
-    {
-        // Store the current input as last input
-        pDebounceInstance->lastInputValue = input;
-
-        // Depending on the input state, we calculate the counter value for release or press event
-        if (input == DEBOUNCE_INPUT_ACTIVATED)
-        {
-            pDebounceInstance->debounceCycleCount = pDebounceInstance->debouncePressTime / pDebounceInstance->debounceCycle;
-        }
-        else
-        {
-            pDebounceInstance->debounceCycleCount = pDebounceInstance->debounceReleaseTime / pDebounceInstance->debounceCycle;
-        }
-    }
-
-    // decrement the counter
-    pDebounceInstance->debounceCycleCount--;
+    if (debounceID < 0 || debounceID >= DEBOUNCE_MAX_INPUTS)
+        return DEBOUNCE_ERR_INVALUD_PARAMETER;
 
-    if (pDebounceInstance->debounceCycleCount <= 0)
-    {
-        if (input == DEBOUNCE_INPUT_ACTIVATED)
-        {
-            *pOutput = DEBOUNCE_OUTPUT_ACTIVATED;
-            pDebounceInstance->debounceCycleCount = pDebounceInstance->debouncePressTime / pDebounceInstance->debounceCycle;
-        }
-        else
-        {
-            *pOutput = DEBOUNCE_INPUT_DEACTIVATE;
-            pDebounceInstance->debounceCycleCount = pDebounceInstance->debounceReleaseTime / pDebounceInstance->debounceCycle;
-        }
-
-        pDebounceInstance->lastOutputValue = *pOutput;
-    }
+    *pDebounceValue = ((pDebouncer->state >> debounceID) & 1) ? DEBOUNCE_OUTPUT_ACTIVATED : DEBOUNCE_OUTPUT_DEACTIVATE;
 
     return DEBOUNCE_ERR_OK;
-}
\ No newline at end of file
+}
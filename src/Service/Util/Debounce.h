@@ -3,6 +3,11 @@
  * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
  * @brief Header file for a generic debouncing algorithm
  *
+ * Up to 32 digital inputs are debounced in parallel. The inputs are passed
+ * as bitmask (e.g. the packed IDR bits of the buttons), each bit has its own
+ * vertical counter, so a cycle takes a few logical operations independent
+ * of the number of inputs
+ *
  * @version 0.1
  * @date 2023-02-25
  *
@@ -21,22 +26,14 @@
 #define DEBOUNCE_ERR_INVALID_PTR        -1  //!< Invalid pointer
 #define DEBOUNCE_ERR_INVALUD_PARAMETER  -2  //!< Invalid parameter values
 
+#define DEBOUNCE_MAX_INPUTS             32  //!< Number of inputs of a debouncer (bits of the input mask)
+#define DEBOUNCE_COUNTER_BITS           4   //!< Number of bit planes of the vertical counters
+#define DEBOUNCE_MAX_CYCLES             ((1 << DEBOUNCE_COUNTER_BITS) - 1)  //!< Longest debounce time in cycles
+
 /*
  * Public Types
 */
 
-/**
- * @brief Enumeration for possible input values to the debouncer
- * These value must be mapped from the used inputs (e.g. for buttons)
- *
- */
-typedef enum _DebounceInputValue
-{
-    DEBOUNCE_INPUT_ACTIVATED,                        //!< Input status for "activated"
-    DEBOUNCE_INPUT_DEACTIVATE,                       //!< Input status for "deactivated"
-    DEBOUNCE_INPUT_UNKNOWN                           //!< Input status for "unknown"
-} DebounceInputValue_t;
-
 /**
  * @brief Enumeration for possible, already debounced output values
  *
@@ -48,33 +45,22 @@ typedef enum _DebounceOutputValue
 } DebounceOutputValue_t;
 
 /**
- * @brief Struct to define a single debounce instance for a
- * digital input.
- *
- */
-typedef struct _DebounceInstance
-{
-    int16_t debounceID;                             //!< ID for a debouncer (used to identify it in the list)
-    int16_t debouncePressTime;                      //!< Debounce time for "press event" in ms
-    int16_t debounceReleaseTime;                    //!< Debounce time for "release event" in ms
-
-    int16_t debounceCycle;                          //!< Cycle time for the debouncer in ms
-    int16_t debounceCycleCount;                     //!< Cycle counter for the debouncer
-
-    DebounceInputValue_t lastInputValue;            //!< Last input value fed into the debouncer
-    DebounceOutputValue_t lastOutputValue;          //!< Last output value provided by the debouncer
-} DebounceInstance_t;
-
-/**
- * @brief Struct which represents a kind of "debouncing manager" to handle
- * multiple debounce instances
+ * @brief Struct which represents a debouncer for up to 32 inputs
  *
+ * Bit n of every mask belongs to input n. The counters and the debounce
+ * times are stored as bit planes: bit n of counter[i] is bit i of the
+ * counter of input n (vertical counter)
  */
 typedef struct _Debouncer
 {
-    DebounceInstance_t* pDebounceList;              //!< Pointer to list of debounce instances
-    int16_t debouncerCount;                         //!< Number of debounce instances in the list
-    int16_t mainDebounceCycle;                      //!< Cycle time of the debounce manager
+    uint32_t cycleTime;                             //!< Cycle time of the debouncer in ms
+    uint32_t invertMask;                            //!< Inputs which are active low
+    uint32_t pressTime[DEBOUNCE_COUNTER_BITS];      //!< Cycles until an activation is accepted (bit planes)
+    uint32_t releaseTime[DEBOUNCE_COUNTER_BITS];    //!< Cycles until a deactivation is accepted (bit planes)
+    uint32_t counter[DEBOUNCE_COUNTER_BITS];        //!< Cycles since the input differs from the output (bit planes)
+    uint32_t state;                                 //!< Debounced output (1 = activated)
+    uint32_t pressedMask;                           //!< Inputs activated in the last cycle (rising edges)
+    uint32_t releasedMask;                          //!< Inputs deactivated in the last cycle (falling edges)
 } Debouncer_t;
 
 /*
@@ -82,43 +68,67 @@ typedef struct _Debouncer
 */
 
 /**
- * @brief Initializes the debouncer with the provided paramter
+ * @brief Initializes the debouncer with the provided paramter. All outputs
+ * start deactivated, all inputs use the same debounce times
  *
  * @param pDebouncer            Pointer to debounce manager
- * @param pDebounceList         Pointer to list of debounce instances
- * @param debounceCount         Number of debounc instances in the öist
- * @param debounceMainCycle     Cycle time of the debounce manager in ms
+ * @param cycleTime             Cycle time of the debouncer in ms (call interval of debounceCycle)
+ * @param pressTime             Debounce time for "press event" in ms
+ * @param releaseTime           Debounce time for "release event" in ms
+ * @param invertMask            Inputs which are active low (inverted before debouncing)
  *
  * @return Returns DEBOUNCE_ERR_OK if no error occured
  */
-int32_t debounceInitialize(Debouncer_t* pDebouncer, DebounceInstance_t* pDebounceList, int16_t debounceCount, int16_t debounceMainCycle);
+int32_t debounceInitialize(Debouncer_t* pDebouncer, uint32_t cycleTime, uint32_t pressTime, uint32_t releaseTime, uint32_t invertMask);
 
 /**
- * @brief Main cycle function for debouncer.
- * The provided inputs represents the values (mapped to activated/deactivated)
- * of the different signal inputs.
+ * @brief Changes the debounce times of a group of inputs
  *
- * @remark The size of the input value array and the order of the entries in+
- * the input array must match the array size and order of the debounce instance
- * list of the debouncer
+ * @remark The times are rounded up to full cycles and must not exceed
+ * DEBOUNCE_MAX_CYCLES cycles
+ *
+ * @param pDebouncer            Pointer to the debouncer
+ * @param inputMask             Inputs to configure
+ * @param pressTime             Debounce time for "press event" in ms
+ * @param releaseTime           Debounce time for "release event" in ms
+ *
+ * @return Returns DEBOUNCE_ERR_OK if no error occured
+ */
+int32_t debounceConfigureInputs(Debouncer_t* pDebouncer, uint32_t inputMask, uint32_t pressTime, uint32_t releaseTime);
+
+/**
+ * @brief Main cycle function for debouncer. An input changes its output
+ * after it had the new value for the configured number of consecutive
+ * cycles
  *
  * @param pDebouncer        Pointer to the debouncer
- * @param pInputValues      Poitner to the array of input values (same size as debounceCount)
+ * @param inputs            Raw input values as bitmask (bit n = input n)
  *
- * @return Returns DEBOUNCE_ERR_OK if no error occurred
+ * @return Returns the debounced outputs (bit n = 1 if input n is activated)
+ */
+uint32_t debounceCycle(Debouncer_t* pDebouncer, uint32_t inputs);
+
+/**
+ * @brief Returns the inputs which changed their debounced value in the
+ * last cycle
+ *
+ * @param pDebouncer        Pointer to the debouncer
+ * @param pPressedMask      Pointer to store the activated inputs (may be 0)
+ * @param pReleasedMask     Pointer to store the deactivated inputs (may be 0)
+ *
+ * @return Returns DEBOUNCE_ERR_OK if no error occured
  */
-int32_t debounceCycle(Debouncer_t* pDebouncer, DebounceInputValue_t* pInputValues);
+int32_t debounceGetEdges(Debouncer_t* pDebouncer, uint32_t* pPressedMask, uint32_t* pReleasedMask);
 
 /**
- * @brief Returns the current debounced value for a specific input specified
- * by the debounceID
+ * @brief Returns the current debounced value for a specific input
  *
  * @param pDebouncer        Poitner to the debouncer
- * @param debounceID        ID of the debouncer to return
+ * @param debounceID        Index of the input (bit number, 0..31)
  * @param pDebounceValue    Pointer to store the result of the output
  *
  * @return Returns DEBOUNCE_ERR_OK if no error occured
  */
 int32_t debounceGetValue(Debouncer_t* pDebouncer, int32_t debounceID, DebounceOutputValue_t* pDebounceValue);
 
-#endif
\ No newline at end of file
+#endif
@@ -111,6 +111,17 @@ void SystemInit (void)
     #endif /* DATA_IN_ExtSRAM */
     #endif
 
+    /* FPU settings (FPU=hard) ------------------------------------------------*/
+    #if (__FPU_PRESENT == 1) && (__FPU_USED == 1)
+        /* Full access to CP10 and CP11 */
+        SCB->CPACR |= ((3UL << 20U) | (3UL << 22U));
+        /* Automatic and lazy context stacking: an ISR only pays for the FPU
+           registers if it executes a floating point instruction itself */
+        FPU->FPCCR |= (FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk);
+        __DSB();
+        __ISB();
+    #endif
+
     /* Configure the system clock */
     //SystemClock_Config();
 
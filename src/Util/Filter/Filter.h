@@ -23,6 +23,11 @@
 #define FILTER_ERR_INVALID_PTR          -2      //!< Invalid pointer (Null Pointer)
 #define FILTER_ERR_INVALID_PARAM        -3      //!< Invalid parameter value
 
+#define FILTER_MEDIAN_MAX_WINDOW        31      //!< Maximum window size of the median filter
+
+#define FILTER_EMAQ_FRACTION_BITS       16      //!< Number of fraction bits of the Q EMA accumulator
+#define FILTER_EMAQ_MAX_SHIFT           15      //!< Maximum alpha shift of the Q EMA (alpha = 2^-15)
+
 /*
  * Public Types
 */
@@ -55,4 +60,426 @@ int32_t filterResetEMA(EMAFilterData_t* pEMA);
 
 int32_t filterEMA(EMAFilterData_t* pEMA, int32_t sensorValue);
 
-#endif
\ No newline at end of file
+/**
+ * @brief Struct which represents a division free EMA filter with a power of
+ * two alpha (alpha = 2^-alphaShift) and a Q format accumulator
+ *
+ */
+typedef struct _EMAQFilterData
+{
+    bool firstValueAvailable;                   //!< Flag to indicate whether the accumulator holds a value
+    uint32_t alphaShift;                        //!< Alpha as shift value (0 = no filtering)
+    int64_t accumulator;                        //!< Filter output with FILTER_EMAQ_FRACTION_BITS fraction bits
+} EMAQFilterData_t;
+
+/**
+ * @brief Initialize a Q EMA filter with the provided alpha
+ *
+ * @param pEMA              Pointer to the EMA filter struct
+ * @param alphaShift        Alpha as shift value (0..FILTER_EMAQ_MAX_SHIFT)
+ * @param resetFilter       Flag to indicate whether the filter should be reset
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitEMAQ(EMAQFilterData_t* pEMA, uint32_t alphaShift, bool resetFilter);
+
+int32_t filterResetEMAQ(EMAQFilterData_t* pEMA);
+
+/**
+ * @brief Filters a new sample (the full int32_t input range is allowed)
+ *
+ * @param pEMA              Pointer to the EMA filter struct
+ * @param sensorValue       New sample
+ *
+ * @return Returns the filter output rounded to the resolution of the input
+ */
+int32_t filterEMAQ(EMAQFilterData_t* pEMA, int32_t sensorValue);
+
+/**
+ * @brief Struct which represents a sliding window median filter
+ *
+ * The window is stored as two heaps around the median (max heap of the lower
+ * half, min heap of the upper half), so an update only needs O(log N)
+ * compare/exchange steps. All memory is part of the struct
+ */
+typedef struct _MedianFilterData
+{
+    uint32_t windowSize;                                //!< Number of samples in the window (odd window sizes give a true median)
+    uint32_t count;                                     //!< Number of samples currently in the window
+    uint32_t index;                                     //!< Ring buffer index of the oldest sample (next to be replaced)
+    int32_t data[FILTER_MEDIAN_MAX_WINDOW];             //!< Ring buffer of the samples
+    int8_t position[FILTER_MEDIAN_MAX_WINDOW];          //!< Heap position of each sample (< 0 max heap, 0 median, > 0 min heap)
+    uint8_t heapBuffer[FILTER_MEDIAN_MAX_WINDOW];       //!< Heap storage (sample indices), addressed relative to the center
+} MedianFilterData_t;
+
+/**
+ * @brief Struct which represents a Hampel style outlier rejector
+ *
+ * A sample is an outlier if its deviation from the window median is larger
+ * than thresholdQ3 / 8 times the running mean absolute deviation (and larger
+ * than minDeviation). Outliers are replaced by the median
+ */
+typedef struct _HampelFilterData
+{
+    MedianFilterData_t median;                  //!< Median of the window
+    int32_t thresholdQ3;                        //!< Threshold factor (Q3, e.g. 40 = 5.0)
+    int32_t minDeviation;                       //!< Deviations up to this value are never rejected (noise floor)
+    int32_t scaleQ4;                            //!< Running mean absolute deviation from the median (Q4)
+    uint32_t outlierCount;                      //!< Number of rejected samples
+} HampelFilterData_t;
+
+/**
+ * @brief Initialize a median filter with the provided window size and clear its window
+ *
+ * @param pMedian       Pointer to the median filter struct
+ * @param windowSize    Number of samples in the window (1..FILTER_MEDIAN_MAX_WINDOW)
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitMedian(MedianFilterData_t* pMedian, uint32_t windowSize);
+
+/**
+ * @brief Adds a sample to the window of the median filter (replacing the
+ * oldest one) and returns the median of the window
+ *
+ * @param pMedian       Pointer to the median filter struct
+ * @param sensorValue   New sample
+ *
+ * @return Returns the median (mean of both middle samples for an even count)
+ */
+int32_t filterMedian(MedianFilterData_t* pMedian, int32_t sensorValue);
+
+/**
+ * @brief Initialize a Hampel outlier rejector
+ *
+ * @param pHampel       Pointer to the Hampel filter struct
+ * @param windowSize    Number of samples in the median window (1..FILTER_MEDIAN_MAX_WINDOW)
+ * @param thresholdQ3   Threshold factor relative to the mean absolute deviation (Q3)
+ * @param minDeviation  Deviations up to this value are never rejected
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitHampel(HampelFilterData_t* pHampel, uint32_t windowSize, int32_t thresholdQ3, int32_t minDeviation);
+
+/**
+ * @brief Checks a sample against the Hampel criterion
+ *
+ * @param pHampel       Pointer to the Hampel filter struct
+ * @param sensorValue   New sample
+ *
+ * @return Returns the sample or the window median if the sample is an outlier
+ */
+int32_t filterHampel(HampelFilterData_t* pHampel, int32_t sensorValue);
+
+/**
+ * @brief Struct which represents a steady state Kalman filter (alpha-beta
+ * filter) with the states position and velocity, which fuses two redundant
+ * measurements of the same position
+ *
+ * Both measurements are assumed to have the same noise, so the optimal
+ * update uses their mean with half the noise variance. The gains are the
+ * precomputed steady state Kalman gains for the sample period
+ */
+typedef struct _KalmanFilterData
+{
+    bool firstValueAvailable;                   //!< Flag to indicate whether the state is initialized
+    int32_t alphaQ15;                           //!< Position gain (Q15)
+    int32_t betaQ16;                            //!< Velocity gain divided by the sample period in 1/s (Q16)
+    uint32_t periodQ32;                         //!< Sample period in s (Q32)
+    int32_t positionQ8;                         //!< Estimated position (Q8)
+    int32_t velocityQ8;                         //!< Estimated velocity in units per second (Q8)
+    int32_t innovation[2];                      //!< Residual of both measurements against the prediction of the last update
+} KalmanFilterData_t;
+
+/**
+ * @brief Initialize a Kalman filter with the provided gains and sample period
+ *
+ * @param pKalman           Pointer to the Kalman filter struct
+ * @param alphaQ15          Position gain (Q15, 0..32768)
+ * @param betaQ16           Velocity gain divided by the sample period in 1/s (Q16)
+ * @param periodUs          Sample period in µs
+ * @param resetFilter       Flag to indicate whether the filter should be reset
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitKalman(KalmanFilterData_t* pKalman, int32_t alphaQ15, int32_t betaQ16, uint32_t periodUs, bool resetFilter);
+
+int32_t filterResetKalman(KalmanFilterData_t* pKalman);
+
+/**
+ * @brief Performs the prediction and the update with two new measurements
+ *
+ * @param pKalman           Pointer to the Kalman filter struct
+ * @param measurement1      New value of the first sensor
+ * @param measurement2      New value of the second sensor
+ *
+ * @return Returns the estimated position
+ */
+int32_t filterKalman(KalmanFilterData_t* pKalman, int32_t measurement1, int32_t measurement2);
+
+/**
+ * @brief Returns the estimated velocity of the last update
+ *
+ * @param pKalman           Pointer to the Kalman filter struct
+ *
+ * @return Returns the velocity in units (of the measurements) per second
+ */
+int32_t filterKalmanVelocity(KalmanFilterData_t* pKalman);
+
+/**
+ * @brief Struct which represents a cascade of biquad filters in Direct Form I
+ * with Q15 data and coefficients
+ *
+ * Each stage uses 6 coefficients {b0, 0, b1, b2, a1, a2} (the 0 keeps the
+ * pairs word aligned) and 4 state values {x[n-1], x[n-2], y[n-1], y[n-2]}:
+ * y[n] = (b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]) << postShift
+ *
+ * @remark The feedback coefficients are the negated a1/a2 of the usual
+ * transfer function notation. Coefficients >= 1.0 are scaled down by
+ * 2^postShift
+ */
+typedef struct _BiquadQ15Data
+{
+    uint32_t stageCount;                        //!< Number of 2nd order stages
+    const int16_t* pCoeffs;                     //!< Coefficients (6 * stageCount)
+    int16_t* pState;                            //!< State buffer (4 * stageCount)
+    int32_t postShift;                          //!< Shift applied to the output of each stage (0..2)
+} BiquadQ15Data_t;
+
+/**
+ * @brief Struct which represents a cascade of biquad filters in Direct Form II
+ * transposed with Q31 data and coefficients
+ *
+ * Each stage uses 5 coefficients {b0, b1, b2, a1, a2} and 2 state values
+ * {d1, d2}, which are kept with 64 bit precision:
+ * y[n] = b0 x[n] + d1, d1 = b1 x[n] + a1 y[n] + d2, d2 = b2 x[n] + a2 y[n]
+ *
+ * @remark The feedback coefficients are the negated a1/a2 of the usual
+ * transfer function notation. Coefficients >= 1.0 are scaled down by
+ * 2^postShift
+ */
+typedef struct _BiquadQ31Data
+{
+    uint32_t stageCount;                        //!< Number of 2nd order stages
+    const int32_t* pCoeffs;                     //!< Coefficients (5 * stageCount)
+    int64_t* pState;                            //!< State buffer (2 * stageCount)
+    int32_t postShift;                          //!< Shift applied to the output of each stage (0..2)
+} BiquadQ31Data_t;
+
+/**
+ * @brief Struct which represents a FIR filter with Q15 data and coefficients
+ *
+ * The state buffer holds the last tapCount - 1 samples followed by the
+ * current block, so it needs tapCount + maxBlockSize - 1 elements
+ */
+typedef struct _FIRQ15Data
+{
+    uint32_t tapCount;                          //!< Number of filter taps
+    const int16_t* pCoeffs;                     //!< Coefficients h[0] .. h[tapCount - 1]
+    int16_t* pState;                            //!< State buffer (tapCount + maxBlockSize - 1)
+    uint32_t maxBlockSize;                      //!< Maximum number of samples per call
+} FIRQ15Data_t;
+
+/**
+ * @brief Initialize a Q15 biquad cascade (Direct Form I) and clear its state
+ *
+ * @param pBiquad       Pointer to the biquad cascade struct
+ * @param stageCount    Number of 2nd order stages
+ * @param pCoeffs       Pointer to the coefficients (6 per stage, must stay valid)
+ * @param pState        Pointer to the state buffer (4 per stage)
+ * @param postShift     Shift applied to the output of each stage (0..2)
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitBiquadQ15(BiquadQ15Data_t* pBiquad, uint32_t stageCount, const int16_t* pCoeffs, int16_t* pState, int32_t postShift);
+
+/**
+ * @brief Filters a block of samples with a Q15 biquad cascade
+ *
+ * @param pBiquad       Pointer to the biquad cascade struct
+ * @param pSrc          Pointer to the input samples
+ * @param pDst          Pointer to the output samples (may be equal to pSrc)
+ * @param blockSize     Number of samples
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterBiquadQ15(BiquadQ15Data_t* pBiquad, const int16_t* pSrc, int16_t* pDst, uint32_t blockSize);
+
+/**
+ * @brief Initialize a Q31 biquad cascade (Direct Form II transposed) and clear its state
+ *
+ * @param pBiquad       Pointer to the biquad cascade struct
+ * @param stageCount    Number of 2nd order stages
+ * @param pCoeffs       Pointer to the coefficients (5 per stage, must stay valid)
+ * @param pState        Pointer to the state buffer (2 per stage)
+ * @param postShift     Shift applied to the output of each stage (0..2)
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitBiquadQ31(BiquadQ31Data_t* pBiquad, uint32_t stageCount, const int32_t* pCoeffs, int64_t* pState, int32_t postShift);
+
+/**
+ * @brief Filters a block of samples with a Q31 biquad cascade
+ *
+ * @param pBiquad       Pointer to the biquad cascade struct
+ * @param pSrc          Pointer to the input samples
+ * @param pDst          Pointer to the output samples (may be equal to pSrc)
+ * @param blockSize     Number of samples
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterBiquadQ31(BiquadQ31Data_t* pBiquad, const int32_t* pSrc, int32_t* pDst, uint32_t blockSize);
+
+/**
+ * @brief Initialize a Q15 FIR filter and clear its state
+ *
+ * @param pFIR          Pointer to the FIR filter struct
+ * @param tapCount      Number of filter taps
+ * @param pCoeffs       Pointer to the coefficients (must stay valid)
+ * @param pState        Pointer to the state buffer (tapCount + maxBlockSize - 1)
+ * @param maxBlockSize  Maximum number of samples per call
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitFIRQ15(FIRQ15Data_t* pFIR, uint32_t tapCount, const int16_t* pCoeffs, int16_t* pState, uint32_t maxBlockSize);
+
+/**
+ * @brief Filters a block of samples with a Q15 FIR filter
+ *
+ * @remark The products are accumulated with 32 bit, so the sum of the
+ * absolute coefficient values must be below 2.0
+ *
+ * @param pFIR          Pointer to the FIR filter struct
+ * @param pSrc          Pointer to the input samples
+ * @param pDst          Pointer to the output samples (may be equal to pSrc)
+ * @param blockSize     Number of samples (<= maxBlockSize)
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterFIRQ15(FIRQ15Data_t* pFIR, const int16_t* pSrc, int16_t* pDst, uint32_t blockSize);
+
+/**
+ * @brief Struct which represents a bank of EMA filters with Q15 data, which
+ * are updated together (one sample per channel)
+ *
+ * The outputs of all channels are stored as one array (structure of arrays),
+ * so two channels are processed per 32 bit word with packed 16 bit SIMD
+ * operations. All channels use the same alpha
+ *
+ * @remark The state has no extra fraction bits, so the output may stay up
+ * to 1 / (2 * alpha) LSB away from a constant input. 12 bit ADC data should
+ * be scaled to the Q15 range (<< 3) to keep this below one digit
+ */
+typedef struct _EMABatchQ15Data
+{
+    uint32_t channelCount;                      //!< Number of channels
+    int16_t alphaQ15;                           //!< Alpha value (Q15, 1..32767)
+    int16_t* pState;                            //!< Filter outputs of all channels (channelCount)
+} EMABatchQ15Data_t;
+
+/**
+ * @brief Initialize a bank of Q15 EMA filters
+ *
+ * @param pBatch        Pointer to the EMA bank struct
+ * @param channelCount  Number of channels
+ * @param alphaQ15      Alpha value (Q15, 1..32767)
+ * @param pState        Pointer to the state buffer (channelCount)
+ * @param pInitial      Pointer to the initial values of the channels (channelCount), 0 to start at zero
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitEMABatchQ15(EMABatchQ15Data_t* pBatch, uint32_t channelCount, int16_t alphaQ15, int16_t* pState, const int16_t* pInitial);
+
+/**
+ * @brief Updates all channels of a bank of Q15 EMA filters with a new sample
+ *
+ * @remark The difference between input and output must not exceed the Q15
+ * range (e.g. only non-negative data), otherwise it is saturated
+ *
+ * @param pBatch        Pointer to the EMA bank struct
+ * @param pSrc          Pointer to the new samples of all channels (channelCount)
+ * @param pDst          Pointer to store the outputs of all channels (channelCount), may be 0
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterEMABatchQ15(EMABatchQ15Data_t* pBatch, const int16_t* pSrc, int16_t* pDst);
+
+/**
+ * @brief Struct which represents a single precision EMA filter (variant of
+ * the Q EMA for builds with hardware FPU, FPU=hard)
+ *
+ */
+typedef struct _EMAFFilterData
+{
+    bool firstValueAvailable;                   //!< Flag to indicate whether the state holds a value
+    float alpha;                                //!< Alpha value (0.0..1.0)
+    float value;                                //!< Filter output
+} EMAFFilterData_t;
+
+/**
+ * @brief Initialize a single precision EMA filter with the provided alpha
+ *
+ * @param pEMA              Pointer to the EMA filter struct
+ * @param alpha             Alpha value (0.0..1.0)
+ * @param resetFilter       Flag to indicate whether the filter should be reset
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitEMAF(EMAFFilterData_t* pEMA, float alpha, bool resetFilter);
+
+int32_t filterResetEMAF(EMAFFilterData_t* pEMA);
+
+/**
+ * @brief Filters a new sample
+ *
+ * @param pEMA              Pointer to the EMA filter struct
+ * @param sensorValue       New sample
+ *
+ * @return Returns the filter output
+ */
+float filterEMAF(EMAFFilterData_t* pEMA, float sensorValue);
+
+/**
+ * @brief Struct which represents a single precision steady state Kalman
+ * filter (variant of KalmanFilterData_t for builds with hardware FPU)
+ *
+ */
+typedef struct _KalmanFFilterData
+{
+    bool firstValueAvailable;                   //!< Flag to indicate whether the state is initialized
+    float alpha;                                //!< Position gain (0.0..1.0)
+    float beta;                                 //!< Velocity gain divided by the sample period in 1/s
+    float period;                               //!< Sample period in s
+    float position;                             //!< Estimated position
+    float velocity;                             //!< Estimated velocity in units per second
+    float innovation[2];                        //!< Residual of both measurements against the prediction of the last update
+} KalmanFFilterData_t;
+
+/**
+ * @brief Initialize a single precision Kalman filter with the provided
+ * gains and sample period
+ *
+ * @param pKalman           Pointer to the Kalman filter struct
+ * @param alpha             Position gain (0.0..1.0)
+ * @param beta              Velocity gain divided by the sample period in 1/s
+ * @param period            Sample period in s (0.0..1.0)
+ * @param resetFilter       Flag to indicate whether the filter should be reset
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitKalmanF(KalmanFFilterData_t* pKalman, float alpha, float beta, float period, bool resetFilter);
+
+int32_t filterResetKalmanF(KalmanFFilterData_t* pKalman);
+
+/**
+ * @brief Performs the prediction and the update with two new measurements
+ *
+ * @param pKalman           Pointer to the Kalman filter struct
+ * @param measurement1      New value of the first sensor
+ * @param measurement2      New value of the second sensor
+ *
+ * @return Returns the estimated position
+ */
+float filterKalmanF(KalmanFFilterData_t* pKalman, float measurement1, float measurement2);
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * @file FilterBiquad.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of fixed-point biquad cascades (Direct Form I with
+ * Q15 data, Direct Form II transposed with Q31 data)
+ *
+ * Both filters process a block of samples per stage, so the coefficients
+ * and the state of a stage stay in registers for the whole block
+ *
+ * @version 0.1
+ * @date 2023-03-10
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <string.h>
+
+#include "Util/Filter/Filter.h"
+#include "Util/Filter/FilterDSP.h"
+
+/*
+ * Private Defines
+*/
+#define BIQUAD_Q15_COEFFS       6           //!< Number of coefficients per Q15 stage {b0, 0, b1, b2, a1, a2}
+#define BIQUAD_Q15_STATES       4           //!< Number of state values per Q15 stage {x[n-1], x[n-2], y[n-1], y[n-2]}
+#define BIQUAD_Q31_COEFFS       5           //!< Number of coefficients per Q31 stage {b0, b1, b2, a1, a2}
+#define BIQUAD_Q31_STATES       2           //!< Number of state values per Q31 stage {d1, d2}
+#define BIQUAD_MAX_POST_SHIFT   2           //!< Maximum post shift (coefficients up to 4.0)
+#define BIQUAD_Q31_GUARD_BITS   2           //!< Guard bits of the Q31 state, so three Q62 products can be summed up
+
+int32_t filterInitBiquadQ15(BiquadQ15Data_t* pBiquad, uint32_t stageCount, const int16_t* pCoeffs, int16_t* pState, int32_t postShift)
+{
+    if (pBiquad == 0 || pCoeffs == 0 || pState == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    if (stageCount == 0 || postShift < 0 || postShift > BIQUAD_MAX_POST_SHIFT)
+    {
+        return FILTER_ERR_INVALID_PARAM;
+    }
+
+    pBiquad->stageCount = stageCount;
+    pBiquad->pCoeffs    = pCoeffs;
+    pBiquad->pState     = pState;
+    pBiquad->postShift  = postShift;
+
+    memset(pState, 0, stageCount * BIQUAD_Q15_STATES * sizeof(int16_t));
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterBiquadQ15(BiquadQ15Data_t* pBiquad, const int16_t* pSrc, int16_t* pDst, uint32_t blockSize)
+{
+    if (pBiquad == 0 || pSrc == 0 || pDst == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    const int32_t outputShift = 15 - pBiquad->postShift;
+    const int64_t rounding = 1LL << (outputShift - 1);
+
+    for (uint32_t stage=0; stage<pBiquad->stageCount; stage++)
+    {
+        const int16_t* pCoeffs = &pBiquad->pCoeffs[stage * BIQUAD_Q15_COEFFS];
+        int16_t* pState = &pBiquad->pState[stage * BIQUAD_Q15_STATES];
+
+        int16_t b0 = pCoeffs[0];
+        uint32_t b12 = filterRead2Q15(&pCoeffs[2]);         // b1 (low), b2 (high)
+        uint32_t a12 = filterRead2Q15(&pCoeffs[4]);         // a1 (low), a2 (high)
+        uint32_t x12 = filterRead2Q15(&pState[0]);          // x[n-1] (low), x[n-2] (high)
+        uint32_t y12 = filterRead2Q15(&pState[2]);          // y[n-1] (low), y[n-2] (high)
+
+        for (uint32_t n=0; n<blockSize; n++)
+        {
+            int16_t x0 = pSrc[n];
+
+            int64_t acc = (int32_t)b0 * x0;
+            acc = filterSMLALD(b12, x12, acc);
+            acc = filterSMLALD(a12, y12, acc);
+
+            int16_t y0 = filterSatQ15((int32_t)((acc + rounding) >> outputShift));
+
+            // Shift the delay lines (PKHBT on the M4)
+            x12 = (x12 << 16) | (uint16_t)x0;
+            y12 = (y12 << 16) | (uint16_t)y0;
+
+            pDst[n] = y0;
+        }
+
+        memcpy(&pState[0], &x12, sizeof(x12));
+        memcpy(&pState[2], &y12, sizeof(y12));
+
+        // The following stages work in place on the output
+        pSrc = pDst;
+    }
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterInitBiquadQ31(BiquadQ31Data_t* pBiquad, uint32_t stageCount, const int32_t* pCoeffs, int64_t* pState, int32_t postShift)
+{
+    if (pBiquad == 0 || pCoeffs == 0 || pState == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    if (stageCount == 0 || postShift < 0 || postShift > BIQUAD_MAX_POST_SHIFT)
+    {
+        return FILTER_ERR_INVALID_PARAM;
+    }
+
+    pBiquad->stageCount = stageCount;
+    pBiquad->pCoeffs    = pCoeffs;
+    pBiquad->pState     = pState;
+    pBiquad->postShift  = postShift;
+
+    memset(pState, 0, stageCount * BIQUAD_Q31_STATES * sizeof(int64_t));
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterBiquadQ31(BiquadQ31Data_t* pBiquad, const int32_t* pSrc, int32_t* pDst, uint32_t blockSize)
+{
+    if (pBiquad == 0 || pSrc == 0 || pDst == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    const int32_t outputShift = 31 - BIQUAD_Q31_GUARD_BITS - pBiquad->postShift;
+
+    for (uint32_t stage=0; stage<pBiquad->stageCount; stage++)
+    {
+        const int32_t* pCoeffs = &pBiquad->pCoeffs[stage * BIQUAD_Q31_COEFFS];
+        int64_t* pState = &pBiquad->pState[stage * BIQUAD_Q31_STATES];
+
+        int32_t b0 = pCoeffs[0];
+        int32_t b1 = pCoeffs[1];
+        int32_t b2 = pCoeffs[2];
+        int32_t a1 = pCoeffs[3];
+        int32_t a2 = pCoeffs[4];
+        int64_t d1 = pState[0];
+        int64_t d2 = pState[1];
+
+        for (uint32_t n=0; n<blockSize; n++)
+        {
+            int32_t x0 = pSrc[n];
+
+            // 32 x 32 => 64 bit multiplications (SMULL/SMLAL on the M4)
+            int64_t acc = (((int64_t)b0 * x0) >> BIQUAD_Q31_GUARD_BITS) + d1;
+            int32_t y0 = filterSatQ31(acc >> outputShift);
+
+            d1 = (((int64_t)b1 * x0) >> BIQUAD_Q31_GUARD_BITS) + (((int64_t)a1 * y0) >> BIQUAD_Q31_GUARD_BITS) + d2;
+            d2 = (((int64_t)b2 * x0) >> BIQUAD_Q31_GUARD_BITS) + (((int64_t)a2 * y0) >> BIQUAD_Q31_GUARD_BITS);
+
+            pDst[n] = y0;
+        }
+
+        pState[0] = d1;
+        pState[1] = d2;
+
+        // The following stages work in place on the output
+        pSrc = pDst;
+    }
+
+    return FILTER_ERR_OK;
+}
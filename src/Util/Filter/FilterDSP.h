@@ -0,0 +1,164 @@
+/**
+ * @file FilterDSP.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Internal header of the Filter library which maps the Cortex-M4
+ * DSP instructions (SIMD add/subtract, multiply accumulate, packing and
+ * saturation) to inline
+ * functions. Without DSP extension (e.g. host builds) a portable C
+ * implementation with identical results is used
+ *
+ * @version 0.1
+ * @date 2023-03-10
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _FILTER_DSP_H_
+#define _FILTER_DSP_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "cmsis_compiler.h"
+#define FILTER_USE_DSP          1           //!< DSP instructions are available
+#endif
+
+/**
+ * @brief Reads two packed Q15 values (may be unaligned)
+ *
+ * @param p     Pointer to the first value (lower half word)
+ *
+ * @return Returns both values packed into one word
+ */
+static inline uint32_t filterRead2Q15(const int16_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Dual multiply with addition: acc + x.lo * y.lo + x.hi * y.hi
+ */
+static inline int32_t filterSMLAD(uint32_t x, uint32_t y, int32_t acc)
+{
+#ifdef FILTER_USE_DSP
+    return (int32_t)__SMLAD(x, y, (uint32_t)acc);
+#else
+    return acc + (int16_t)x * (int16_t)y + (int16_t)(x >> 16) * (int16_t)(y >> 16);
+#endif
+}
+
+/**
+ * @brief Dual multiply with exchange and addition: acc + x.lo * y.hi + x.hi * y.lo
+ */
+static inline int32_t filterSMLADX(uint32_t x, uint32_t y, int32_t acc)
+{
+#ifdef FILTER_USE_DSP
+    return (int32_t)__SMLADX(x, y, (uint32_t)acc);
+#else
+    return acc + (int16_t)x * (int16_t)(y >> 16) + (int16_t)(x >> 16) * (int16_t)y;
+#endif
+}
+
+/**
+ * @brief Dual multiply with 64 bit accumulation: acc + x.lo * y.lo + x.hi * y.hi
+ */
+static inline int64_t filterSMLALD(uint32_t x, uint32_t y, int64_t acc)
+{
+#ifdef FILTER_USE_DSP
+    return (int64_t)__SMLALD(x, y, (uint64_t)acc);
+#else
+    return acc + (int16_t)x * (int16_t)y + (int16_t)(x >> 16) * (int16_t)(y >> 16);
+#endif
+}
+
+/**
+ * @brief Saturates a value to the Q15 range
+ */
+static inline int16_t filterSatQ15(int32_t value)
+{
+#ifdef FILTER_USE_DSP
+    return (int16_t)__SSAT(value, 16);
+#else
+    return (int16_t)((value > INT16_MAX) ? INT16_MAX : ((value < INT16_MIN) ? INT16_MIN : value));
+#endif
+}
+
+/**
+ * @brief Dual 16 bit subtraction with saturation: {x.lo - y.lo, x.hi - y.hi}
+ */
+static inline uint32_t filterQSUB16(uint32_t x, uint32_t y)
+{
+#ifdef FILTER_USE_DSP
+    return __QSUB16(x, y);
+#else
+    uint16_t lo = (uint16_t)filterSatQ15((int16_t)x - (int16_t)y);
+    uint16_t hi = (uint16_t)filterSatQ15((int16_t)(x >> 16) - (int16_t)(y >> 16));
+    return ((uint32_t)hi << 16) | lo;
+#endif
+}
+
+/**
+ * @brief Dual 16 bit addition with saturation: {x.lo + y.lo, x.hi + y.hi}
+ */
+static inline uint32_t filterQADD16(uint32_t x, uint32_t y)
+{
+#ifdef FILTER_USE_DSP
+    return __QADD16(x, y);
+#else
+    uint16_t lo = (uint16_t)filterSatQ15((int16_t)x + (int16_t)y);
+    uint16_t hi = (uint16_t)filterSatQ15((int16_t)(x >> 16) + (int16_t)(y >> 16));
+    return ((uint32_t)hi << 16) | lo;
+#endif
+}
+
+/**
+ * @brief Multiply of the lower half words with addition: acc + x.lo * y.lo
+ */
+static inline int32_t filterSMLABB(uint32_t x, uint32_t y, int32_t acc)
+{
+#ifdef FILTER_USE_DSP
+    int32_t result;
+    __ASM ("smlabb %0, %1, %2, %3" : "=r" (result) : "r" (x), "r" (y), "r" (acc));
+    return result;
+#else
+    return acc + (int16_t)x * (int16_t)y;
+#endif
+}
+
+/**
+ * @brief Multiply of the upper half word of x and the lower half word of y
+ * with addition: acc + x.hi * y.lo
+ */
+static inline int32_t filterSMLATB(uint32_t x, uint32_t y, int32_t acc)
+{
+#ifdef FILTER_USE_DSP
+    int32_t result;
+    __ASM ("smlatb %0, %1, %2, %3" : "=r" (result) : "r" (x), "r" (y), "r" (acc));
+    return result;
+#else
+    return acc + (int16_t)(x >> 16) * (int16_t)y;
+#endif
+}
+
+/**
+ * @brief Packs the lower half word of x and the upper half word of
+ * (y << shift) into one word
+ */
+#ifdef FILTER_USE_DSP
+#define filterPKHBT(x, y, shift)    __PKHBT(x, y, shift)
+#else
+#define filterPKHBT(x, y, shift)    ((((uint32_t)(x)) & 0x0000FFFFUL) | ((((uint32_t)(y)) << (shift)) & 0xFFFF0000UL))
+#endif
+
+/**
+ * @brief Saturates a 64 bit value to the Q31 range
+ */
+static inline int32_t filterSatQ31(int64_t value)
+{
+    return (int32_t)((value > INT32_MAX) ? INT32_MAX : ((value < INT32_MIN) ? INT32_MIN : value));
+}
+
+#endif
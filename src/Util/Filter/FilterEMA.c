@@ -3,6 +3,11 @@
  * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
  * @brief Implementation of fixed-point EMA filter
  *
+ * The Q variant keeps the filter output in a 64 bit accumulator with
+ * FILTER_EMAQ_FRACTION_BITS fraction bits and a power of two alpha, so an
+ * update is one subtraction, one rounded shift and one addition. For any
+ * int32_t input the accumulator stays below 2^47 (no overflow possible)
+ *
  * @version 0.1
  * @date 2023-02-23
  *
@@ -58,10 +63,10 @@ int32_t filterEMA(EMAFilterData_t* pEMA, int32_t sensorValue)
 
 	if (pEMA->firstValueAvailable == true)
 	{
-        // Perform filtering (with scaling)
-		filteredValue = pEMA->previousValue * (pEMA->scalingFactor - pEMA->alpha) + sensorValue * pEMA->alpha;
+        // Perform filtering (with scaling, 64 bit to avoid an overflow for large inputs)
+		int64_t scaledValue = (int64_t)pEMA->previousValue * (pEMA->scalingFactor - pEMA->alpha) + (int64_t)sensorValue * pEMA->alpha;
         // Scale down the result
-		filteredValue = filteredValue / pEMA->scalingFactor;
+		filteredValue = (int32_t)(scaledValue / pEMA->scalingFactor);
 	}
 	else
 	{
@@ -72,4 +77,65 @@ int32_t filterEMA(EMAFilterData_t* pEMA, int32_t sensorValue)
 	pEMA->previousValue = filteredValue;
 
 	return filteredValue;
-}
\ No newline at end of file
+}
+
+int32_t filterInitEMAQ(EMAQFilterData_t* pEMA, uint32_t alphaShift, bool resetFilter)
+{
+    if (pEMA == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    if (alphaShift > FILTER_EMAQ_MAX_SHIFT)
+    {
+        return FILTER_ERR_INVALID_PARAM;
+    }
+
+    if (resetFilter == true)
+    {
+        filterResetEMAQ(pEMA);
+    }
+
+    pEMA->alphaShift = alphaShift;
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterResetEMAQ(EMAQFilterData_t* pEMA)
+{
+    if (pEMA == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    pEMA->accumulator           = 0;
+    pEMA->firstValueAvailable   = false;
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterEMAQ(EMAQFilterData_t* pEMA, int32_t sensorValue)
+{
+    int64_t input = (int64_t)sensorValue << FILTER_EMAQ_FRACTION_BITS;
+
+    if (pEMA->firstValueAvailable == true)
+    {
+        // acc += alpha * (input - acc), rounded to nearest (|difference| < 2^48)
+        int64_t difference = input - pEMA->accumulator;
+
+        if (pEMA->alphaShift > 0)
+        {
+            difference = (difference + (1LL << (pEMA->alphaShift - 1))) >> pEMA->alphaShift;
+        }
+
+        pEMA->accumulator += difference;
+    }
+    else
+    {
+        pEMA->accumulator           = input;
+        pEMA->firstValueAvailable   = true;
+    }
+
+    // Round the accumulator to the output resolution (result is within the int32_t range of the inputs)
+    return (int32_t)((pEMA->accumulator + (1LL << (FILTER_EMAQ_FRACTION_BITS - 1))) >> FILTER_EMAQ_FRACTION_BITS);
+}
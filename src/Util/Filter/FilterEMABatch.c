@@ -0,0 +1,94 @@
+/**
+ * @file FilterEMABatch.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of a bank of fixed-point EMA filters with Q15 data
+ *
+ * Two channels are updated per 32 bit word:
+ *  d = x - y               (QSUB16, both channels)
+ *  y = y + alpha * d       (SMLABB/SMLATB with rounding, PKHBT, QADD16)
+ * An odd last channel is processed with the scalar operations
+ *
+ * @version 0.1
+ * @date 2023-03-14
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <string.h>
+
+#include "Util/Filter/Filter.h"
+#include "Util/Filter/FilterDSP.h"
+
+/*
+ * Private Defines
+*/
+#define EMA_BATCH_ROUND             (1 << 14)   //!< Rounding constant of the Q15 products
+
+int32_t filterInitEMABatchQ15(EMABatchQ15Data_t* pBatch, uint32_t channelCount, int16_t alphaQ15, int16_t* pState, const int16_t* pInitial)
+{
+    if (pBatch == 0 || pState == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    if (channelCount == 0 || alphaQ15 <= 0)
+    {
+        return FILTER_ERR_INVALID_PARAM;
+    }
+
+    pBatch->channelCount    = channelCount;
+    pBatch->alphaQ15        = alphaQ15;
+    pBatch->pState          = pState;
+
+    if (pInitial != 0)
+    {
+        memcpy(pState, pInitial, channelCount * sizeof(int16_t));
+    }
+    else
+    {
+        memset(pState, 0, channelCount * sizeof(int16_t));
+    }
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterEMABatchQ15(EMABatchQ15Data_t* pBatch, const int16_t* pSrc, int16_t* pDst)
+{
+    if (pBatch == 0 || pSrc == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    int16_t* pState = pBatch->pState;
+    const uint32_t alpha = (uint16_t)pBatch->alphaQ15;
+    uint32_t pairCount = pBatch->channelCount / 2;
+
+    for (uint32_t i=0; i<pairCount; i++)
+    {
+        uint32_t y = filterRead2Q15(pState);
+        uint32_t d = filterQSUB16(filterRead2Q15(pSrc), y);
+
+        // Both products are rounded, the upper one is shifted into place by PKHBT
+        int32_t stepLo = filterSMLABB(d, alpha, EMA_BATCH_ROUND) >> 15;
+        int32_t stepHi = filterSMLATB(d, alpha, EMA_BATCH_ROUND);
+        y = filterQADD16(y, filterPKHBT(stepLo, stepHi, 1));
+
+        memcpy(pState, &y, sizeof(y));
+
+        pState += 2;
+        pSrc += 2;
+    }
+
+    if (pBatch->channelCount & 1)
+    {
+        int32_t d = filterSatQ15(*pSrc - *pState);
+        *pState = filterSatQ15(*pState + ((d * pBatch->alphaQ15 + EMA_BATCH_ROUND) >> 15));
+    }
+
+    if (pDst != 0 && pDst != pBatch->pState)
+    {
+        memcpy(pDst, pBatch->pState, pBatch->channelCount * sizeof(int16_t));
+    }
+
+    return FILTER_ERR_OK;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file FilterFIR.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of a fixed-point FIR filter with Q15 data
+ *
+ * Two taps are processed per SMLADX instruction (dual 16 bit multiply
+ * accumulate with exchanged halves, because the delay line is stored in
+ * ascending time order while the coefficients are in ascending delay order)
+ *
+ * @version 0.1
+ * @date 2023-03-10
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <string.h>
+
+#include "Util/Filter/Filter.h"
+#include "Util/Filter/FilterDSP.h"
+
+int32_t filterInitFIRQ15(FIRQ15Data_t* pFIR, uint32_t tapCount, const int16_t* pCoeffs, int16_t* pState, uint32_t maxBlockSize)
+{
+    if (pFIR == 0 || pCoeffs == 0 || pState == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    if (tapCount == 0 || maxBlockSize == 0)
+    {
+        return FILTER_ERR_INVALID_PARAM;
+    }
+
+    pFIR->tapCount      = tapCount;
+    pFIR->pCoeffs       = pCoeffs;
+    pFIR->pState        = pState;
+    pFIR->maxBlockSize  = maxBlockSize;
+
+    memset(pState, 0, (tapCount + maxBlockSize - 1) * sizeof(int16_t));
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterFIRQ15(FIRQ15Data_t* pFIR, const int16_t* pSrc, int16_t* pDst, uint32_t blockSize)
+{
+    if (pFIR == 0 || pSrc == 0 || pDst == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    if (blockSize > pFIR->maxBlockSize)
+    {
+        return FILTER_ERR_INVALID_PARAM;
+    }
+
+    const uint32_t tapCount = pFIR->tapCount;
+    const int16_t* pCoeffs = pFIR->pCoeffs;
+    int16_t* pState = pFIR->pState;
+
+    // Append the new block to the history of tapCount - 1 samples
+    memcpy(&pState[tapCount - 1], pSrc, blockSize * sizeof(int16_t));
+
+    for (uint32_t n=0; n<blockSize; n++)
+    {
+        // pX[0] is x[n], pX[-k] is x[n-k]
+        const int16_t* pX = &pState[n + tapCount - 1];
+        int32_t acc = 0;
+        uint32_t k = 0;
+
+        // h[k] * x[n-k] + h[k+1] * x[n-k-1]
+        for (; k + 1 < tapCount; k += 2)
+        {
+            acc = filterSMLADX(filterRead2Q15(&pCoeffs[k]), filterRead2Q15(pX - k - 1), acc);
+        }
+
+        if (k < tapCount)
+        {
+            acc += (int32_t)pCoeffs[k] * pX[-(int32_t)k];
+        }
+
+        pDst[n] = filterSatQ15((acc + (1L << 14)) >> 15);
+    }
+
+    // Keep the last tapCount - 1 samples as history for the next block
+    memmove(pState, &pState[blockSize], (tapCount - 1) * sizeof(int16_t));
+
+    return FILTER_ERR_OK;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file FilterFloat.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of the single precision variants of the EMA and
+ * the steady state Kalman filter
+ *
+ * The filters use the same equations as their fixed-point counterparts and
+ * are intended for builds with hardware FPU (FPU=hard), where a float
+ * multiply-accumulate takes a single cycle. Without FPU they still work,
+ * but every operation is a call into the soft-float library
+ *
+ * @version 0.1
+ * @date 2023-03-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include "Util/Filter/Filter.h"
+
+int32_t filterInitEMAF(EMAFFilterData_t* pEMA, float alpha, bool resetFilter)
+{
+    if (pEMA == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    // Also rejects NaN
+    if (!(alpha >= 0.0f && alpha <= 1.0f))
+    {
+        return FILTER_ERR_INVALID_PARAM;
+    }
+
+    if (resetFilter == true)
+    {
+        filterResetEMAF(pEMA);
+    }
+
+    pEMA->alpha = alpha;
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterResetEMAF(EMAFFilterData_t* pEMA)
+{
+    if (pEMA == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    pEMA->firstValueAvailable   = false;
+    pEMA->value                 = 0.0f;
+
+    return FILTER_ERR_OK;
+}
+
+float filterEMAF(EMAFFilterData_t* pEMA, float sensorValue)
+{
+    if (pEMA->firstValueAvailable == false)
+    {
+        pEMA->value                 = sensorValue;
+        pEMA->firstValueAvailable   = true;
+    }
+    else
+    {
+        // y += alpha * (x - y), compiles to one VSUB and one VFMA
+        pEMA->value += pEMA->alpha * (sensorValue - pEMA->value);
+    }
+
+    return pEMA->value;
+}
+
+int32_t filterInitKalmanF(KalmanFFilterData_t* pKalman, float alpha, float beta, float period, bool resetFilter)
+{
+    if (pKalman == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    if (!(alpha >= 0.0f && alpha <= 1.0f) || !(beta >= 0.0f) || !(period > 0.0f && period < 1.0f))
+    {
+        return FILTER_ERR_INVALID_PARAM;
+    }
+
+    if (resetFilter == true)
+    {
+        filterResetKalmanF(pKalman);
+    }
+
+    // The state is kept on a change of the gains (the velocity is in units per second)
+    pKalman->alpha  = alpha;
+    pKalman->beta   = beta;
+    pKalman->period = period;
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterResetKalmanF(KalmanFFilterData_t* pKalman)
+{
+    if (pKalman == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    pKalman->firstValueAvailable    = false;
+    pKalman->position               = 0.0f;
+    pKalman->velocity               = 0.0f;
+    pKalman->innovation[0]          = 0.0f;
+    pKalman->innovation[1]          = 0.0f;
+
+    return FILTER_ERR_OK;
+}
+
+float filterKalmanF(KalmanFFilterData_t* pKalman, float measurement1, float measurement2)
+{
+    float measurement = 0.5f * (measurement1 + measurement2);
+
+    if (pKalman->firstValueAvailable == false)
+    {
+        pKalman->position               = measurement;
+        pKalman->velocity               = 0.0f;
+        pKalman->firstValueAvailable    = true;
+    }
+
+    // Prediction with constant velocity
+    float prediction = pKalman->position + pKalman->velocity * pKalman->period;
+    float residual = measurement - prediction;
+
+    pKalman->innovation[0] = measurement1 - prediction;
+    pKalman->innovation[1] = measurement2 - prediction;
+
+    // Update with the steady state gains
+    pKalman->position = prediction + pKalman->alpha * residual;
+    pKalman->velocity += pKalman->beta * residual;
+
+    return pKalman->position;
+}
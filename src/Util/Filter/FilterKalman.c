@@ -0,0 +1,97 @@
+/**
+ * @file FilterKalman.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of a fixed-point steady state Kalman filter
+ * (alpha-beta filter) fusing two position measurements
+ *
+ * With constant gains the covariance update is not needed, a step costs
+ * three multiplications and some additions:
+ *  prediction:  x' = x + v * T
+ *  innovation:  r  = (z1 + z2) / 2 - x'
+ *  update:      x  = x' + alpha * r,   v = v + beta / T * r
+ *
+ * @version 0.1
+ * @date 2023-03-13
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include "Util/Filter/Filter.h"
+
+/*
+ * Private Defines
+*/
+#define KALMAN_ALPHA_MAX            32768       //!< Alpha of 1.0 (Q15)
+
+int32_t filterInitKalman(KalmanFilterData_t* pKalman, int32_t alphaQ15, int32_t betaQ16, uint32_t periodUs, bool resetFilter)
+{
+    if (pKalman == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    if (alphaQ15 < 0 || alphaQ15 > KALMAN_ALPHA_MAX || betaQ16 < 0 || periodUs == 0 || periodUs >= 1000000UL)
+    {
+        return FILTER_ERR_INVALID_PARAM;
+    }
+
+    if (resetFilter == true)
+    {
+        filterResetKalman(pKalman);
+    }
+
+    // The state is kept on a change of the gains (the velocity is in units per second)
+    pKalman->alphaQ15   = alphaQ15;
+    pKalman->betaQ16    = betaQ16;
+    pKalman->periodQ32  = (uint32_t)(((uint64_t)periodUs << 32) / 1000000UL);
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterResetKalman(KalmanFilterData_t* pKalman)
+{
+    if (pKalman == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    pKalman->firstValueAvailable    = false;
+    pKalman->positionQ8             = 0;
+    pKalman->velocityQ8             = 0;
+    pKalman->innovation[0]          = 0;
+    pKalman->innovation[1]          = 0;
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterKalman(KalmanFilterData_t* pKalman, int32_t measurement1, int32_t measurement2)
+{
+    // Mean of both measurements (Q8)
+    int32_t measurementQ8 = (int32_t)(((int64_t)measurement1 + measurement2) << 7);
+
+    if (pKalman->firstValueAvailable == false)
+    {
+        pKalman->positionQ8             = measurementQ8;
+        pKalman->velocityQ8             = 0;
+        pKalman->firstValueAvailable    = true;
+    }
+
+    // Prediction with constant velocity
+    int32_t predictionQ8 = pKalman->positionQ8 + (int32_t)(((int64_t)pKalman->velocityQ8 * pKalman->periodQ32) >> 32);
+    int32_t residualQ8 = measurementQ8 - predictionQ8;
+
+    int32_t prediction = (predictionQ8 + (1 << 7)) >> 8;
+    pKalman->innovation[0] = measurement1 - prediction;
+    pKalman->innovation[1] = measurement2 - prediction;
+
+    // Update with the steady state gains
+    pKalman->positionQ8 = predictionQ8 + (int32_t)(((int64_t)pKalman->alphaQ15 * residualQ8 + (1 << 14)) >> 15);
+    pKalman->velocityQ8 += (int32_t)(((int64_t)pKalman->betaQ16 * residualQ8 + (1 << 15)) >> 16);
+
+    return (pKalman->positionQ8 + (1 << 7)) >> 8;
+}
+
+int32_t filterKalmanVelocity(KalmanFilterData_t* pKalman)
+{
+    return (pKalman->velocityQ8 + (1 << 7)) >> 8;
+}
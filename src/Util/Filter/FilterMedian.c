@@ -0,0 +1,287 @@
+/**
+ * @file FilterMedian.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of a sliding window median filter (double heap
+ * mediator) and a Hampel style outlier rejector based on it
+ *
+ * The heap storage is addressed relative to its center: index 0 is the
+ * median, negative indices form the max heap of the lower half (root -1),
+ * positive indices the min heap of the upper half (root 1). The children
+ * of index i are 2i and 2i+1 (2i and 2i-1 in the max heap)
+ *
+ * @version 0.1
+ * @date 2023-03-11
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include "Util/Filter/Filter.h"
+
+/*
+ * Private Defines
+*/
+#define MEDIAN_HEAP(pMedian, i)     ((pMedian)->heapBuffer[(int32_t)((pMedian)->windowSize / 2) + (i)])  //!< Heap element i (relative to the center)
+#define MEDIAN_VALUE(pMedian, i)    ((pMedian)->data[MEDIAN_HEAP(pMedian, i)])                          //!< Sample of heap element i
+#define MEDIAN_MIN_COUNT(pMedian)   ((int32_t)((pMedian)->count - 1) / 2)                               //!< Number of samples in the min heap
+#define MEDIAN_MAX_COUNT(pMedian)   ((int32_t)(pMedian)->count / 2)                                     //!< Number of samples in the max heap
+
+#define HAMPEL_SCALE_SHIFT          4       //!< Weight of a new deviation in the running mean absolute deviation (1/16)
+
+/*
+ * Private Module Functions
+*/
+static bool medianLess(MedianFilterData_t* pMedian, int32_t i, int32_t j);
+static bool medianExchangeIfLess(MedianFilterData_t* pMedian, int32_t i, int32_t j);
+static void medianMinSortDown(MedianFilterData_t* pMedian, int32_t i);
+static void medianMaxSortDown(MedianFilterData_t* pMedian, int32_t i);
+static bool medianMinSortUp(MedianFilterData_t* pMedian, int32_t i);
+static bool medianMaxSortUp(MedianFilterData_t* pMedian, int32_t i);
+
+int32_t filterInitMedian(MedianFilterData_t* pMedian, uint32_t windowSize)
+{
+    if (pMedian == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    if (windowSize == 0 || windowSize > FILTER_MEDIAN_MAX_WINDOW)
+    {
+        return FILTER_ERR_INVALID_PARAM;
+    }
+
+    pMedian->windowSize = windowSize;
+    pMedian->count      = 0;
+    pMedian->index      = 0;
+
+    // Initial fill pattern of the heaps: median, max, min, max, min, ...
+    for (int32_t k=(int32_t)windowSize-1; k>=0; k--)
+    {
+        int32_t position = ((k + 1) / 2) * ((k & 1) ? -1 : 1);
+
+        pMedian->data[k]            = 0;
+        pMedian->position[k]        = (int8_t)position;
+        MEDIAN_HEAP(pMedian, position) = (uint8_t)k;
+    }
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterMedian(MedianFilterData_t* pMedian, int32_t sensorValue)
+{
+    bool isNew = (pMedian->count < pMedian->windowSize);
+    int32_t position = pMedian->position[pMedian->index];
+    int32_t oldValue = pMedian->data[pMedian->index];
+
+    // Replace the oldest sample
+    pMedian->data[pMedian->index] = sensorValue;
+    pMedian->index = (pMedian->index + 1 < pMedian->windowSize) ? (pMedian->index + 1) : 0;
+
+    if (isNew)
+    {
+        pMedian->count++;
+    }
+
+    if (position > 0)
+    {
+        // Sample is in the min heap
+        if (!isNew && oldValue < sensorValue)
+        {
+            medianMinSortDown(pMedian, position * 2);
+        }
+        else if (medianMinSortUp(pMedian, position))
+        {
+            medianMaxSortDown(pMedian, -1);
+        }
+    }
+    else if (position < 0)
+    {
+        // Sample is in the max heap
+        if (!isNew && sensorValue < oldValue)
+        {
+            medianMaxSortDown(pMedian, position * 2);
+        }
+        else if (medianMaxSortUp(pMedian, position))
+        {
+            medianMinSortDown(pMedian, 1);
+        }
+    }
+    else
+    {
+        // Sample is the median
+        if (MEDIAN_MAX_COUNT(pMedian) > 0)
+        {
+            medianMaxSortDown(pMedian, -1);
+        }
+
+        if (MEDIAN_MIN_COUNT(pMedian) > 0)
+        {
+            medianMinSortDown(pMedian, 1);
+        }
+    }
+
+    int32_t median = MEDIAN_VALUE(pMedian, 0);
+
+    if ((pMedian->count & 1) == 0)
+    {
+        // Mean of both middle samples without overflow
+        int32_t lower = MEDIAN_VALUE(pMedian, -1);
+        median = lower + (median - lower) / 2;
+    }
+
+    return median;
+}
+
+int32_t filterInitHampel(HampelFilterData_t* pHampel, uint32_t windowSize, int32_t thresholdQ3, int32_t minDeviation)
+{
+    if (pHampel == 0)
+    {
+        return FILTER_ERR_INVALID_PTR;
+    }
+
+    if (thresholdQ3 <= 0 || minDeviation < 0)
+    {
+        return FILTER_ERR_INVALID_PARAM;
+    }
+
+    pHampel->thresholdQ3    = thresholdQ3;
+    pHampel->minDeviation   = minDeviation;
+    pHampel->scaleQ4        = 0;
+    pHampel->outlierCount   = 0;
+
+    return filterInitMedian(&pHampel->median, windowSize);
+}
+
+int32_t filterHampel(HampelFilterData_t* pHampel, int32_t sensorValue)
+{
+    int32_t median = filterMedian(&pHampel->median, sensorValue);
+
+    int32_t deviation = sensorValue - median;
+    if (deviation < 0)
+    {
+        deviation = -deviation;
+    }
+
+    int32_t threshold = (int32_t)(((int64_t)pHampel->scaleQ4 * pHampel->thresholdQ3) >> (HAMPEL_SCALE_SHIFT + 3));
+    if (threshold < pHampel->minDeviation)
+    {
+        threshold = pHampel->minDeviation;
+    }
+
+    // No decision until the window is filled (the median of a few samples is no reliable reference)
+    bool isOutlier = (pHampel->median.count == pHampel->median.windowSize) && (deviation > threshold);
+
+    // Outliers only contribute with the threshold, so a burst cannot inflate the scale
+    int32_t scaleInputQ4 = (isOutlier ? threshold : deviation) << HAMPEL_SCALE_SHIFT;
+    pHampel->scaleQ4 += (scaleInputQ4 - pHampel->scaleQ4) >> HAMPEL_SCALE_SHIFT;
+
+    if (isOutlier)
+    {
+        pHampel->outlierCount++;
+        return median;
+    }
+
+    return sensorValue;
+}
+
+/**
+ * @brief Compares the samples of two heap elements
+ *
+ * @return Returns true if the sample of element i is less than the one of element j
+ */
+static bool medianLess(MedianFilterData_t* pMedian, int32_t i, int32_t j)
+{
+    return MEDIAN_VALUE(pMedian, i) < MEDIAN_VALUE(pMedian, j);
+}
+
+/**
+ * @brief Exchanges two heap elements if the sample of element i is less
+ * than the one of element j and updates the positions of both samples
+ *
+ * @return Returns true if the elements were exchanged
+ */
+static bool medianExchangeIfLess(MedianFilterData_t* pMedian, int32_t i, int32_t j)
+{
+    if (!medianLess(pMedian, i, j))
+    {
+        return false;
+    }
+
+    uint8_t sample = MEDIAN_HEAP(pMedian, i);
+    MEDIAN_HEAP(pMedian, i) = MEDIAN_HEAP(pMedian, j);
+    MEDIAN_HEAP(pMedian, j) = sample;
+
+    pMedian->position[MEDIAN_HEAP(pMedian, i)] = (int8_t)i;
+    pMedian->position[MEDIAN_HEAP(pMedian, j)] = (int8_t)j;
+
+    return true;
+}
+
+/**
+ * @brief Restores the min heap property from element i downwards (element 1
+ * is compared with the median)
+ */
+static void medianMinSortDown(MedianFilterData_t* pMedian, int32_t i)
+{
+    for (; i<=MEDIAN_MIN_COUNT(pMedian); i*=2)
+    {
+        if (i > 1 && i < MEDIAN_MIN_COUNT(pMedian) && medianLess(pMedian, i + 1, i))
+        {
+            i++;
+        }
+
+        if (!medianExchangeIfLess(pMedian, i, i / 2))
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Restores the max heap property from element i downwards (negative
+ * indices, element -1 is compared with the median)
+ */
+static void medianMaxSortDown(MedianFilterData_t* pMedian, int32_t i)
+{
+    for (; i>=-MEDIAN_MAX_COUNT(pMedian); i*=2)
+    {
+        if (i < -1 && i > -MEDIAN_MAX_COUNT(pMedian) && medianLess(pMedian, i, i - 1))
+        {
+            i--;
+        }
+
+        if (!medianExchangeIfLess(pMedian, i / 2, i))
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Restores the min heap property above element i (including the median)
+ *
+ * @return Returns true if the sample moved up to the median
+ */
+static bool medianMinSortUp(MedianFilterData_t* pMedian, int32_t i)
+{
+    while (i > 0 && medianExchangeIfLess(pMedian, i, i / 2))
+    {
+        i /= 2;
+    }
+
+    return (i == 0);
+}
+
+/**
+ * @brief Restores the max heap property above element i (including the median)
+ *
+ * @return Returns true if the sample moved up to the median
+ */
+static bool medianMaxSortUp(MedianFilterData_t* pMedian, int32_t i)
+{
+    while (i < 0 && medianExchangeIfLess(pMedian, i / 2, i))
+    {
+        i /= 2;
+    }
+
+    return (i == 0);
+}
@@ -0,0 +1,179 @@
+/**
+ * @file FixedPoint.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Header file for the fixed-point math functions (Q16.16 and Q1.31
+ * types, saturating arithmetic and multiplication with the reciprocal of
+ * constant divisors)
+ *
+ * All products use 64 bit intermediates, results outside the int32_t range
+ * are saturated. On the Cortex-M4 the saturation uses the QADD/QSUB/SSAT
+ * instructions, other builds (e.g. host) use a C implementation with
+ * identical results
+ *
+ * @version 0.1
+ * @date 2023-03-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _FIXED_POINT_H_
+#define _FIXED_POINT_H_
+
+#include <stdint.h>
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "cmsis_compiler.h"
+#define FX_USE_DSP              1           //!< DSP instructions are available
+#endif
+
+/*
+ * Public Defines
+*/
+#define FX_Q16_SHIFT            16                      //!< Number of fraction bits of Q16.16
+#define FX_Q16_ONE              (1L << FX_Q16_SHIFT)    //!< 1.0 in Q16.16
+#define FX_Q31_SHIFT            31                      //!< Number of fraction bits of Q1.31
+#define FX_Q31_MAX              INT32_MAX               //!< Largest Q1.31 value (1.0 - 2^-31)
+
+//! Converts a constant (compile time) into Q16.16 (rounded)
+#define FX_Q16_CONST(x)         ((q16_16_t)(((x) >= 0) ? ((x) * 65536.0 + 0.5) : ((x) * 65536.0 - 0.5)))
+
+//! Converts a constant (compile time) in the range [-1, 1) into Q1.31 (rounded)
+#define FX_Q31_CONST(x)         ((q1_31_t)(((x) >= 0) ? ((x) * 2147483648.0 + 0.5) : ((x) * 2147483648.0 - 0.5)))
+
+/**
+ * @brief Reciprocal of a constant ratio num / den (0 <= num / den < 1) in
+ * Q0.32 (rounded), evaluated at compile time. Used with fxMulQ32 to replace
+ * a division by a constant with one multiplication
+ */
+#define FX_RECIPROCAL_Q32(num, den) ((uint32_t)((((uint64_t)(num) << 32) + ((uint64_t)(den) / 2)) / (uint64_t)(den)))
+
+/*
+ * Public Types
+*/
+typedef int32_t q16_16_t;               //!< Signed fixed-point value with 16 integer and 16 fraction bits
+typedef int32_t q1_31_t;                //!< Signed fixed-point value with 31 fraction bits (range [-1, 1))
+
+/*
+ * Public Functions
+*/
+
+/**
+ * @brief Saturates a 64 bit value to the int32_t range
+ */
+static inline int32_t fxSat32(int64_t value)
+{
+    return (int32_t)((value > INT32_MAX) ? INT32_MAX : ((value < INT32_MIN) ? INT32_MIN : value));
+}
+
+/**
+ * @brief Saturating addition a + b
+ */
+static inline int32_t fxSatAdd32(int32_t a, int32_t b)
+{
+#ifdef FX_USE_DSP
+    return __QADD(a, b);
+#else
+    return fxSat32((int64_t)a + b);
+#endif
+}
+
+/**
+ * @brief Saturating subtraction a - b
+ */
+static inline int32_t fxSatSub32(int32_t a, int32_t b)
+{
+#ifdef FX_USE_DSP
+    return __QSUB(a, b);
+#else
+    return fxSat32((int64_t)a - b);
+#endif
+}
+
+/**
+ * @brief Saturates a value to a signed range of the given bit width
+ * (1..32), the bit width must be a constant
+ */
+#ifdef FX_USE_DSP
+#define fxSatBits(value, bits)  __SSAT((value), (bits))
+#else
+#define fxSatBits(value, bits)  ((int32_t)fxSat32Bits((value), (bits)))
+#endif
+
+/**
+ * @brief C implementation of fxSatBits
+ */
+static inline int32_t fxSat32Bits(int32_t value, uint32_t bits)
+{
+    int32_t max = (int32_t)((1UL << (bits - 1)) - 1);
+    int32_t min = -max - 1;
+
+    return (value > max) ? max : ((value < min) ? min : value);
+}
+
+/**
+ * @brief Converts an integer into Q16.16 (saturated)
+ */
+static inline q16_16_t fxIntToQ16(int32_t value)
+{
+    return fxSat32((int64_t)value << FX_Q16_SHIFT);
+}
+
+/**
+ * @brief Converts a Q16.16 value into an integer (rounded to nearest)
+ */
+static inline int32_t fxQ16ToInt(q16_16_t value)
+{
+    return (int32_t)(((int64_t)value + (FX_Q16_ONE / 2)) >> FX_Q16_SHIFT);
+}
+
+/**
+ * @brief Saturating Q16.16 multiplication with rounding
+ */
+static inline q16_16_t fxMulQ16(q16_16_t a, q16_16_t b)
+{
+    return fxSat32(((int64_t)a * b + (FX_Q16_ONE / 2)) >> FX_Q16_SHIFT);
+}
+
+/**
+ * @brief Saturating Q16.16 division (rounded towards zero)
+ *
+ * @return Returns the saturated quotient (INT32_MAX/INT32_MIN for b = 0)
+ */
+static inline q16_16_t fxDivQ16(q16_16_t a, q16_16_t b)
+{
+    if (b == 0)
+    {
+        return (a >= 0) ? INT32_MAX : INT32_MIN;
+    }
+
+    return fxSat32(((int64_t)a << FX_Q16_SHIFT) / b);
+}
+
+/**
+ * @brief Saturating Q1.31 multiplication with rounding (-1.0 * -1.0 gives
+ * the largest value)
+ */
+static inline q1_31_t fxMulQ31(q1_31_t a, q1_31_t b)
+{
+    return fxSat32(((int64_t)a * b + (1LL << (FX_Q31_SHIFT - 1))) >> FX_Q31_SHIFT);
+}
+
+/**
+ * @brief Multiplies an integer with a Q1.31 factor (rounded and saturated)
+ */
+static inline int32_t fxScaleQ31(int32_t value, q1_31_t factor)
+{
+    return fxSat32(((int64_t)value * factor + (1LL << (FX_Q31_SHIFT - 1))) >> FX_Q31_SHIFT);
+}
+
+/**
+ * @brief Multiplies a value with a reciprocal of FX_RECIPROCAL_Q32, i.e.
+ * computes value * num / den rounded to nearest without a division (close
+ * to a tie the result may differ by one LSB). The result can't overflow
+ */
+static inline int32_t fxMulQ32(int32_t value, uint32_t reciprocal)
+{
+    return (int32_t)(((int64_t)value * reciprocal + (1LL << 31)) >> 32);
+}
+
+#endif
@@ -0,0 +1,117 @@
+/**
+ * @file Spectrum.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Header file for the Spectrum library (fixed-point real FFT with
+ * Hann window and Goertzel single bin detector, Q15 data)
+ *
+ * @version 0.1
+ * @date 2023-03-15
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _SPECTRUM_API_H_
+#define _SPECTRUM_API_H_
+
+#include <stdint.h>
+
+/*
+ * Public Defines
+*/
+#define SPECTRUM_ERR_OK                 0       //!< No error occured
+#define SPECTRUM_ERR_INVALID_PTR        -1      //!< Invalid pointer (Null Pointer)
+#define SPECTRUM_ERR_INVALID_PARAM      -2      //!< Invalid parameter value
+
+#define SPECTRUM_FFT_MIN_SIZE           256     //!< Smallest supported FFT size (real samples)
+#define SPECTRUM_FFT_MAX_SIZE           1024    //!< Largest supported FFT size (real samples)
+
+#define SPECTRUM_TWO_PI_Q30             6746518852LL    //!< 2 pi (Q30) for the twiddle and Goertzel coefficients
+
+/*
+ * Public Types
+*/
+
+/**
+ * @brief Struct which represents a real FFT of a fixed size
+ *
+ * The twiddle factors and the window are derived from a quarter wave sine
+ * table, which is computed once by spectrumInitFFT (no floating point)
+ */
+typedef struct _SpectrumFFTData
+{
+    uint32_t fftSize;                                   //!< Number of real samples (power of two)
+    uint32_t log2Size;                                  //!< log2(fftSize)
+    int16_t sineTable[SPECTRUM_FFT_MAX_SIZE / 4 + 1];   //!< sin(2 pi i / fftSize) for i = 0 .. fftSize / 4 (Q15)
+} SpectrumFFTData_t;
+
+/**
+ * @brief Initialize a real FFT and compute its sine table
+ *
+ * @param pFFT          Pointer to the FFT struct
+ * @param fftSize       Number of real samples (power of two, SPECTRUM_FFT_MIN_SIZE..SPECTRUM_FFT_MAX_SIZE)
+ *
+ * @return Return SPECTRUM_ERR_OK is no error occured
+ */
+int32_t spectrumInitFFT(SpectrumFFTData_t* pFFT, uint32_t fftSize);
+
+/**
+ * @brief Applies a Hann window to a block of samples (in place)
+ *
+ * @param pFFT          Pointer to the FFT struct
+ * @param pData         Pointer to the samples (fftSize)
+ *
+ * @return Return SPECTRUM_ERR_OK is no error occured
+ */
+int32_t spectrumWindowHann(const SpectrumFFTData_t* pFFT, int16_t* pData);
+
+/**
+ * @brief Computes the spectrum of a block of real samples (in place)
+ *
+ * The result are fftSize / 2 complex bins (re, im interleaved) scaled with
+ * 1 / fftSize. Bin 0 holds the DC value in the real part and the value of
+ * the Nyquist frequency in the imaginary part
+ *
+ * @remark The samples must be within +-0.5 (Q15 +-16384) to rule out an
+ * overflow
+ *
+ * @param pFFT          Pointer to the FFT struct
+ * @param pData         Pointer to the samples (fftSize), overwritten with the bins
+ *
+ * @return Return SPECTRUM_ERR_OK is no error occured
+ */
+int32_t spectrumRealFFT(const SpectrumFFTData_t* pFFT, int16_t* pData);
+
+/**
+ * @brief Computes the power (re² + im²) of the bins of spectrumRealFFT
+ *
+ * @param pFFT          Pointer to the FFT struct
+ * @param pBins         Pointer to the complex bins (fftSize / 2)
+ * @param pPower        Pointer to store the power of the bins (fftSize / 2), bin 0 is the DC power
+ *
+ * @return Return SPECTRUM_ERR_OK is no error occured
+ */
+int32_t spectrumPower(const SpectrumFFTData_t* pFFT, const int16_t* pBins, uint32_t* pPower);
+
+/**
+ * @brief Computes the power of a single bin with the Goertzel algorithm.
+ * The result has the same scale as the power of spectrumPower
+ *
+ * @param pFFT          Pointer to the FFT struct (provides the size)
+ * @param pData         Pointer to the (windowed) samples (fftSize)
+ * @param bin           Bin index (1 .. fftSize / 2 - 1)
+ * @param pPower        Pointer to store the power of the bin
+ *
+ * @return Return SPECTRUM_ERR_OK is no error occured
+ */
+int32_t spectrumGoertzel(const SpectrumFFTData_t* pFFT, const int16_t* pData, uint32_t bin, uint32_t* pPower);
+
+/**
+ * @brief Integer square root
+ *
+ * @param value         Input value
+ *
+ * @return Returns floor(sqrt(value))
+ */
+uint32_t spectrumSqrt(uint32_t value);
+
+#endif
@@ -0,0 +1,263 @@
+/**
+ * @file SpectrumFFT.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of a fixed-point real FFT with Q15 data
+ *
+ * The N real samples are treated as N/2 complex samples (even samples as
+ * real part, odd samples as imaginary part) and transformed with a radix-2
+ * decimation in time FFT. Each stage scales by 1/2, so no overflow can
+ * occur. A final split step separates the spectra of the even and odd
+ * samples and combines them into the spectrum of the real signal
+ *
+ * @version 0.1
+ * @date 2023-03-15
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include "Util/Spectrum/Spectrum.h"
+
+/*
+ * Private Defines
+*/
+#define SPECTRUM_Q15_ONE            32767                   //!< Largest Q15 value
+
+/*
+ * Private Module Functions
+*/
+static int32_t spectrumCos(const SpectrumFFTData_t* pFFT, uint32_t k);
+static int32_t spectrumSin(const SpectrumFFTData_t* pFFT, uint32_t k);
+static int16_t spectrumSat(int32_t value);
+
+int32_t spectrumInitFFT(SpectrumFFTData_t* pFFT, uint32_t fftSize)
+{
+    if (pFFT == 0)
+    {
+        return SPECTRUM_ERR_INVALID_PTR;
+    }
+
+    if (fftSize < SPECTRUM_FFT_MIN_SIZE || fftSize > SPECTRUM_FFT_MAX_SIZE || (fftSize & (fftSize - 1)) != 0)
+    {
+        return SPECTRUM_ERR_INVALID_PARAM;
+    }
+
+    pFFT->fftSize   = fftSize;
+    pFFT->log2Size  = 0;
+    while ((1UL << pFFT->log2Size) < fftSize)
+    {
+        pFFT->log2Size++;
+    }
+
+    // Rotation by the angle 2 pi / N (Taylor series, the angle is below 0.025)
+    int64_t angle   = SPECTRUM_TWO_PI_Q30 / fftSize;
+    int64_t angle2  = (angle * angle) >> 30;
+    int64_t angle3  = (angle2 * angle) >> 30;
+    int64_t angle4  = (angle2 * angle2) >> 30;
+    int64_t angle5  = (angle4 * angle) >> 30;
+    int64_t cosStep = (1LL << 30) - angle2 / 2 + angle4 / 24;
+    int64_t sinStep = angle - angle3 / 6 + angle5 / 120;
+
+    // Quarter wave by successive rotation (Q30, the error stays far below one Q15 LSB)
+    int64_t c = 1LL << 30;
+    int64_t s = 0;
+
+    for (uint32_t i=0; i<=fftSize/4; i++)
+    {
+        int32_t value = (int32_t)((s + (1LL << 14)) >> 15);
+        pFFT->sineTable[i] = (int16_t)((value > SPECTRUM_Q15_ONE) ? SPECTRUM_Q15_ONE : value);
+
+        int64_t cNext = (c * cosStep - s * sinStep) >> 30;
+        s = (s * cosStep + c * sinStep) >> 30;
+        c = cNext;
+    }
+
+    return SPECTRUM_ERR_OK;
+}
+
+int32_t spectrumWindowHann(const SpectrumFFTData_t* pFFT, int16_t* pData)
+{
+    if (pFFT == 0 || pData == 0)
+    {
+        return SPECTRUM_ERR_INVALID_PTR;
+    }
+
+    const uint32_t n = pFFT->fftSize;
+
+    for (uint32_t i=0; i<n; i++)
+    {
+        // w = 0.5 - 0.5 cos(2 pi i / N), cos is symmetric around N / 2
+        int32_t cosValue = spectrumCos(pFFT, (i <= n / 2) ? i : (n - i));
+        int32_t window = (SPECTRUM_Q15_ONE + 1 - cosValue) >> 1;
+
+        pData[i] = (int16_t)((pData[i] * window + (1 << 14)) >> 15);
+    }
+
+    return SPECTRUM_ERR_OK;
+}
+
+int32_t spectrumRealFFT(const SpectrumFFTData_t* pFFT, int16_t* pData)
+{
+    if (pFFT == 0 || pData == 0)
+    {
+        return SPECTRUM_ERR_INVALID_PTR;
+    }
+
+    const uint32_t m = pFFT->fftSize / 2;
+    const uint32_t log2M = pFFT->log2Size - 1;
+
+    // Bit reversal of the complex samples
+    for (uint32_t i=0; i<m; i++)
+    {
+        uint32_t j = 0;
+        for (uint32_t bit=0; bit<log2M; bit++)
+        {
+            j |= ((i >> bit) & 1) << (log2M - 1 - bit);
+        }
+
+        if (j > i)
+        {
+            int16_t re = pData[2 * i];
+            int16_t im = pData[2 * i + 1];
+            pData[2 * i]        = pData[2 * j];
+            pData[2 * i + 1]    = pData[2 * j + 1];
+            pData[2 * j]        = re;
+            pData[2 * j + 1]    = im;
+        }
+    }
+
+    // Radix-2 butterflies, W_M^k = W_N^(2k)
+    for (uint32_t span=1; span<m; span*=2)
+    {
+        uint32_t twiddleStep = m / span;
+
+        for (uint32_t k=0; k<span; k++)
+        {
+            int32_t wr = spectrumCos(pFFT, k * twiddleStep);
+            int32_t wi = -spectrumSin(pFFT, k * twiddleStep);
+
+            for (uint32_t i=k; i<m; i+=2*span)
+            {
+                int16_t* pA = &pData[2 * i];
+                int16_t* pB = &pData[2 * (i + span)];
+
+                int32_t tr = (pB[0] * wr - pB[1] * wi + (1 << 14)) >> 15;
+                int32_t ti = (pB[0] * wi + pB[1] * wr + (1 << 14)) >> 15;
+
+                int32_t ar = pA[0];
+                int32_t ai = pA[1];
+
+                pA[0] = (int16_t)((ar + tr) >> 1);
+                pA[1] = (int16_t)((ai + ti) >> 1);
+                pB[0] = (int16_t)((ar - tr) >> 1);
+                pB[1] = (int16_t)((ai - ti) >> 1);
+            }
+        }
+    }
+
+    // Split step: X[k] = (Fe + W^k G) / 4, X[M-k] = conj(Fe - W^k G) / 4
+    // with Fe = Z[k] + conj(Z[M-k]) and G = -j (Z[k] - conj(Z[M-k])), the
+    // additional factor 1/2 gives the overall scaling of 1/N
+    int32_t dcRe = pData[0];
+    int32_t dcIm = pData[1];
+    pData[0] = (int16_t)((dcRe + dcIm + 1) >> 1);
+    pData[1] = (int16_t)((dcRe - dcIm + 1) >> 1);
+
+    for (uint32_t k=1; k<=m/2; k++)
+    {
+        int16_t* pA = &pData[2 * k];
+        int16_t* pB = &pData[2 * (m - k)];
+
+        int32_t feRe = pA[0] + pB[0];
+        int32_t feIm = pA[1] - pB[1];
+        int32_t gRe = pA[1] + pB[1];
+        int32_t gIm = pB[0] - pA[0];
+
+        int32_t wr = spectrumCos(pFFT, k);
+        int32_t wi = -spectrumSin(pFFT, k);
+
+        int32_t tRe = (int32_t)(((int64_t)gRe * wr - (int64_t)gIm * wi + (1 << 14)) >> 15);
+        int32_t tIm = (int32_t)(((int64_t)gRe * wi + (int64_t)gIm * wr + (1 << 14)) >> 15);
+
+        pA[0] = spectrumSat((feRe + tRe + 2) >> 2);
+        pA[1] = spectrumSat((feIm + tIm + 2) >> 2);
+        pB[0] = spectrumSat((feRe - tRe + 2) >> 2);
+        pB[1] = spectrumSat((tIm - feIm + 2) >> 2);
+    }
+
+    return SPECTRUM_ERR_OK;
+}
+
+int32_t spectrumPower(const SpectrumFFTData_t* pFFT, const int16_t* pBins, uint32_t* pPower)
+{
+    if (pFFT == 0 || pBins == 0 || pPower == 0)
+    {
+        return SPECTRUM_ERR_INVALID_PTR;
+    }
+
+    // Bin 0 contains DC and Nyquist, only the DC part is reported
+    pPower[0] = (uint32_t)(pBins[0] * pBins[0]);
+
+    for (uint32_t k=1; k<pFFT->fftSize/2; k++)
+    {
+        int32_t re = pBins[2 * k];
+        int32_t im = pBins[2 * k + 1];
+        pPower[k] = (uint32_t)(re * re) + (uint32_t)(im * im);
+    }
+
+    return SPECTRUM_ERR_OK;
+}
+
+uint32_t spectrumSqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return root;
+}
+
+/**
+ * @brief Returns cos(2 pi k / N) for k = 0 .. N / 2 (Q15)
+ */
+static int32_t spectrumCos(const SpectrumFFTData_t* pFFT, uint32_t k)
+{
+    uint32_t quarter = pFFT->fftSize / 4;
+
+    return (k <= quarter) ? pFFT->sineTable[quarter - k] : -pFFT->sineTable[k - quarter];
+}
+
+/**
+ * @brief Returns sin(2 pi k / N) for k = 0 .. N / 2 (Q15)
+ */
+static int32_t spectrumSin(const SpectrumFFTData_t* pFFT, uint32_t k)
+{
+    uint32_t quarter = pFFT->fftSize / 4;
+
+    return (k <= quarter) ? pFFT->sineTable[k] : pFFT->sineTable[2 * quarter - k];
+}
+
+/**
+ * @brief Saturates a value to the Q15 range
+ */
+static int16_t spectrumSat(int32_t value)
+{
+    return (int16_t)((value > INT16_MAX) ? INT16_MAX : ((value < INT16_MIN) ? INT16_MIN : value));
+}
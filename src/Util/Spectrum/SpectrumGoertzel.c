@@ -0,0 +1,92 @@
+/**
+ * @file SpectrumGoertzel.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of the Goertzel single bin detector with Q15 data
+ *
+ * The second order recurrence s[n] = x[n] + 2 cos(w) s[n-1] - s[n-2] needs
+ * one multiplication per sample, so watching a few known frequencies (e.g.
+ * a resonance) is much cheaper than a complete FFT. The coefficient is
+ * computed with Q30 precision: the resonance of the recurrence moves by
+ * (coefficient error) / (2 sin(w)), so the Q15 sine table would shift the
+ * lowest bins of a 1024 point transform by almost half a bin
+ *
+ * @version 0.1
+ * @date 2023-03-15
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include "Util/Spectrum/Spectrum.h"
+
+/*
+ * Private Defines
+*/
+#define GOERTZEL_ONE_Q30            (1LL << 30)     //!< 1.0 (Q30)
+#define GOERTZEL_ROUND_Q30          (1LL << 29)     //!< Rounding constant of the Q30 products
+
+/*
+ * Private Module Functions
+*/
+static int64_t spectrumCosQ30(int64_t angleQ30);
+
+int32_t spectrumGoertzel(const SpectrumFFTData_t* pFFT, const int16_t* pData, uint32_t bin, uint32_t* pPower)
+{
+    if (pFFT == 0 || pData == 0 || pPower == 0)
+    {
+        return SPECTRUM_ERR_INVALID_PTR;
+    }
+
+    if (bin == 0 || bin >= pFFT->fftSize / 2)
+    {
+        return SPECTRUM_ERR_INVALID_PARAM;
+    }
+
+    // 2 cos(2 pi bin / N) in Q30 (below 2.0 for bin > 0, so it fits into 32 bit), cos(pi - w) = -cos(w)
+    uint32_t quarter = pFFT->fftSize / 4;
+    uint32_t folded = (bin <= quarter) ? bin : (pFFT->fftSize / 2 - bin);
+    int64_t cosQ30 = spectrumCosQ30(SPECTRUM_TWO_PI_Q30 * folded / pFFT->fftSize);
+    int32_t coeffQ30 = (int32_t)((bin <= quarter) ? 2 * cosQ30 : -2 * cosQ30);
+
+    int32_t s1 = 0;
+    int32_t s2 = 0;
+
+    for (uint32_t i=0; i<pFFT->fftSize; i++)
+    {
+        // 32 x 32 => 64 bit multiplication (SMULL on the M4)
+        int32_t s0 = pData[i] + (int32_t)(((int64_t)coeffQ30 * s1 + GOERTZEL_ROUND_Q30) >> 30) - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    // |X|² = s1² + s2² - 2 cos(w) s1 s2, scaled with 1 / N² like the FFT bins (the
+    // coefficient is applied to s1 first, so the product stays within 64 bit)
+    int64_t power = (int64_t)s1 * s1 + (int64_t)s2 * s2 - s2 * (((int64_t)coeffQ30 * s1 + GOERTZEL_ROUND_Q30) >> 30);
+    power >>= 2 * pFFT->log2Size;
+
+    *pPower = (power < 0) ? 0 : ((power > (int64_t)UINT32_MAX) ? UINT32_MAX : (uint32_t)power);
+
+    return SPECTRUM_ERR_OK;
+}
+
+/**
+ * @brief Cosine of an angle between 0 and pi / 2 (Taylor series up to the
+ * 12th order, the truncation error is below 10 Q30 LSB)
+ *
+ * @param angleQ30      Angle in rad (Q30)
+ *
+ * @return Returns cos(angle) (Q30)
+ */
+static int64_t spectrumCosQ30(int64_t angleQ30)
+{
+    // Horner scheme: 1 - a²/2 (1 - a²/12 (1 - a²/30 (1 - a²/56 (1 - a²/90 (1 - a²/132)))))
+    static const int32_t divisors[] = {132, 90, 56, 30, 12, 2};
+    int64_t angle2 = (angleQ30 * angleQ30) >> 30;
+    int64_t value = GOERTZEL_ONE_Q30;
+
+    for (uint32_t i=0; i<sizeof(divisors) / sizeof(divisors[0]); i++)
+    {
+        value = GOERTZEL_ONE_Q30 - ((angle2 * value) >> 30) / divisors[i];
+    }
+
+    return value;
+}
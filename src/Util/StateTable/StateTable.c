@@ -10,8 +10,9 @@
  *
  */
 
-#include "StateTable.h"
+#include "CriticalSection.h"
 
+#include "StateTable.h"
 
 /*
  * Private Functions
@@ -47,6 +48,8 @@ int32_t stateTableInitialize(StateTable_t* pStateTable, StateTableEntry_t* pTabl
 
     pStateTable->currentStateID         = initStateID;
     pStateTable->previousStateID        = STT_UNKNOWN_STATE;
+    pStateTable->eventHead              = 0;
+    pStateTable->eventTail              = 0;
 
     stateTableFindState(pStateTable, pStateTable->currentStateID, &(pStateTable->pCurrentStateRef));
 
@@ -58,10 +61,17 @@ int32_t stateTableRunCyclic(StateTable_t* pStateTable)
 {
     int32_t result = STATETBL_ERR_EVENT_UNHANDLED;
 
-    // Get the current pending event and reset it in the table
+    // Get the oldest pending event and remove it from the queue
     // to indicate that the event has been processed
-    int32_t currentEvent        = pStateTable->pendingEvent;
-    pStateTable->pendingEvent   = STT_NONE_EVENT;
+    int32_t currentEvent = STT_NONE_EVENT;
+
+    CRITICAL_SECTION_ENTER();
+    if (pStateTable->eventTail != pStateTable->eventHead)
+    {
+        currentEvent            = pStateTable->eventQueue[pStateTable->eventTail];
+        pStateTable->eventTail  = (pStateTable->eventTail + 1) & (STT_EVENT_QUEUE_SIZE - 1);
+    }
+    CRITICAL_SECTION_EXIT();
 
     // Check for new Event
     if (currentEvent != STT_NONE_EVENT)
@@ -142,19 +152,27 @@ int32_t stateTableSendEvent(StateTable_t* pStateTable, int32_t event)
     if (pStateTable == 0 )
         return STATETBL_ERR_INVALID_PTR;
 
-    // Check if there is still an event pending. If so, we do not
-    // overwrite the old event but return an error
-    if (pStateTable->pendingEvent != STT_NONE_EVENT)
+    if (event == STT_NONE_EVENT)
+        return STATETBL_ERR_INVALID_EVENT_ID;
+
+    int32_t result = STATETBL_ERR_OK;
+
+    // If the queue is full, we do not overwrite the old events but return an error.
+    // Events may be sent from interrupts, so the queue is updated in a critical section
+    CRITICAL_SECTION_ENTER();
+    uint32_t nextHead = (pStateTable->eventHead + 1) & (STT_EVENT_QUEUE_SIZE - 1);
+    if (nextHead == pStateTable->eventTail)
     {
-        return STATETBL_ERR_EVENT_PENDING;
+        result = STATETBL_ERR_EVENT_PENDING;
     }
     else
     {
-        // If no pending event is waiting, we set the new event
-        pStateTable->pendingEvent = event;
+        pStateTable->eventQueue[pStateTable->eventHead] = event;
+        pStateTable->eventHead = nextHead;
     }
+    CRITICAL_SECTION_EXIT();
 
-    return STATETBL_ERR_OK;
+    return result;
 }
 
 /**
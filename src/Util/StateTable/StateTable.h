@@ -22,7 +22,7 @@
 #define STATETBL_ERR_INVALID_PTR            -1      //!< Invalid pointer (null pointer)
 #define STATETBL_ERR_INVALID_STATE_ID       -2      //!< Invalid state ID found
 #define STATETBL_ERR_INVALID_EVENT_ID       -3      //!< Invalid event ID found
-#define STATETBL_ERR_EVENT_PENDING          -4      //!< New event sent but still an event is pending
+#define STATETBL_ERR_EVENT_PENDING          -4      //!< New event sent but the event queue is full
 #define STATETBL_ERR_EVENT_UNHANDLED        -5      //!< Event couldn't be handled
 
 #define STT_INVALID_STATE                   -1      //!< Invalid state
@@ -31,6 +31,8 @@
 
 #define STT_NONE_EVENT                      0       //!< ID for "No Event"
 
+#define STT_EVENT_QUEUE_SIZE                8       //!< Number of events which can be pending (power of two)
+
 /*
  * Public Types
 */
@@ -100,7 +102,9 @@ typedef struct _StateTable
 
     State_t *pCurrentStateRef;              //!< Pointer to the current state object
 
-    int32_t pendingEvent;                   //!< Current pending event
+    int32_t eventQueue[STT_EVENT_QUEUE_SIZE];   //!< Pending events (FIFO)
+    uint32_t eventHead;                     //!< Write index of the event queue
+    uint32_t eventTail;                     //!< Read index of the event queue
 } StateTable_t;
 
 
@@ -123,7 +127,7 @@ int32_t stateTableInitialize(StateTable_t* pStateTable, StateTableEntry_t* pTabl
 /**
  * @brief Cyclic run function for the state machine. This function performs either the
  * state transitions if an event is pending or it calles the state function if such a
- * function is provided for the current state
+ * function is provided for the current state. One event is processed per cycle
  *
  * @param pStateTable   Pointer to the state machine instance
  *
@@ -132,8 +136,10 @@ int32_t stateTableInitialize(StateTable_t* pStateTable, StateTableEntry_t* pTabl
 int32_t stateTableRunCyclic(StateTable_t* pStateTable);
 
 /**
- * @brief Sends an event to the state machine instance which is processed in the next
- * state machien cycle
+ * @brief Sends an event to the state machine instance. The events are queued and
+ * processed in the order they were sent, one per state machine cycle
+ *
+ * @remark Can be called from interrupt context
  *
  * @param pStateTable   Pointer to the state machine instance
  * @param event         Event ID to send to the state machine
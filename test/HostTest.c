@@ -0,0 +1,77 @@
+/**
+ * @file HostTest.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Implementation of the check and timing helpers of the host tests
+ *
+ * @version 0.1
+ * @date 2023-03-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "HostTest.h"
+
+/*
+ * Public Variables
+*/
+volatile int64_t gBenchSink;
+
+/*
+ * Private Module Variables
+*/
+static uint32_t gChecks;                        //!< Number of executed checks
+static uint32_t gFailures;                      //!< Number of failed checks
+
+bool hostTestCheck(bool condition, const char* pText, const char* pFile, int line)
+{
+    gChecks++;
+
+    if (!condition)
+    {
+        gFailures++;
+        printf("%s:%d: check failed: %s\n", pFile, line, pText);
+    }
+
+    return condition;
+}
+
+bool hostTestCheckEqual(int64_t expected, int64_t actual, const char* pText, const char* pFile, int line)
+{
+    gChecks++;
+
+    if (expected != actual)
+    {
+        gFailures++;
+        printf("%s:%d: check failed: %s is %" PRId64 ", expected %" PRId64 "\n", pFile, line, pText, actual, expected);
+    }
+
+    return expected == actual;
+}
+
+int hostTestFinish(const char* pName)
+{
+    printf("%-28s %6u checks, %u failures\n", pName, (unsigned)gChecks, (unsigned)gFailures);
+
+    return (gFailures == 0) ? 0 : 1;
+}
+
+uint64_t hostTestCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+#endif
+}
+
+void hostBenchReport(const char* pName, uint64_t cycles, uint64_t count, const char* pUnit)
+{
+    printf("  %-40s %10.1f host cycles/%s\n", pName, (count != 0) ? (double)cycles / (double)count : 0.0, pUnit);
+}
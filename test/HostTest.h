@@ -0,0 +1,86 @@
+/**
+ * @file HostTest.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Minimal check and timing helpers for the host tests and benchmarks
+ *
+ * A failed check is reported with file and line and the test continues, the
+ * result of hostTestFinish is the exit code of the test program. Benchmarks
+ * report host cycles (time stamp counter) per call, the numbers compare
+ * variants on the same machine and are no Cortex-M4 cycle counts
+ *
+ * @version 0.1
+ * @date 2023-03-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _HOST_TEST_H_
+#define _HOST_TEST_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Public Defines
+*/
+
+//! Checks a condition, a failure is counted and printed
+#define TEST_CHECK(condition)       hostTestCheck((condition), #condition, __FILE__, __LINE__)
+
+//! Checks that two integers are equal, a failure prints both values
+#define TEST_CHECK_EQUAL(expected, actual) \
+    hostTestCheckEqual((int64_t)(expected), (int64_t)(actual), #actual, __FILE__, __LINE__)
+
+//! Keeps the compiler from removing a benchmarked computation
+#define BENCH_KEEP(value)           do { gBenchSink += (int64_t)(value); } while (0)
+
+/*
+ * Public Variables
+*/
+extern volatile int64_t gBenchSink;             //!< Sink for benchmark results
+
+/*
+ * Public Interface
+*/
+
+/**
+ * @brief Counts a check and prints a failure
+ *
+ * @return Returns the condition
+ */
+bool hostTestCheck(bool condition, const char* pText, const char* pFile, int line);
+
+/**
+ * @brief Counts a check for equality and prints a failure with both values
+ *
+ * @return Returns true if both values are equal
+ */
+bool hostTestCheckEqual(int64_t expected, int64_t actual, const char* pText, const char* pFile, int line);
+
+/**
+ * @brief Prints the summary of a test program
+ *
+ * @param pName     Name of the test program
+ *
+ * @return Returns the exit code (0 if all checks passed)
+ */
+int hostTestFinish(const char* pName);
+
+/**
+ * @brief Returns the time stamp counter of the host
+ *
+ * @return Returns the host cycles (nanoseconds if no counter is available)
+ */
+uint64_t hostTestCycles(void);
+
+/**
+ * @brief Prints one benchmark result line
+ *
+ * @param pName     Name of the benchmarked variant
+ * @param cycles    Host cycles of all iterations
+ * @param count     Number of processed items (samples, calls, ...)
+ * @param pUnit     Name of an item
+ */
+void hostBenchReport(const char* pName, uint64_t cycles, uint64_t count, const char* pUnit);
+
+#endif
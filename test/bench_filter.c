@@ -0,0 +1,605 @@
+/**
+ * @file bench_filter.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host benchmarks of the Filter library
+ *
+ * Every variant filters the same random signal, the result is the mean of
+ * host cycles per sample. The block size 1 corresponds to the sensor
+ * pipeline (one sample per frame), larger blocks show the gain of keeping
+ * coefficients and state in registers. A straightforward implementation
+ * (double precision, sorted copy of the median window) is measured as
+ * baseline
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HostTest.h"
+#include "Util/Filter/Filter.h"
+
+/*
+ * Private Defines
+*/
+#define BENCH_SAMPLES           4096        //!< Number of samples per run
+#define BENCH_RUNS              200         //!< Number of runs per variant
+#define BENCH_BIQUAD_STAGES     2           //!< 4th order low pass
+#define BENCH_FIR_TAPS          32          //!< Taps of the FIR filter
+#define BENCH_MAX_BLOCK         32          //!< Largest block size
+#define BENCH_ADC_FULL_SCALE    4096        //!< Range of the ADC samples of the median benchmarks
+#define BENCH_UV_PER_DIGIT      806         //!< Scale of the EMA samples (3.3V / 4096)
+#define BENCH_EMA_SCALING       100         //!< Scaling factor of the former pipeline EMA
+#define BENCH_EMA_ALPHA         7           //!< Alpha of the former pipeline EMA at 1kHz (0.07)
+#define BENCH_EMA_SHIFT         4           //!< Alpha shift of the Q EMA at 1kHz
+#define BENCH_MAX_CHANNELS      32          //!< Largest channel count of the EMA bank
+#define BENCH_BATCH_ALPHA_Q15   2048        //!< Alpha of the EMA bank (0.0625)
+#define BENCH_KALMAN_ALPHA_Q15  7823        //!< Position gain of the fusion (steady state at 100Hz)
+#define BENCH_KALMAN_BETA_Q16   213037      //!< Velocity gain of the fusion (steady state at 100Hz)
+#define BENCH_KALMAN_PERIOD_US  10000       //!< Sample period of the fusion
+
+/*
+ * Private Module Variables
+*/
+static int16_t gInputQ15[BENCH_SAMPLES];                //!< Random signal (Q15, -0.5..0.5)
+static int32_t gInputQ31[BENCH_SAMPLES];                //!< Random signal (Q31, -0.5..0.5)
+static double gInputDouble[BENCH_SAMPLES];              //!< Random signal (-0.5..0.5)
+static int16_t gOutputQ15[BENCH_SAMPLES];               //!< Output of the Q15 variants
+static int32_t gOutputQ31[BENCH_SAMPLES];               //!< Output of the Q31 variants
+static double gOutputDouble[BENCH_SAMPLES];             //!< Output of the double variants
+static int32_t gInputADC[BENCH_SAMPLES];                //!< Random ADC samples with outliers (0..4095)
+static int32_t gOutputADC[BENCH_SAMPLES];               //!< Output of the median variants
+
+static double gCoeffs[BENCH_BIQUAD_STAGES][5];          //!< Biquad coefficients {b0, b1, b2, -a1, -a2} (scaled by 1/2)
+static int16_t gCoeffsQ15[BENCH_BIQUAD_STAGES * 6];     //!< Biquad coefficients (Q15 layout)
+static int32_t gCoeffsQ31[BENCH_BIQUAD_STAGES * 5];     //!< Biquad coefficients (Q31 layout)
+static int16_t gTapsQ15[BENCH_FIR_TAPS];                //!< FIR coefficients (Q15)
+static double gTaps[BENCH_FIR_TAPS];                    //!< FIR coefficients
+
+/*
+ * Benchmark helpers
+*/
+
+static void benchSignal(void)
+{
+    srand(1);
+
+    for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+    {
+        gInputDouble[n] = (double)rand() / RAND_MAX - 0.5;
+        gInputQ15[n] = (int16_t)lrint(gInputDouble[n] * 32767.0);
+        gInputQ31[n] = (int32_t)llrint(gInputDouble[n] * 2147483647.0);
+
+        // Noisy mid scale value with 1% outliers
+        gInputADC[n] = (rand() % 100 == 0) ? rand() % BENCH_ADC_FULL_SCALE : 2000 + rand() % 64;
+    }
+}
+
+/**
+ * @brief Butterworth low pass (cutoff 0.05) with post shift 1 and a
+ * windowed sinc FIR low pass of the same cutoff
+ */
+static void benchDesign(void)
+{
+    double k = tan(M_PI * 0.05);
+
+    for (uint32_t s=0; s<BENCH_BIQUAD_STAGES; s++)
+    {
+        double q = 1.0 / (2.0 * cos(M_PI * (2.0 * s + 1.0) / (4.0 * BENCH_BIQUAD_STAGES)));
+        double norm = 0.5 / (1.0 + k / q + k * k);
+        const uint32_t q15Index[5] = {0, 2, 3, 4, 5};
+
+        gCoeffs[s][0] = k * k * norm;
+        gCoeffs[s][1] = 2.0 * gCoeffs[s][0];
+        gCoeffs[s][2] = gCoeffs[s][0];
+        gCoeffs[s][3] = -2.0 * (k * k - 1.0) * norm;
+        gCoeffs[s][4] = -(1.0 - k / q + k * k) * norm;
+
+        for (uint32_t i=0; i<5; i++)
+        {
+            gCoeffsQ15[s * 6 + q15Index[i]] = (int16_t)lrint(gCoeffs[s][i] * 32768.0);
+            gCoeffsQ31[s * 5 + i] = (int32_t)llrint(gCoeffs[s][i] * 2147483648.0);
+        }
+    }
+
+    for (uint32_t i=0; i<BENCH_FIR_TAPS; i++)
+    {
+        double t = (double)i - (BENCH_FIR_TAPS - 1) / 2.0;
+        gTaps[i] = 0.1 * sin(0.1 * M_PI * t) / (0.1 * M_PI * t) * (0.54 - 0.46 * cos(2.0 * M_PI * i / (BENCH_FIR_TAPS - 1)));
+        gTapsQ15[i] = (int16_t)lrint(gTaps[i] * 32768.0);
+    }
+}
+
+/**
+ * @brief Straightforward double precision biquad cascade (Direct Form I,
+ * one sample through all stages)
+ */
+static void benchBiquadDouble(double state[][4], const double* pIn, double* pOut, uint32_t count)
+{
+    for (uint32_t n=0; n<count; n++)
+    {
+        double x = pIn[n];
+
+        for (uint32_t s=0; s<BENCH_BIQUAD_STAGES; s++)
+        {
+            double* d = state[s];
+            double y = 2.0 * (gCoeffs[s][0] * x + gCoeffs[s][1] * d[0] + gCoeffs[s][2] * d[1] + gCoeffs[s][3] * d[2] + gCoeffs[s][4] * d[3]);
+
+            d[1] = d[0];
+            d[0] = x;
+            d[3] = d[2];
+            d[2] = y;
+            x = y;
+        }
+
+        pOut[n] = x;
+    }
+}
+
+/**
+ * @brief Straightforward double precision FIR filter on a circular delay
+ * line
+ */
+static void benchFIRDouble(double* pDelay, uint32_t* pIndex, const double* pIn, double* pOut, uint32_t count)
+{
+    for (uint32_t n=0; n<count; n++)
+    {
+        double acc = 0.0;
+
+        pDelay[*pIndex] = pIn[n];
+
+        for (uint32_t k=0; k<BENCH_FIR_TAPS; k++)
+        {
+            acc += gTaps[k] * pDelay[(*pIndex + BENCH_FIR_TAPS - k) % BENCH_FIR_TAPS];
+        }
+
+        *pIndex = (*pIndex + 1) % BENCH_FIR_TAPS;
+        pOut[n] = acc;
+    }
+}
+
+/**
+ * @brief Median of a sliding window by sorting a copy of the window
+ * (insertion sort), as baseline of the heap based median
+ */
+static int32_t benchMedianSort(int32_t* pWindow, uint32_t windowSize, uint32_t* pIndex, int32_t value)
+{
+    int32_t sorted[FILTER_MEDIAN_MAX_WINDOW];
+
+    pWindow[*pIndex] = value;
+    *pIndex = (*pIndex + 1) % windowSize;
+
+    sorted[0] = pWindow[0];
+
+    for (uint32_t i=1; i<windowSize; i++)
+    {
+        int32_t v = pWindow[i];
+        uint32_t j = i;
+
+        for (; j>0 && sorted[j - 1] > v; j--)
+        {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = v;
+    }
+
+    return sorted[windowSize / 2];
+}
+
+/**
+ * @brief filterEMA before the Q EMA was added (32 bit products), as
+ * baseline of the EMA benchmark
+ */
+static int32_t benchEMA32(EMAFilterData_t* pEMA, int32_t sensorValue)
+{
+    int32_t filteredValue = sensorValue;
+
+    if (pEMA->firstValueAvailable == true)
+    {
+        filteredValue = pEMA->previousValue * (pEMA->scalingFactor - pEMA->alpha) + sensorValue * pEMA->alpha;
+        filteredValue = filteredValue / pEMA->scalingFactor;
+    }
+
+    pEMA->firstValueAvailable   = true;
+    pEMA->previousValue         = filteredValue;
+
+    return filteredValue;
+}
+
+/*
+ * Benchmarks
+*/
+
+static void benchBiquad(void)
+{
+    const uint32_t blockSizes[] = {1, 4, BENCH_MAX_BLOCK};
+    char name[48];
+
+    printf("  Biquad cascade, %u stages\n", BENCH_BIQUAD_STAGES);
+
+    for (uint32_t b=0; b<sizeof(blockSizes) / sizeof(blockSizes[0]); b++)
+    {
+        uint32_t blockSize = blockSizes[b];
+        int16_t stateQ15[BENCH_BIQUAD_STAGES * 4];
+        int64_t stateQ31[BENCH_BIQUAD_STAGES * 2];
+        BiquadQ15Data_t biquadQ15;
+        BiquadQ31Data_t biquadQ31;
+        uint64_t cycles;
+
+        filterInitBiquadQ15(&biquadQ15, BENCH_BIQUAD_STAGES, gCoeffsQ15, stateQ15, 1);
+        cycles = 0;
+        for (uint32_t r=0; r<BENCH_RUNS; r++)
+        {
+            uint64_t start = hostTestCycles();
+            for (uint32_t n=0; n<BENCH_SAMPLES; n+=blockSize)
+            {
+                filterBiquadQ15(&biquadQ15, &gInputQ15[n], &gOutputQ15[n], blockSize);
+            }
+            cycles += hostTestCycles() - start;
+            BENCH_KEEP(gOutputQ15[BENCH_SAMPLES - 1]);
+        }
+        snprintf(name, sizeof(name), "filterBiquadQ15 (block %u)", (unsigned)blockSize);
+        hostBenchReport(name, cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+
+        filterInitBiquadQ31(&biquadQ31, BENCH_BIQUAD_STAGES, gCoeffsQ31, stateQ31, 1);
+        cycles = 0;
+        for (uint32_t r=0; r<BENCH_RUNS; r++)
+        {
+            uint64_t start = hostTestCycles();
+            for (uint32_t n=0; n<BENCH_SAMPLES; n+=blockSize)
+            {
+                filterBiquadQ31(&biquadQ31, &gInputQ31[n], &gOutputQ31[n], blockSize);
+            }
+            cycles += hostTestCycles() - start;
+            BENCH_KEEP(gOutputQ31[BENCH_SAMPLES - 1]);
+        }
+        snprintf(name, sizeof(name), "filterBiquadQ31 (block %u)", (unsigned)blockSize);
+        hostBenchReport(name, cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+    }
+
+    double state[BENCH_BIQUAD_STAGES][4] = {{0.0}};
+    uint64_t cycles = 0;
+    for (uint32_t r=0; r<BENCH_RUNS; r++)
+    {
+        uint64_t start = hostTestCycles();
+        benchBiquadDouble(state, gInputDouble, gOutputDouble, BENCH_SAMPLES);
+        cycles += hostTestCycles() - start;
+        BENCH_KEEP(gOutputDouble[BENCH_SAMPLES - 1] * 1e6);
+    }
+    hostBenchReport("double reference", cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+}
+
+static void benchFIR(void)
+{
+    const uint32_t blockSizes[] = {1, 4, BENCH_MAX_BLOCK};
+    char name[48];
+
+    printf("  FIR filter, %u taps\n", BENCH_FIR_TAPS);
+
+    for (uint32_t b=0; b<sizeof(blockSizes) / sizeof(blockSizes[0]); b++)
+    {
+        uint32_t blockSize = blockSizes[b];
+        int16_t state[BENCH_FIR_TAPS + BENCH_MAX_BLOCK - 1];
+        FIRQ15Data_t fir;
+        uint64_t cycles = 0;
+
+        filterInitFIRQ15(&fir, BENCH_FIR_TAPS, gTapsQ15, state, BENCH_MAX_BLOCK);
+        for (uint32_t r=0; r<BENCH_RUNS; r++)
+        {
+            uint64_t start = hostTestCycles();
+            for (uint32_t n=0; n<BENCH_SAMPLES; n+=blockSize)
+            {
+                filterFIRQ15(&fir, &gInputQ15[n], &gOutputQ15[n], blockSize);
+            }
+            cycles += hostTestCycles() - start;
+            BENCH_KEEP(gOutputQ15[BENCH_SAMPLES - 1]);
+        }
+        snprintf(name, sizeof(name), "filterFIRQ15 (block %u)", (unsigned)blockSize);
+        hostBenchReport(name, cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+    }
+
+    double delay[BENCH_FIR_TAPS] = {0.0};
+    uint32_t index = 0;
+    uint64_t cycles = 0;
+    for (uint32_t r=0; r<BENCH_RUNS; r++)
+    {
+        uint64_t start = hostTestCycles();
+        benchFIRDouble(delay, &index, gInputDouble, gOutputDouble, BENCH_SAMPLES);
+        cycles += hostTestCycles() - start;
+        BENCH_KEEP(gOutputDouble[BENCH_SAMPLES - 1] * 1e6);
+    }
+    hostBenchReport("double reference", cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+}
+
+static void benchMedian(void)
+{
+    const uint32_t windowSizes[] = {3, 5, 9, 15, FILTER_MEDIAN_MAX_WINDOW};
+    char name[48];
+
+    printf("  Median filter and Hampel outlier rejection\n");
+
+    for (uint32_t w=0; w<sizeof(windowSizes) / sizeof(windowSizes[0]); w++)
+    {
+        uint32_t windowSize = windowSizes[w];
+        MedianFilterData_t median;
+        HampelFilterData_t hampel;
+        uint64_t cycles;
+
+        filterInitMedian(&median, windowSize);
+        cycles = 0;
+        for (uint32_t r=0; r<BENCH_RUNS; r++)
+        {
+            uint64_t start = hostTestCycles();
+            for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+            {
+                gOutputADC[n] = filterMedian(&median, gInputADC[n]);
+            }
+            cycles += hostTestCycles() - start;
+            BENCH_KEEP(gOutputADC[BENCH_SAMPLES - 1]);
+        }
+        snprintf(name, sizeof(name), "filterMedian (window %u)", (unsigned)windowSize);
+        hostBenchReport(name, cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+
+        // Baseline, the full window gives the same median
+        int32_t window[FILTER_MEDIAN_MAX_WINDOW] = {0};
+        uint32_t index = 0;
+        uint32_t mismatches = 0;
+        cycles = 0;
+        for (uint32_t r=0; r<BENCH_RUNS; r++)
+        {
+            uint64_t start = hostTestCycles();
+            for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+            {
+                int32_t value = benchMedianSort(window, windowSize, &index, gInputADC[n]);
+                mismatches += (r > 0 || n >= windowSize) && (value != gOutputADC[n]);
+            }
+            cycles += hostTestCycles() - start;
+        }
+        TEST_CHECK_EQUAL(0, mismatches);
+        snprintf(name, sizeof(name), "sorted copy (window %u)", (unsigned)windowSize);
+        hostBenchReport(name, cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+
+        filterInitHampel(&hampel, windowSize, 40, 16);
+        cycles = 0;
+        for (uint32_t r=0; r<BENCH_RUNS; r++)
+        {
+            uint64_t start = hostTestCycles();
+            for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+            {
+                gOutputADC[n] = filterHampel(&hampel, gInputADC[n]);
+            }
+            cycles += hostTestCycles() - start;
+            BENCH_KEEP(gOutputADC[BENCH_SAMPLES - 1]);
+        }
+        snprintf(name, sizeof(name), "filterHampel (window %u)", (unsigned)windowSize);
+        hostBenchReport(name, cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+    }
+}
+
+static void benchEMA(void)
+{
+    EMAFilterData_t ema;
+    EMAQFilterData_t emaQ;
+    uint64_t cycles;
+
+    printf("  EMA filter (pipeline position filter at 1kHz)\n");
+
+    filterInitEMA(&ema, BENCH_EMA_SCALING, BENCH_EMA_ALPHA, true);
+    cycles = 0;
+    for (uint32_t r=0; r<BENCH_RUNS; r++)
+    {
+        uint64_t start = hostTestCycles();
+        for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+        {
+            gOutputADC[n] = benchEMA32(&ema, gInputADC[n] * BENCH_UV_PER_DIGIT);
+        }
+        cycles += hostTestCycles() - start;
+        BENCH_KEEP(gOutputADC[BENCH_SAMPLES - 1]);
+    }
+    hostBenchReport("filterEMA (former, 32 bit)", cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+
+    filterInitEMA(&ema, BENCH_EMA_SCALING, BENCH_EMA_ALPHA, true);
+    cycles = 0;
+    for (uint32_t r=0; r<BENCH_RUNS; r++)
+    {
+        uint64_t start = hostTestCycles();
+        for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+        {
+            gOutputADC[n] = filterEMA(&ema, gInputADC[n] * BENCH_UV_PER_DIGIT);
+        }
+        cycles += hostTestCycles() - start;
+        BENCH_KEEP(gOutputADC[BENCH_SAMPLES - 1]);
+    }
+    hostBenchReport("filterEMA (64 bit)", cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+
+    filterInitEMAQ(&emaQ, BENCH_EMA_SHIFT, true);
+    cycles = 0;
+    for (uint32_t r=0; r<BENCH_RUNS; r++)
+    {
+        uint64_t start = hostTestCycles();
+        for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+        {
+            gOutputADC[n] = filterEMAQ(&emaQ, gInputADC[n] * BENCH_UV_PER_DIGIT);
+        }
+        cycles += hostTestCycles() - start;
+        BENCH_KEEP(gOutputADC[BENCH_SAMPLES - 1]);
+    }
+    hostBenchReport("filterEMAQ", cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+}
+
+static void benchEMABatch(void)
+{
+    const uint32_t channelCounts[] = {2, 8, BENCH_MAX_CHANNELS};
+    static int16_t samples[BENCH_SAMPLES][BENCH_MAX_CHANNELS];
+    char name[48];
+
+    // The packed 16 bit instructions are C fallbacks on the host (FilterDSP.h), so the gain on the M4 is larger
+    printf("  EMA filter bank (one sample per channel)\n");
+
+    // 12 bit ADC data scaled to the Q15 range
+    for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+    {
+        for (uint32_t c=0; c<BENCH_MAX_CHANNELS; c++)
+        {
+            samples[n][c] = (int16_t)(gInputADC[(n + 97 * c) % BENCH_SAMPLES] << 3);
+        }
+    }
+
+    for (uint32_t i=0; i<sizeof(channelCounts) / sizeof(channelCounts[0]); i++)
+    {
+        uint32_t channelCount = channelCounts[i];
+        int16_t state[BENCH_MAX_CHANNELS];
+        int16_t output[BENCH_MAX_CHANNELS];
+        int32_t reference[BENCH_MAX_CHANNELS] = {0};
+        EMAQFilterData_t emaQ[BENCH_MAX_CHANNELS];
+        EMABatchQ15Data_t batch;
+        uint32_t mismatches = 0;
+        uint64_t cycles;
+
+        filterInitEMABatchQ15(&batch, channelCount, BENCH_BATCH_ALPHA_Q15, state, 0);
+        cycles = 0;
+        for (uint32_t r=0; r<BENCH_RUNS; r++)
+        {
+            uint64_t start = hostTestCycles();
+            for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+            {
+                filterEMABatchQ15(&batch, samples[n], output);
+            }
+            cycles += hostTestCycles() - start;
+            BENCH_KEEP(output[channelCount - 1]);
+        }
+        snprintf(name, sizeof(name), "filterEMABatchQ15 (%u channels)", (unsigned)channelCount);
+        hostBenchReport(name, cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES * channelCount, "channel");
+
+        // One Q EMA per channel (array of structures) as baseline
+        for (uint32_t c=0; c<channelCount; c++)
+        {
+            filterInitEMAQ(&emaQ[c], BENCH_EMA_SHIFT, true);
+        }
+        cycles = 0;
+        for (uint32_t r=0; r<BENCH_RUNS; r++)
+        {
+            uint64_t start = hostTestCycles();
+            for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+            {
+                for (uint32_t c=0; c<channelCount; c++)
+                {
+                    output[c] = (int16_t)filterEMAQ(&emaQ[c], samples[n][c]);
+                }
+            }
+            cycles += hostTestCycles() - start;
+            BENCH_KEEP(output[channelCount - 1]);
+        }
+        snprintf(name, sizeof(name), "filterEMAQ per channel (%u channels)", (unsigned)channelCount);
+        hostBenchReport(name, cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES * channelCount, "channel");
+
+        // The packed update gives the same result as the scalar Q15 update
+        filterInitEMABatchQ15(&batch, channelCount, BENCH_BATCH_ALPHA_Q15, state, 0);
+        for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+        {
+            filterEMABatchQ15(&batch, samples[n], output);
+
+            for (uint32_t c=0; c<channelCount; c++)
+            {
+                reference[c] += ((samples[n][c] - reference[c]) * BENCH_BATCH_ALPHA_Q15 + (1 << 14)) >> 15;
+                mismatches += (output[c] != reference[c]);
+            }
+        }
+        TEST_CHECK_EQUAL(0, mismatches);
+    }
+}
+
+static void benchFloat(void)
+{
+    static float inputFloat[BENCH_SAMPLES];
+    static float outputFloat[BENCH_SAMPLES];
+    EMAQFilterData_t emaQ;
+    EMAFFilterData_t emaF;
+    KalmanFilterData_t kalman;
+    KalmanFFilterData_t kalmanF;
+    uint64_t cycles;
+
+    // The host FPU is no Cortex-M4 FPU, the ratio only shows the trend of the FPU=hard build
+    printf("  Fixed point and single precision (sensor pipeline filters)\n");
+
+    for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+    {
+        inputFloat[n] = (float)(gInputADC[n] * BENCH_UV_PER_DIGIT);
+    }
+
+    filterInitEMAQ(&emaQ, BENCH_EMA_SHIFT, true);
+    cycles = 0;
+    for (uint32_t r=0; r<BENCH_RUNS; r++)
+    {
+        uint64_t start = hostTestCycles();
+        for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+        {
+            gOutputADC[n] = filterEMAQ(&emaQ, gInputADC[n] * BENCH_UV_PER_DIGIT);
+        }
+        cycles += hostTestCycles() - start;
+        BENCH_KEEP(gOutputADC[BENCH_SAMPLES - 1]);
+    }
+    hostBenchReport("filterEMAQ", cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+
+    filterInitEMAF(&emaF, 1.0f / (1 << BENCH_EMA_SHIFT), true);
+    cycles = 0;
+    for (uint32_t r=0; r<BENCH_RUNS; r++)
+    {
+        uint64_t start = hostTestCycles();
+        for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+        {
+            outputFloat[n] = filterEMAF(&emaF, inputFloat[n]);
+        }
+        cycles += hostTestCycles() - start;
+        BENCH_KEEP(outputFloat[BENCH_SAMPLES - 1]);
+    }
+    hostBenchReport("filterEMAF", cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+
+    filterInitKalman(&kalman, BENCH_KALMAN_ALPHA_Q15, BENCH_KALMAN_BETA_Q16, BENCH_KALMAN_PERIOD_US, true);
+    cycles = 0;
+    for (uint32_t r=0; r<BENCH_RUNS; r++)
+    {
+        uint64_t start = hostTestCycles();
+        for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+        {
+            gOutputADC[n] = filterKalman(&kalman, gInputADC[n] * BENCH_UV_PER_DIGIT, gInputADC[BENCH_SAMPLES - 1 - n] * BENCH_UV_PER_DIGIT);
+        }
+        cycles += hostTestCycles() - start;
+        BENCH_KEEP(gOutputADC[BENCH_SAMPLES - 1]);
+    }
+    hostBenchReport("filterKalman", cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+
+    filterInitKalmanF(&kalmanF, BENCH_KALMAN_ALPHA_Q15 / 32768.0f, BENCH_KALMAN_BETA_Q16 / 65536.0f, BENCH_KALMAN_PERIOD_US * 1e-6f, true);
+    cycles = 0;
+    for (uint32_t r=0; r<BENCH_RUNS; r++)
+    {
+        uint64_t start = hostTestCycles();
+        for (uint32_t n=0; n<BENCH_SAMPLES; n++)
+        {
+            outputFloat[n] = filterKalmanF(&kalmanF, inputFloat[n], inputFloat[BENCH_SAMPLES - 1 - n]);
+        }
+        cycles += hostTestCycles() - start;
+        BENCH_KEEP(outputFloat[BENCH_SAMPLES - 1]);
+    }
+    hostBenchReport("filterKalmanF", cycles, (uint64_t)BENCH_RUNS * BENCH_SAMPLES, "sample");
+}
+
+int main(void)
+{
+    benchSignal();
+    benchDesign();
+
+    benchBiquad();
+    benchFIR();
+    benchMedian();
+    benchEMA();
+    benchEMABatch();
+    benchFloat();
+
+    return hostTestFinish("bench_filter");
+}
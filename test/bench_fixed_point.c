@@ -0,0 +1,100 @@
+/**
+ * @file bench_fixed_point.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host benchmarks of the fixed-point math functions (FixedPoint.h)
+ *
+ * The conversion of the sensor residuals from µV into 10cm is measured
+ * with the former integer math (32 bit product and division), a 64 bit
+ * product with division and the multiplication with the constant
+ * reciprocal. The Q16.16 functions are compared with plain integer and
+ * single precision operations
+ *
+ * @remark The compiler replaces a division by a constant with a
+ * multiplication on the host and on the M4, the divisor of the "runtime"
+ * variants is therefore read from a volatile variable (SDIV on the M4)
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HostTest.h"
+#include "Util/FixedPoint.h"
+
+/*
+ * Private Defines
+*/
+#define BENCH_VALUES            4096        //!< Number of operands per run
+#define BENCH_RUNS              500         //!< Number of runs per variant
+
+#define Distance_Range          95          //!< Distance range of the application in m
+#define Voltage_Range           2000000     //!< Voltage range of the application in µV
+#define Distance_Per_MicroVolt  FX_RECIPROCAL_Q32(Distance_Range * 10, Voltage_Range)  //!< 10cm per µV (Q32)
+
+//! Runs an expression for all operands and reports the host cycles per operation
+#define BENCH_RUN(name, expression) \
+    do { \
+        uint64_t cycles = 0; \
+        for (uint32_t r=0; r<BENCH_RUNS; r++) \
+        { \
+            int64_t sum = 0; \
+            uint64_t start = hostTestCycles(); \
+            for (uint32_t i=0; i<BENCH_VALUES; i++) \
+            { \
+                int32_t a = gA[i]; \
+                int32_t b = gB[i]; \
+                (void)a; (void)b; \
+                sum += (expression); \
+            } \
+            cycles += hostTestCycles() - start; \
+            BENCH_KEEP(sum); \
+        } \
+        hostBenchReport((name), cycles, (uint64_t)BENCH_RUNS * BENCH_VALUES, "operation"); \
+    } while (0)
+
+/*
+ * Private Module Variables
+*/
+static int32_t gA[BENCH_VALUES];                        //!< Residuals in µV (+-2V), Q16.16 operands
+static int32_t gB[BENCH_VALUES];                        //!< Q16.16 operands (+-128, never 0)
+static float gFloatA[BENCH_VALUES];                     //!< gA as float
+static float gFloatB[BENCH_VALUES];                     //!< gB as float
+static volatile int32_t gVoltageRange = Voltage_Range;  //!< Divisor which is not known at compile time
+
+int main(void)
+{
+    srand(1);
+
+    for (uint32_t i=0; i<BENCH_VALUES; i++)
+    {
+        gA[i] = rand() % (2 * Voltage_Range + 1) - Voltage_Range;
+        gB[i] = (rand() % (256 * FX_Q16_ONE)) - 128 * FX_Q16_ONE;
+        gB[i] = (gB[i] == 0) ? 1 : gB[i];
+        gFloatA[i] = (float)gA[i] / FX_Q16_ONE;
+        gFloatB[i] = (float)gB[i] / FX_Q16_ONE;
+    }
+
+    int32_t divisor = gVoltageRange;
+
+    printf("  Residual conversion µV => 10cm\n");
+    BENCH_RUN("former (32 bit, constant divisor)", (a * Distance_Range * 10) / Voltage_Range);
+    BENCH_RUN("former (32 bit, runtime divisor)", (a * Distance_Range * 10) / divisor);
+    BENCH_RUN("64 bit product (runtime divisor)", (int32_t)(((int64_t)a * Distance_Range * 10) / divisor));
+    BENCH_RUN("fxMulQ32 (constant reciprocal)", fxMulQ32(a, Distance_Per_MicroVolt));
+
+    printf("  Q16.16 arithmetic\n");
+    BENCH_RUN("int32_t addition (no saturation)", a + b);
+    BENCH_RUN("fxSatAdd32", fxSatAdd32(a, b));
+    BENCH_RUN("fxMulQ16", fxMulQ16(a, b));
+    BENCH_RUN("fxDivQ16", fxDivQ16(a, b));
+    BENCH_RUN("float multiplication", (int32_t)(gFloatA[i] * gFloatB[i]));
+    BENCH_RUN("float division", (int32_t)(gFloatA[i] / gFloatB[i]));
+    BENCH_RUN("fxScaleQ31", fxScaleQ31(a, b << 12));
+
+    return hostTestFinish("bench_fixed_point");
+}
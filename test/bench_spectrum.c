@@ -0,0 +1,100 @@
+/**
+ * @file bench_spectrum.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host benchmarks of the spectrum library (Spectrum.h)
+ *
+ * Host cycles per transform of the window, the real FFT and the bin power
+ * for all supported FFT sizes, and of the Goertzel detector per bin. The
+ * ratio gives the number of watched bins up to which the Goertzel detector
+ * is cheaper than a complete spectrum
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HostTest.h"
+#include "Util/Spectrum/Spectrum.h"
+
+/*
+ * Private Defines
+*/
+#define BENCH_RUNS              2000        //!< Number of transforms per variant
+
+/*
+ * Private Module Variables
+*/
+static SpectrumFFTData_t gFFT;                          //!< FFT under test
+static int16_t gSamples[SPECTRUM_FFT_MAX_SIZE];         //!< Random samples (+-0.5)
+static int16_t gData[SPECTRUM_FFT_MAX_SIZE];            //!< Working buffer (samples, then bins)
+static uint32_t gPower[SPECTRUM_FFT_MAX_SIZE / 2];      //!< Power of the bins
+
+/*
+ * Benchmarks
+*/
+
+static void benchSize(uint32_t fftSize)
+{
+    uint64_t cycles[4] = {0};
+
+    spectrumInitFFT(&gFFT, fftSize);
+    printf("  N = %u\n", (unsigned)fftSize);
+
+    for (uint32_t r=0; r<BENCH_RUNS; r++)
+    {
+        uint32_t power;
+        uint64_t start;
+
+        // The copy is not measured, all functions work in place
+        memcpy(gData, gSamples, fftSize * sizeof(int16_t));
+
+        start = hostTestCycles();
+        spectrumWindowHann(&gFFT, gData);
+        cycles[0] += hostTestCycles() - start;
+
+        start = hostTestCycles();
+        spectrumGoertzel(&gFFT, gData, fftSize / 10, &power);
+        cycles[3] += hostTestCycles() - start;
+
+        start = hostTestCycles();
+        spectrumRealFFT(&gFFT, gData);
+        cycles[1] += hostTestCycles() - start;
+
+        start = hostTestCycles();
+        spectrumPower(&gFFT, gData, gPower);
+        cycles[2] += hostTestCycles() - start;
+
+        BENCH_KEEP(gPower[fftSize / 10] + power);
+    }
+
+    hostBenchReport("spectrumWindowHann", cycles[0], BENCH_RUNS, "transform");
+    hostBenchReport("spectrumRealFFT", cycles[1], BENCH_RUNS, "transform");
+    hostBenchReport("spectrumPower", cycles[2], BENCH_RUNS, "transform");
+    hostBenchReport("spectrumGoertzel (one bin)", cycles[3], BENCH_RUNS, "transform");
+
+    hostBenchReport("spectrumRealFFT per sample", cycles[1], (uint64_t)BENCH_RUNS * fftSize, "sample");
+    printf("  %-40s %10.1f bins\n", "Goertzel break even (FFT + power)", (double)(cycles[1] + cycles[2]) / (double)cycles[3]);
+}
+
+int main(void)
+{
+    srand(1);
+
+    for (uint32_t n=0; n<SPECTRUM_FFT_MAX_SIZE; n++)
+    {
+        gSamples[n] = (int16_t)(rand() % 32768 - 16384);
+    }
+
+    for (uint32_t fftSize=SPECTRUM_FFT_MIN_SIZE; fftSize<=SPECTRUM_FFT_MAX_SIZE; fftSize*=2)
+    {
+        benchSize(fftSize);
+    }
+
+    return hostTestFinish("bench_spectrum");
+}
@@ -0,0 +1,24 @@
+/**
+ * @file CriticalSection.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host version of the critical section hook
+ *
+ * The host tests run the modules in a single thread without interrupts, so
+ * the critical sections are empty
+ *
+ * @version 0.1
+ * @date 2023-03-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _CRITICAL_SECTION_H_
+#define _CRITICAL_SECTION_H_
+
+/*
+ * Public Defines
+*/
+#define CRITICAL_SECTION_ENTER()    //!< No interrupts on the host
+#define CRITICAL_SECTION_EXIT()     //!< No interrupts on the host
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ * @file HostStub.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief RAM objects of the core peripherals for the host tests
+ *
+ * @version 0.1
+ * @date 2023-03-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <time.h>
+
+#include "stm32g4xx_hal.h"
+
+/*
+ * Public Variables
+*/
+CoreDebug_Type gHostCoreDebug;
+
+/*
+ * Private Module Variables
+*/
+static DWT_Type gHostDWT;
+
+DWT_Type* hostReadDWT(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    gHostDWT.CYCCNT = (uint32_t)__builtin_ia32_rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    gHostDWT.CYCCNT = (uint32_t)((uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec);
+#endif
+
+    return &gHostDWT;
+}
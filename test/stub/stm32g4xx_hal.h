@@ -0,0 +1,41 @@
+/**
+ * @file stm32g4xx_hal.h
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host replacement of the HAL header for the host tests
+ *
+ * Only the device header (register layout, CMSIS types) is included, the
+ * HAL drivers are not available on the host. The core peripherals used by
+ * the modules under test are mapped to RAM objects: the DWT cycle counter
+ * returns the time stamp counter of the host, so the runtime statistics of
+ * the modules contain host cycles
+ *
+ * @version 0.1
+ * @date 2023-03-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef _HOST_STM32G4XX_HAL_H_
+#define _HOST_STM32G4XX_HAL_H_
+
+#include <stdint.h>
+
+#include "stm32g4xx.h"
+
+/*
+ * Core peripherals mapped to RAM (see HostStub.c)
+*/
+#undef DWT
+#undef CoreDebug
+
+extern CoreDebug_Type gHostCoreDebug;           //!< Core debug registers (enable bits only)
+
+DWT_Type* hostReadDWT(void);
+
+#define DWT                 (hostReadDWT())     //!< DWT with a CYCCNT updated from the host time stamp counter
+#define CoreDebug           (&gHostCoreDebug)   //!< Core debug registers in RAM
+
+//! Memory barrier of the host (the CMSIS version is an ARM instruction)
+#define __DMB()             __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#endif
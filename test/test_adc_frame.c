@@ -0,0 +1,304 @@
+/**
+ * @file test_adc_frame.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host stress test of the ADC frame buffer (ADCFrame.c)
+ *
+ * A writer thread publishes frames back to back (as a conversion complete
+ * interrupt at maximum rate would), while the reader copies them with
+ * adcFrameRead. Every field of a frame is derived from its number, so a
+ * copy mixing two frames is detected. The sequence numbers of the copies
+ * have to increase and the newData flag has to match them. A second reader
+ * uses adcFrameReadNext and has to get every frame in order, except for
+ * frames which were overwritten before it came back. On a single core
+ * both threads preempt each other at arbitrary points, which also covers a
+ * writer stopped in the middle of an update (ADC_ERR_BUSY)
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "HostTest.h"
+#include "ADCFrame.h"
+
+/*
+ * Private Defines
+*/
+#define TEST_FRAMES             20000000    //!< Number of frames published by the writer thread
+
+/*
+ * Private Module Variables
+*/
+static volatile int gWriterDone;            //!< Writer thread has published all frames
+
+/*
+ * Test helpers
+*/
+
+/**
+ * @brief Publishes frame number n, all fields are derived from n
+ */
+static void testPublish(uint32_t n)
+{
+    int32_t raw[ADC_CHANNEL_COUNT];
+    int32_t microVolt[ADC_CHANNEL_COUNT];
+
+    for (int32_t i=0; i<ADC_CHANNEL_COUNT; i++)
+    {
+        raw[i]          = (int32_t)(n * 7 + (uint32_t)i);
+        microVolt[i]    = (int32_t)(n * 13 + (uint32_t)i);
+    }
+
+    adcFramePublish(raw, microVolt, (int32_t)n, -(int32_t)n);
+}
+
+/**
+ * @brief Checks that all fields of a copy belong to the same frame
+ */
+static int testConsistent(const ADCSnapshot_t* pSnapshot)
+{
+    uint32_t n = pSnapshot->sequence;
+
+    for (int32_t i=0; i<ADC_CHANNEL_COUNT; i++)
+    {
+        if (pSnapshot->raw[i] != (int32_t)(n * 7 + (uint32_t)i) || pSnapshot->microVolt[i] != (int32_t)(n * 13 + (uint32_t)i))
+        {
+            return 0;
+        }
+    }
+
+    return pSnapshot->supplyMicroVolt == (int32_t)n && pSnapshot->temperature == -(int32_t)n;
+}
+
+static void* testWriter(void* pArg)
+{
+    (void)pArg;
+
+    for (uint32_t n=1; n<=TEST_FRAMES; n++)
+    {
+        testPublish(n);
+    }
+
+    gWriterDone = 1;
+
+    return 0;
+}
+
+/*
+ * Tests
+*/
+
+static void testSingleThread(void)
+{
+    ADCSnapshot_t snapshot;
+
+    memset(&snapshot, 0, sizeof(snapshot));
+    adcFrameInitialize(3300000, 250);
+
+    // Nothing published yet
+    TEST_CHECK_EQUAL(ADC_ERR_OK, adcFrameRead(&snapshot));
+    TEST_CHECK(!snapshot.newData);
+    TEST_CHECK_EQUAL(0, snapshot.sequence);
+    TEST_CHECK_EQUAL(3300000, snapshot.supplyMicroVolt);
+    TEST_CHECK_EQUAL(250, snapshot.temperature);
+
+    testPublish(1);
+    TEST_CHECK_EQUAL(ADC_ERR_OK, adcFrameRead(&snapshot));
+    TEST_CHECK(snapshot.newData);
+    TEST_CHECK_EQUAL(1, snapshot.sequence);
+    TEST_CHECK(testConsistent(&snapshot));
+    TEST_CHECK_EQUAL(1 * 7 + ADC_VREF, adcFrameLatest()->raw[ADC_VREF]);
+
+    // Same frame again
+    TEST_CHECK_EQUAL(ADC_ERR_OK, adcFrameRead(&snapshot));
+    TEST_CHECK(!snapshot.newData);
+
+    // Frames skipped by the reader
+    testPublish(2);
+    testPublish(3);
+    TEST_CHECK_EQUAL(ADC_ERR_OK, adcFrameRead(&snapshot));
+    TEST_CHECK(snapshot.newData);
+    TEST_CHECK_EQUAL(3, snapshot.sequence);
+}
+
+static void testReadNext(void)
+{
+    ADCSnapshot_t snapshot;
+
+    memset(&snapshot, 0, sizeof(snapshot));
+    adcFrameInitialize(0, 0);
+
+    TEST_CHECK_EQUAL(ADC_ERR_OK, adcFrameReadNext(&snapshot));
+    TEST_CHECK(!snapshot.newData);
+
+    // Frames are returned in order, one per call
+    testPublish(1);
+    testPublish(2);
+    testPublish(3);
+    for (uint32_t n=1; n<=3; n++)
+    {
+        TEST_CHECK_EQUAL(ADC_ERR_OK, adcFrameReadNext(&snapshot));
+        TEST_CHECK(snapshot.newData);
+        TEST_CHECK_EQUAL(n, snapshot.sequence);
+        TEST_CHECK(testConsistent(&snapshot));
+    }
+
+    TEST_CHECK_EQUAL(ADC_ERR_OK, adcFrameReadNext(&snapshot));
+    TEST_CHECK(!snapshot.newData);
+    TEST_CHECK_EQUAL(3, snapshot.sequence);
+
+    // A full ring is still complete
+    for (uint32_t n=4; n<4 + ADC_FRAME_QUEUE_LENGTH; n++)
+    {
+        testPublish(n);
+    }
+    for (uint32_t n=4; n<4 + ADC_FRAME_QUEUE_LENGTH; n++)
+    {
+        TEST_CHECK_EQUAL(ADC_ERR_OK, adcFrameReadNext(&snapshot));
+        TEST_CHECK_EQUAL(n, snapshot.sequence);
+        TEST_CHECK(testConsistent(&snapshot));
+    }
+
+    // Overwritten frames are skipped, the reader continues with the oldest frame of the ring
+    for (uint32_t n=8; n<18; n++)
+    {
+        testPublish(n);
+    }
+    TEST_CHECK_EQUAL(ADC_ERR_OK, adcFrameReadNext(&snapshot));
+    TEST_CHECK_EQUAL(18 - ADC_FRAME_QUEUE_LENGTH, snapshot.sequence);
+    TEST_CHECK(testConsistent(&snapshot));
+
+    // The latest frame is independent of the in-order reader
+    ADCSnapshot_t latest;
+    memset(&latest, 0, sizeof(latest));
+    TEST_CHECK_EQUAL(ADC_ERR_OK, adcFrameRead(&latest));
+    TEST_CHECK_EQUAL(17, latest.sequence);
+    TEST_CHECK(testConsistent(&latest));
+}
+
+static void testConcurrentWriter(void)
+{
+    pthread_t writer;
+    ADCSnapshot_t snapshot;
+    uint64_t reads = 0;
+    uint64_t busy = 0;
+    uint64_t inconsistent = 0;
+    uint64_t newFrames = 0;
+    uint64_t cycles = 0;
+    uint32_t lastSequence = 0;
+    int ordered = 1;
+    int newDataValid = 1;
+
+    memset(&snapshot, 0, sizeof(snapshot));
+    adcFrameInitialize(0, 0);
+    gWriterDone = 0;
+
+    TEST_CHECK_EQUAL(0, pthread_create(&writer, 0, testWriter, 0));
+
+    while (!gWriterDone)
+    {
+        uint64_t start = hostTestCycles();
+        int32_t result = adcFrameRead(&snapshot);
+        cycles += hostTestCycles() - start;
+        reads++;
+
+        if (result == ADC_ERR_BUSY)
+        {
+            busy++;
+            continue;
+        }
+
+        if (snapshot.sequence != 0 && !testConsistent(&snapshot))
+        {
+            inconsistent++;
+        }
+
+        ordered         &= (snapshot.sequence >= lastSequence);
+        newDataValid    &= (snapshot.newData == (snapshot.sequence != lastSequence));
+        newFrames       += snapshot.newData;
+        lastSequence    = snapshot.sequence;
+    }
+
+    pthread_join(writer, 0);
+
+    TEST_CHECK_EQUAL(0, inconsistent);
+    TEST_CHECK(ordered);
+    TEST_CHECK(newDataValid);
+    TEST_CHECK(reads > busy);
+
+    // After the writer stopped, the last frame is read without retry
+    TEST_CHECK_EQUAL(ADC_ERR_OK, adcFrameRead(&snapshot));
+    TEST_CHECK_EQUAL(TEST_FRAMES, snapshot.sequence);
+    TEST_CHECK(testConsistent(&snapshot));
+
+    printf("  %u frames published, %llu reads, %llu new frames, %llu busy, %llu inconsistent\n", TEST_FRAMES,
+        (unsigned long long)reads, (unsigned long long)newFrames, (unsigned long long)busy, (unsigned long long)inconsistent);
+    hostBenchReport("adcFrameRead (concurrent writer)", cycles, reads, "read");
+}
+
+static void testConcurrentReadNext(void)
+{
+    pthread_t writer;
+    ADCSnapshot_t snapshot;
+    uint64_t reads = 0;
+    uint64_t busy = 0;
+    uint64_t inconsistent = 0;
+    uint64_t frames = 0;
+    uint64_t skipped = 0;
+    uint32_t lastSequence = 0;
+    int ordered = 1;
+
+    memset(&snapshot, 0, sizeof(snapshot));
+    adcFrameInitialize(0, 0);
+    gWriterDone = 0;
+
+    TEST_CHECK_EQUAL(0, pthread_create(&writer, 0, testWriter, 0));
+
+    while (!gWriterDone || snapshot.sequence != TEST_FRAMES)
+    {
+        int32_t result = adcFrameReadNext(&snapshot);
+        reads++;
+
+        if (result == ADC_ERR_BUSY)
+        {
+            busy++;
+            continue;
+        }
+
+        if (!snapshot.newData)
+        {
+            continue;
+        }
+
+        inconsistent    += !testConsistent(&snapshot);
+        ordered         &= (snapshot.sequence > lastSequence);
+        skipped         += snapshot.sequence - lastSequence - 1;
+        frames++;
+        lastSequence    = snapshot.sequence;
+    }
+
+    pthread_join(writer, 0);
+
+    TEST_CHECK_EQUAL(0, inconsistent);
+    TEST_CHECK(ordered);
+    TEST_CHECK_EQUAL(TEST_FRAMES, frames + skipped);
+
+    printf("  in order: %llu frames read, %llu overwritten before the read, %llu busy\n",
+        (unsigned long long)frames, (unsigned long long)skipped, (unsigned long long)busy);
+}
+
+int main(void)
+{
+    testSingleThread();
+    testReadNext();
+    testConcurrentWriter();
+    testConcurrentReadNext();
+
+    return hostTestFinish("test_adc_frame");
+}
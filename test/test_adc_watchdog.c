@@ -0,0 +1,215 @@
+/**
+ * @file test_adc_watchdog.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host test of the analog watchdog thresholds (ADCWatchdog.c)
+ *
+ * The thresholds are written into a register fake (ADC_TypeDef in RAM) and
+ * checked against a double precision reference for several VDDA values and
+ * gain compensations: the window is rounded outwards, limited to the ADC
+ * range and follows a change of the ratiometric scale or the gain. The TRx layout (12 bit AWD1, 8 bit
+ * AWD2/AWD3, filter bits of TR1) is checked bit by bit
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HostTest.h"
+#include "ADCWatchdog.h"
+
+/*
+ * Private Defines
+*/
+#define TEST_RANDOM_WINDOWS     100000      //!< Number of random windows of the rounding test
+
+/*
+ * Test helpers
+*/
+
+/**
+ * @brief Ratiometric conversion factor for a VDDA in µV / digit (Q16), as
+ * computed by the housekeeping lane
+ */
+static uint32_t testScaleQ16(double vddaMicroVolt)
+{
+    return (uint32_t)(vddaMicroVolt / 4095.0 * 65536.0 + 0.5);
+}
+
+/**
+ * @brief Voltage of a digit value with the given scale in µV
+ */
+static double testMicroVolt(uint32_t digits, uint32_t microVoltsPerDigitQ16)
+{
+    return (double)digits * (double)microVoltsPerDigitQ16 / 65536.0;
+}
+
+/*
+ * Tests
+*/
+
+static void testReference(void)
+{
+    const double vdda[] = {3000000.0, 3300000.0, 3600000.0};
+
+    for (uint32_t v=0; v<sizeof(vdda) / sizeof(vdda[0]); v++)
+    {
+        uint32_t scaleQ16 = testScaleQ16(vdda[v]);
+        double microVoltsPerDigit = (double)scaleQ16 / 65536.0;
+        ADCWatchdogThresholds_t thresholds;
+
+        adcWatchdogComputeThresholds(500000, 2500000, scaleQ16, ADC_WDG_GAIN_UNITY, &thresholds);
+
+        TEST_CHECK_EQUAL((uint32_t)floor(500000.0 / microVoltsPerDigit), thresholds.low);
+        TEST_CHECK_EQUAL((uint32_t)ceil(2500000.0 / microVoltsPerDigit), thresholds.high);
+    }
+}
+
+static void testRounding(void)
+{
+    srand(1);
+
+    for (uint32_t i=0; i<TEST_RANDOM_WINDOWS; i++)
+    {
+        uint32_t scaleQ16 = testScaleQ16(2700000.0 + (double)(rand() % 1000000));
+        int32_t low = rand() % 4000000;
+        int32_t high = low + rand() % 1000000;
+        ADCWatchdogThresholds_t thresholds;
+
+        adcWatchdogComputeThresholds(low, high, scaleQ16, ADC_WDG_GAIN_UNITY, &thresholds);
+
+        // Outwards: no value inside the window is outside the thresholds, and the window grows by less than one digit
+        TEST_CHECK(thresholds.low <= thresholds.high);
+        TEST_CHECK(testMicroVolt(thresholds.low, scaleQ16) <= (double)low);
+        TEST_CHECK(thresholds.low == ADC_WDG_FULL_SCALE || testMicroVolt(thresholds.low + 1, scaleQ16) > (double)low);
+
+        if (thresholds.high < ADC_WDG_FULL_SCALE)
+        {
+            TEST_CHECK(testMicroVolt(thresholds.high, scaleQ16) >= (double)high);
+            TEST_CHECK(thresholds.high == 0 || testMicroVolt(thresholds.high - 1, scaleQ16) < (double)high);
+        }
+    }
+}
+
+static void testLimits(void)
+{
+    uint32_t scaleQ16 = testScaleQ16(3300000.0);
+    ADCWatchdogThresholds_t thresholds;
+
+    adcWatchdogComputeThresholds(-1000, 5000000, scaleQ16, ADC_WDG_GAIN_UNITY, &thresholds);
+    TEST_CHECK_EQUAL(0, thresholds.low);
+    TEST_CHECK_EQUAL(ADC_WDG_FULL_SCALE, thresholds.high);
+
+    adcWatchdogComputeThresholds(0, 3300000, scaleQ16, ADC_WDG_GAIN_UNITY, &thresholds);
+    TEST_CHECK_EQUAL(0, thresholds.low);
+    TEST_CHECK_EQUAL(ADC_WDG_FULL_SCALE, thresholds.high);
+
+    adcWatchdogComputeThresholds(INT32_MAX, INT32_MAX, scaleQ16, ADC_WDG_GAIN_UNITY, &thresholds);
+    TEST_CHECK_EQUAL(ADC_WDG_FULL_SCALE, thresholds.low);
+    TEST_CHECK_EQUAL(ADC_WDG_FULL_SCALE, thresholds.high);
+}
+
+static void testSupplyChange(void)
+{
+    ADC_TypeDef adc;
+    ADCWatchdogThresholds_t thresholds;
+
+    // Window configured before the first VDDA measurement (nominal 3.3V)
+    memset(&adc, 0, sizeof(adc));
+    adcWatchdogComputeThresholds(500000, 2500000, testScaleQ16(3300000.0), ADC_WDG_GAIN_UNITY, &thresholds);
+    adcWatchdogWriteThresholds(&adc, ADC_WDG_AWD1, &thresholds);
+    uint32_t nominalHigh = (adc.TR1 & ADC_TR1_HT1) >> ADC_TR1_HT1_Pos;
+
+    // The measured VDDA is 3.0V: 2.5V now is digit 3413 instead of 3103
+    adcWatchdogComputeThresholds(500000, 2500000, testScaleQ16(3000000.0), ADC_WDG_GAIN_UNITY, &thresholds);
+    adcWatchdogWriteThresholds(&adc, ADC_WDG_AWD1, &thresholds);
+    uint32_t measuredHigh = (adc.TR1 & ADC_TR1_HT1) >> ADC_TR1_HT1_Pos;
+
+    TEST_CHECK_EQUAL(3103, nominalHigh);
+    TEST_CHECK_EQUAL(3413, measuredHigh);
+    TEST_CHECK(testMicroVolt(measuredHigh, testScaleQ16(3000000.0)) >= 2500000.0);
+
+    printf("  2.5V threshold: %u digits at nominal VDDA, %u digits at 3.0V\n", (unsigned)nominalHigh, (unsigned)measuredHigh);
+}
+
+static void testGain(void)
+{
+    const uint32_t gains[] = {ADC_WDG_GAIN_UNITY / 2, 3900, ADC_WDG_GAIN_UNITY, 4505, ADC_WDG_GAIN_UNITY * 2 - 1};
+    uint32_t scaleQ16 = testScaleQ16(3300000.0);
+
+    for (uint32_t g=0; g<sizeof(gains) / sizeof(gains[0]); g++)
+    {
+        // Compensated digits = raw digits * gain / 4096
+        double digitsPerMicroVolt = 65536.0 / (double)scaleQ16 * (double)gains[g] / ADC_WDG_GAIN_UNITY;
+        ADCWatchdogThresholds_t thresholds;
+
+        adcWatchdogComputeThresholds(600000, 1400000, scaleQ16, gains[g], &thresholds);
+
+        TEST_CHECK_EQUAL((uint32_t)floor(600000.0 * digitsPerMicroVolt), thresholds.low);
+        TEST_CHECK_EQUAL((uint32_t)ceil(1400000.0 * digitsPerMicroVolt), thresholds.high);
+    }
+
+    // VREFINT window 1.1V..1.3V with a sensor gain of 1.1: the injected result is 10% higher
+    ADCWatchdogThresholds_t unity;
+    ADCWatchdogThresholds_t compensated;
+
+    adcWatchdogComputeThresholds(1100000, 1300000, scaleQ16, ADC_WDG_GAIN_UNITY, &unity);
+    adcWatchdogComputeThresholds(1100000, 1300000, scaleQ16, 4505, &compensated);
+    TEST_CHECK(compensated.low > unity.low + unity.low / 20);
+    TEST_CHECK(compensated.high > unity.high + unity.high / 20);
+
+    printf("  1.3V threshold: %u digits without, %u digits with gain 1.1\n", (unsigned)unity.high, (unsigned)compensated.high);
+}
+
+static void testRegisters(void)
+{
+    ADC_TypeDef adc;
+    ADCWatchdogThresholds_t thresholds = {1000, 3000};
+
+    // AWD1: 12 bit thresholds, the filter setting is kept
+    memset(&adc, 0, sizeof(adc));
+    adc.TR1 = ADC_TR1_AWDFILT_1;
+    adcWatchdogWriteThresholds(&adc, ADC_WDG_AWD1, &thresholds);
+    TEST_CHECK_EQUAL(1000, (adc.TR1 & ADC_TR1_LT1) >> ADC_TR1_LT1_Pos);
+    TEST_CHECK_EQUAL(3000, (adc.TR1 & ADC_TR1_HT1) >> ADC_TR1_HT1_Pos);
+    TEST_CHECK_EQUAL(ADC_TR1_AWDFILT_1, adc.TR1 & ADC_TR1_AWDFILT);
+    TEST_CHECK_EQUAL(0, adc.TR2 | adc.TR3);
+
+    // AWD2/AWD3: bits 11:4, rounded outwards (1000 / 16 = 62.5, 3000 / 16 = 187.5)
+    memset(&adc, 0, sizeof(adc));
+    adcWatchdogWriteThresholds(&adc, ADC_WDG_AWD2, &thresholds);
+    TEST_CHECK_EQUAL(62, (adc.TR2 & ADC_TR2_LT2) >> ADC_TR2_LT2_Pos);
+    TEST_CHECK_EQUAL(188, (adc.TR2 & ADC_TR2_HT2) >> ADC_TR2_HT2_Pos);
+    TEST_CHECK_EQUAL(0, adc.TR1 | adc.TR3);
+
+    memset(&adc, 0, sizeof(adc));
+    adcWatchdogWriteThresholds(&adc, ADC_WDG_AWD3, &thresholds);
+    TEST_CHECK_EQUAL(62, (adc.TR3 & ADC_TR3_LT3) >> ADC_TR3_LT3_Pos);
+    TEST_CHECK_EQUAL(188, (adc.TR3 & ADC_TR3_HT3) >> ADC_TR3_HT3_Pos);
+    TEST_CHECK_EQUAL(0, adc.TR1 | adc.TR2);
+
+    // Full scale stays within the 8 bit field
+    thresholds.low  = 0;
+    thresholds.high = ADC_WDG_FULL_SCALE;
+    adcWatchdogWriteThresholds(&adc, ADC_WDG_AWD3, &thresholds);
+    TEST_CHECK_EQUAL(0, (adc.TR3 & ADC_TR3_LT3) >> ADC_TR3_LT3_Pos);
+    TEST_CHECK_EQUAL(255, (adc.TR3 & ADC_TR3_HT3) >> ADC_TR3_HT3_Pos);
+}
+
+int main(void)
+{
+    testReference();
+    testRounding();
+    testLimits();
+    testSupplyChange();
+    testGain();
+    testRegisters();
+
+    return hostTestFinish("test_adc_watchdog");
+}
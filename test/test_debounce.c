@@ -0,0 +1,275 @@
+/**
+ * @file test_debounce.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host test of the vertical counter debouncer (Debounce.c)
+ *
+ * The press and release latency and the edge masks are checked cycle by
+ * cycle for single inputs, bouncing inputs and active low inputs. All 32
+ * inputs with different debounce times are compared with a per input
+ * reference counter for a long random input sequence, which is also used
+ * to measure the CPU cost of a cycle
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HostTest.h"
+#include "Debounce.h"
+
+/*
+ * Private Defines
+*/
+#define TEST_CYCLE_MS           5           //!< Cycle time of the debouncer
+#define TEST_PRESS_MS           20          //!< Press debounce time (4 cycles)
+#define TEST_RELEASE_MS         40          //!< Release debounce time (8 cycles)
+#define TEST_RANDOM_CYCLES      1000000     //!< Number of cycles of the random sequence
+
+/*
+ * Private Types
+*/
+
+/**
+ * @brief Reference debouncer of a single input
+ *
+ */
+typedef struct _TestReference
+{
+    uint32_t pressCycles;                   //!< Cycles until an activation is accepted
+    uint32_t releaseCycles;                 //!< Cycles until a deactivation is accepted
+    uint32_t counter;                       //!< Cycles since the input differs from the output
+    uint32_t state;                         //!< Debounced output (1 = activated)
+} TestReference_t;
+
+/*
+ * Test helpers
+*/
+
+/**
+ * @brief Runs cycles with a constant input, returns the number of the cycle
+ * which changed the output (1 = first cycle) or 0 if it didn't change
+ */
+static uint32_t testRunUntilChange(Debouncer_t* pDebouncer, uint32_t inputs, uint32_t maxCycles)
+{
+    uint32_t state = pDebouncer->state;
+
+    for (uint32_t cycle=1; cycle<=maxCycles; cycle++)
+    {
+        if (debounceCycle(pDebouncer, inputs) != state)
+        {
+            return cycle;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief One cycle of the reference debouncer, returns the output
+ */
+static uint32_t testReferenceCycle(TestReference_t* pReference, uint32_t input)
+{
+    if (input == pReference->state)
+    {
+        pReference->counter = 0;
+        return pReference->state;
+    }
+
+    pReference->counter++;
+
+    if (pReference->counter == (pReference->state ? pReference->releaseCycles : pReference->pressCycles))
+    {
+        pReference->state ^= 1;
+        pReference->counter = 0;
+    }
+
+    return pReference->state;
+}
+
+/*
+ * Tests
+*/
+
+static void testParameters(void)
+{
+    Debouncer_t debouncer;
+    DebounceOutputValue_t value;
+
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_INVALID_PTR, debounceInitialize(0, TEST_CYCLE_MS, TEST_PRESS_MS, TEST_RELEASE_MS, 0));
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_INVALUD_PARAMETER, debounceInitialize(&debouncer, 0, TEST_PRESS_MS, TEST_RELEASE_MS, 0));
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_OK, debounceInitialize(&debouncer, TEST_CYCLE_MS, TEST_PRESS_MS, TEST_RELEASE_MS, 0));
+
+    // Longest time: DEBOUNCE_MAX_CYCLES full cycles
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_OK, debounceConfigureInputs(&debouncer, 1, DEBOUNCE_MAX_CYCLES * TEST_CYCLE_MS, TEST_RELEASE_MS));
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_INVALUD_PARAMETER, debounceConfigureInputs(&debouncer, 1, DEBOUNCE_MAX_CYCLES * TEST_CYCLE_MS + 1, TEST_RELEASE_MS));
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_INVALUD_PARAMETER, debounceConfigureInputs(&debouncer, 1, TEST_PRESS_MS, DEBOUNCE_MAX_CYCLES * TEST_CYCLE_MS + 1));
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_INVALID_PTR, debounceConfigureInputs(0, 1, TEST_PRESS_MS, TEST_RELEASE_MS));
+
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_INVALID_PTR, debounceGetValue(&debouncer, 0, 0));
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_INVALUD_PARAMETER, debounceGetValue(&debouncer, -1, &value));
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_INVALUD_PARAMETER, debounceGetValue(&debouncer, DEBOUNCE_MAX_INPUTS, &value));
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_OK, debounceGetValue(&debouncer, DEBOUNCE_MAX_INPUTS - 1, &value));
+    TEST_CHECK_EQUAL(DEBOUNCE_OUTPUT_DEACTIVATE, value);
+
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_INVALID_PTR, debounceGetEdges(0, 0, 0));
+    TEST_CHECK_EQUAL(DEBOUNCE_ERR_OK, debounceGetEdges(&debouncer, 0, 0));
+}
+
+static void testLatency(void)
+{
+    Debouncer_t debouncer;
+    DebounceOutputValue_t value;
+    uint32_t pressed;
+    uint32_t released;
+
+    debounceInitialize(&debouncer, TEST_CYCLE_MS, TEST_PRESS_MS, TEST_RELEASE_MS, 0);
+
+    // Asymmetric times: the press is accepted in the 4th, the release in the 8th cycle
+    TEST_CHECK_EQUAL(TEST_PRESS_MS / TEST_CYCLE_MS, testRunUntilChange(&debouncer, 0x1, 32));
+    TEST_CHECK_EQUAL(0x1, debouncer.state);
+    debounceGetEdges(&debouncer, &pressed, &released);
+    TEST_CHECK_EQUAL(0x1, pressed);
+    TEST_CHECK_EQUAL(0, released);
+    debounceGetValue(&debouncer, 0, &value);
+    TEST_CHECK_EQUAL(DEBOUNCE_OUTPUT_ACTIVATED, value);
+
+    // Edges are reported for a single cycle only
+    debounceCycle(&debouncer, 0x1);
+    debounceGetEdges(&debouncer, &pressed, &released);
+    TEST_CHECK_EQUAL(0, pressed);
+    TEST_CHECK_EQUAL(0, released);
+
+    TEST_CHECK_EQUAL(TEST_RELEASE_MS / TEST_CYCLE_MS, testRunUntilChange(&debouncer, 0x0, 32));
+    debounceGetEdges(&debouncer, &pressed, &released);
+    TEST_CHECK_EQUAL(0, pressed);
+    TEST_CHECK_EQUAL(0x1, released);
+
+    // Times are rounded up to full cycles, at least one cycle
+    debounceConfigureInputs(&debouncer, 0x1, TEST_PRESS_MS + 1, 0);
+    TEST_CHECK_EQUAL(TEST_PRESS_MS / TEST_CYCLE_MS + 1, testRunUntilChange(&debouncer, 0x1, 32));
+    TEST_CHECK_EQUAL(1, testRunUntilChange(&debouncer, 0x0, 32));
+}
+
+static void testBouncing(void)
+{
+    Debouncer_t debouncer;
+    uint32_t pressCycles = TEST_PRESS_MS / TEST_CYCLE_MS;
+
+    debounceInitialize(&debouncer, TEST_CYCLE_MS, TEST_PRESS_MS, TEST_RELEASE_MS, 0);
+
+    // A bounce one cycle before the press time restarts the count
+    for (uint32_t i=0; i<pressCycles - 1; i++)
+    {
+        TEST_CHECK_EQUAL(0, debounceCycle(&debouncer, 0x1));
+    }
+
+    TEST_CHECK_EQUAL(0, debounceCycle(&debouncer, 0x0));
+    TEST_CHECK_EQUAL(pressCycles, testRunUntilChange(&debouncer, 0x1, 32));
+
+    // Same for the release
+    for (uint32_t i=0; i<TEST_RELEASE_MS / TEST_CYCLE_MS - 1; i++)
+    {
+        TEST_CHECK_EQUAL(0x1, debounceCycle(&debouncer, 0x0));
+    }
+
+    TEST_CHECK_EQUAL(0x1, debounceCycle(&debouncer, 0x1));
+    TEST_CHECK_EQUAL(TEST_RELEASE_MS / TEST_CYCLE_MS, testRunUntilChange(&debouncer, 0x0, 32));
+}
+
+static void testParallel(void)
+{
+    Debouncer_t debouncer;
+    uint32_t pressed;
+    uint32_t released;
+
+    // Inputs 0..15 active high, 16..31 active low (idle high)
+    debounceInitialize(&debouncer, TEST_CYCLE_MS, TEST_PRESS_MS, TEST_RELEASE_MS, 0xFFFF0000UL);
+
+    TEST_CHECK_EQUAL(0, testRunUntilChange(&debouncer, 0xFFFF0000UL, 32));
+
+    // Bit 3 and bit 20 are pressed in the same cycle, the others stay idle
+    uint32_t inputs = 0xFFFF0000UL ^ 0x00100008UL;
+    TEST_CHECK_EQUAL(TEST_PRESS_MS / TEST_CYCLE_MS, testRunUntilChange(&debouncer, inputs, 32));
+    TEST_CHECK_EQUAL(0x00100008UL, debouncer.state);
+    debounceGetEdges(&debouncer, &pressed, &released);
+    TEST_CHECK_EQUAL(0x00100008UL, pressed);
+    TEST_CHECK_EQUAL(0, released);
+
+    // Different times per group: bit 3 releases after 2 cycles, bit 20 after 8
+    debounceConfigureInputs(&debouncer, 0x0000FFFFUL, TEST_PRESS_MS, 2 * TEST_CYCLE_MS);
+    TEST_CHECK_EQUAL(2, testRunUntilChange(&debouncer, 0xFFFF0000UL, 32));
+    TEST_CHECK_EQUAL(0x00100000UL, debouncer.state);
+    TEST_CHECK_EQUAL(TEST_RELEASE_MS / TEST_CYCLE_MS - 2, testRunUntilChange(&debouncer, 0xFFFF0000UL, 32));
+    debounceGetEdges(&debouncer, &pressed, &released);
+    TEST_CHECK_EQUAL(0, pressed);
+    TEST_CHECK_EQUAL(0x00100000UL, released);
+}
+
+static void testRandom(void)
+{
+    Debouncer_t debouncer;
+    TestReference_t reference[DEBOUNCE_MAX_INPUTS];
+    uint32_t failures = 0;
+    uint64_t cycles = 0;
+    uint32_t inputs = 0;
+    uint32_t previous = 0;
+
+    srand(1);
+    debounceInitialize(&debouncer, 1, 1, 1, 0x0F0F0F0FUL);
+
+    // Every input has its own press and release time (1..15 cycles)
+    for (uint32_t n=0; n<DEBOUNCE_MAX_INPUTS; n++)
+    {
+        reference[n].pressCycles    = 1 + (n % DEBOUNCE_MAX_CYCLES);
+        reference[n].releaseCycles  = DEBOUNCE_MAX_CYCLES - (n % DEBOUNCE_MAX_CYCLES);
+        reference[n].counter        = 0;
+        reference[n].state          = 0;
+
+        debounceConfigureInputs(&debouncer, 1UL << n, reference[n].pressCycles, reference[n].releaseCycles);
+    }
+
+    for (uint32_t i=0; i<TEST_RANDOM_CYCLES; i++)
+    {
+        // Each input changes with a probability of 1/8, so short and long pulses occur
+        uint32_t toggle = (uint32_t)rand() & (uint32_t)rand() & (uint32_t)rand();
+        toggle ^= ((uint32_t)rand() & 1) << 31;
+        inputs ^= toggle;
+
+        uint64_t start = hostTestCycles();
+        uint32_t state = debounceCycle(&debouncer, inputs);
+        cycles += hostTestCycles() - start;
+
+        uint32_t expected = 0;
+        for (uint32_t n=0; n<DEBOUNCE_MAX_INPUTS; n++)
+        {
+            uint32_t input = ((inputs ^ debouncer.invertMask) >> n) & 1;
+            expected |= testReferenceCycle(&reference[n], input) << n;
+        }
+
+        failures += (state != expected);
+        failures += (debouncer.pressedMask != (expected & ~previous));
+        failures += (debouncer.releasedMask != (previous & ~expected));
+        previous = expected;
+    }
+
+    TEST_CHECK_EQUAL(0, failures);
+
+    printf("  CPU cost of a cycle (32 inputs)\n");
+    hostBenchReport("debounceCycle", cycles, TEST_RANDOM_CYCLES, "cycle");
+}
+
+int main(void)
+{
+    testParameters();
+    testLatency();
+    testBouncing();
+    testParallel();
+    testRandom();
+
+    return hostTestFinish("test_debounce");
+}
@@ -0,0 +1,449 @@
+/**
+ * @file test_filter.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host test of the fixed-point filters of the Filter library
+ *
+ * The biquad cascades and the FIR filter are compared with a double
+ * precision implementation using the same (quantized) coefficients, so the
+ * error is the arithmetic error of the fixed-point code only. The result
+ * must not depend on the block size.
+ *
+ * The EMA filters are driven with the extremes of the int32_t range (full
+ * scale steps, alternating and random samples) for all alpha values: the
+ * output has to follow an extended precision EMA and stay between the
+ * inputs
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HostTest.h"
+#include "Util/Filter/Filter.h"
+
+/*
+ * Private Defines
+*/
+#define TEST_SAMPLES            20000       //!< Number of samples of the accuracy tests
+#define TEST_BIQUAD_STAGES      2           //!< 4th order Butterworth low pass
+#define TEST_BIQUAD_CUTOFF      0.05        //!< Cutoff frequency of the low pass (relative to the sample rate)
+#define TEST_BIQUAD_POST_SHIFT  1           //!< The feedback coefficients are above 1.0
+#define TEST_FIR_TAPS           31          //!< Taps of the FIR low pass
+#define TEST_MAX_BLOCK          32          //!< Largest block size
+#define TEST_EMA_SAMPLES        100000      //!< Number of alternating and random samples per alpha
+#define TEST_EMA_SETTLE         1000000     //!< Samples after a full scale step (enough for alpha = 2^-15)
+
+/*
+ * Private Module Variables
+*/
+static double gCoeffs[TEST_BIQUAD_STAGES][5];           //!< Biquad coefficients {b0, b1, b2, -a1, -a2}
+static int16_t gCoeffsQ15[TEST_BIQUAD_STAGES * 6];      //!< Quantized biquad coefficients (Q15 layout)
+static int32_t gCoeffsQ31[TEST_BIQUAD_STAGES * 5];      //!< Quantized biquad coefficients (Q31 layout)
+static int16_t gTapsQ15[TEST_FIR_TAPS];                 //!< Quantized FIR coefficients
+static double gInput[TEST_SAMPLES];                     //!< Test signal (-0.5..0.5)
+static double gReference[TEST_SAMPLES];                 //!< Double precision output
+
+/*
+ * Test helpers
+*/
+
+/**
+ * @brief Designs a Butterworth low pass as cascade of 2nd order stages
+ * (bilinear transform) and quantizes the coefficients
+ */
+static void testDesignBiquad(double cutoff)
+{
+    double k = tan(M_PI * cutoff);
+
+    for (uint32_t s=0; s<TEST_BIQUAD_STAGES; s++)
+    {
+        double q = 1.0 / (2.0 * cos(M_PI * (2.0 * s + 1.0) / (4.0 * TEST_BIQUAD_STAGES)));
+        double norm = 1.0 / (1.0 + k / q + k * k);
+
+        gCoeffs[s][0] = k * k * norm;
+        gCoeffs[s][1] = 2.0 * gCoeffs[s][0];
+        gCoeffs[s][2] = gCoeffs[s][0];
+        gCoeffs[s][3] = -2.0 * (k * k - 1.0) * norm;
+        gCoeffs[s][4] = -(1.0 - k / q + k * k) * norm;
+
+        // Quantize and use the quantized values for the reference, too
+        double scale15 = 32768.0 / (1 << TEST_BIQUAD_POST_SHIFT);
+        double scale31 = 2147483648.0 / (1 << TEST_BIQUAD_POST_SHIFT);
+        int16_t c15[5];
+
+        for (uint32_t i=0; i<5; i++)
+        {
+            c15[i] = (int16_t)lrint(gCoeffs[s][i] * scale15);
+            gCoeffsQ31[s * 5 + i] = (int32_t)llrint(gCoeffs[s][i] * scale31);
+        }
+
+        gCoeffsQ15[s * 6 + 0] = c15[0];
+        gCoeffsQ15[s * 6 + 1] = 0;
+        gCoeffsQ15[s * 6 + 2] = c15[1];
+        gCoeffsQ15[s * 6 + 3] = c15[2];
+        gCoeffsQ15[s * 6 + 4] = c15[3];
+        gCoeffsQ15[s * 6 + 5] = c15[4];
+    }
+}
+
+/**
+ * @brief Double precision biquad cascade with coefficients given in the
+ * scaled fixed-point format
+ */
+static void testReferenceBiquad(const double coeffs[][5], const double* pIn, double* pOut, uint32_t count)
+{
+    double state[TEST_BIQUAD_STAGES][4] = {{0.0}};
+
+    for (uint32_t n=0; n<count; n++)
+    {
+        double x = pIn[n];
+
+        for (uint32_t s=0; s<TEST_BIQUAD_STAGES; s++)
+        {
+            double* d = state[s];
+            double y = coeffs[s][0] * x + coeffs[s][1] * d[0] + coeffs[s][2] * d[1] + coeffs[s][3] * d[2] + coeffs[s][4] * d[3];
+
+            d[1] = d[0];
+            d[0] = x;
+            d[3] = d[2];
+            d[2] = y;
+            x = y;
+        }
+
+        pOut[n] = x;
+    }
+}
+
+/**
+ * @brief Sum of three sines (in and above the pass band) with noise, peak
+ * below 0.5
+ */
+static void testSignal(void)
+{
+    srand(1);
+
+    for (uint32_t n=0; n<TEST_SAMPLES; n++)
+    {
+        gInput[n] = 0.2 * sin(2.0 * M_PI * 0.011 * n) + 0.1 * sin(2.0 * M_PI * 0.037 * n) +
+                    0.1 * sin(2.0 * M_PI * 0.23 * n) + 0.05 * ((double)rand() / RAND_MAX - 0.5);
+    }
+}
+
+/**
+ * @brief Prints and returns the maximum error and the SNR of a fixed-point
+ * output (in LSB of the output format)
+ */
+static double testCompare(const char* pName, const double* pActual, double lsb)
+{
+    double maxError = 0.0;
+    double signal = 0.0;
+    double noise = 0.0;
+
+    for (uint32_t n=0; n<TEST_SAMPLES; n++)
+    {
+        double error = pActual[n] - gReference[n];
+
+        maxError = fmax(maxError, fabs(error));
+        signal += gReference[n] * gReference[n];
+        noise += error * error;
+    }
+
+    printf("  %-32s max error %8.3f LSB, SNR %6.1f dB\n", pName, maxError / lsb, 10.0 * log10(signal / fmax(noise, 1e-300)));
+
+    return maxError / lsb;
+}
+
+/**
+ * @brief Random sample of the full int32_t range
+ */
+static int32_t testRandom32(void)
+{
+    return (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand() ^ ((uint32_t)rand() << 31));
+}
+
+/**
+ * @brief Feeds one sample into a Q EMA and the reference (extended
+ * precision, so its own rounding stays far below the tolerance) and returns
+ * the deviation of the output in LSB
+ */
+static double testEMAQStep(EMAQFilterData_t* pEMA, long double* pReference, uint32_t alphaShift, int32_t value)
+{
+    int32_t output = filterEMAQ(pEMA, value);
+
+    *pReference += ((long double)value - *pReference) / (long double)(1UL << alphaShift);
+
+    return (double)fabsl((long double)output - *pReference);
+}
+
+/*
+ * Tests
+*/
+
+static void testBiquadQ15(void)
+{
+    static int16_t input[TEST_SAMPLES];
+    static int16_t output[TEST_SAMPLES];
+    static double actual[TEST_SAMPLES];
+    const uint32_t blockSizes[] = {1, 7, TEST_MAX_BLOCK};
+    double coeffs[TEST_BIQUAD_STAGES][5];
+    int16_t state[TEST_BIQUAD_STAGES * 4];
+    BiquadQ15Data_t biquad;
+
+    for (uint32_t s=0; s<TEST_BIQUAD_STAGES; s++)
+    {
+        const int16_t* c = &gCoeffsQ15[s * 6];
+        double scale = (1 << TEST_BIQUAD_POST_SHIFT) / 32768.0;
+
+        coeffs[s][0] = c[0] * scale;
+        coeffs[s][1] = c[2] * scale;
+        coeffs[s][2] = c[3] * scale;
+        coeffs[s][3] = c[4] * scale;
+        coeffs[s][4] = c[5] * scale;
+    }
+
+    for (uint32_t n=0; n<TEST_SAMPLES; n++)
+    {
+        input[n] = (int16_t)lrint(gInput[n] * 32768.0);
+        actual[n] = input[n] / 32768.0;
+    }
+
+    testReferenceBiquad(coeffs, actual, gReference, TEST_SAMPLES);
+
+    for (uint32_t b=0; b<sizeof(blockSizes) / sizeof(blockSizes[0]); b++)
+    {
+        TEST_CHECK_EQUAL(FILTER_ERR_OK, filterInitBiquadQ15(&biquad, TEST_BIQUAD_STAGES, gCoeffsQ15, state, TEST_BIQUAD_POST_SHIFT));
+
+        for (uint32_t n=0; n<TEST_SAMPLES; n+=blockSizes[b])
+        {
+            uint32_t count = (TEST_SAMPLES - n < blockSizes[b]) ? TEST_SAMPLES - n : blockSizes[b];
+            filterBiquadQ15(&biquad, &input[n], &output[n], count);
+        }
+
+        for (uint32_t n=0; n<TEST_SAMPLES; n++)
+        {
+            actual[n] = output[n] / 32768.0;
+        }
+
+        char name[40];
+        snprintf(name, sizeof(name), "biquad Q15 DF-I (block %u)", (unsigned)blockSizes[b]);
+
+        // Rounding of every stage output, amplified by the feedback of the following samples
+        TEST_CHECK(testCompare(name, actual, 1.0 / 32768.0) < 16.0);
+    }
+}
+
+static void testBiquadQ31(void)
+{
+    static int32_t input[TEST_SAMPLES];
+    static int32_t output[TEST_SAMPLES];
+    static double actual[TEST_SAMPLES];
+    const uint32_t blockSizes[] = {1, 7, TEST_MAX_BLOCK};
+    double coeffs[TEST_BIQUAD_STAGES][5];
+    int64_t state[TEST_BIQUAD_STAGES * 2];
+    BiquadQ31Data_t biquad;
+
+    for (uint32_t i=0; i<TEST_BIQUAD_STAGES * 5; i++)
+    {
+        coeffs[i / 5][i % 5] = gCoeffsQ31[i] * ((1 << TEST_BIQUAD_POST_SHIFT) / 2147483648.0);
+    }
+
+    for (uint32_t n=0; n<TEST_SAMPLES; n++)
+    {
+        input[n] = (int32_t)llrint(gInput[n] * 2147483648.0);
+        actual[n] = input[n] / 2147483648.0;
+    }
+
+    testReferenceBiquad(coeffs, actual, gReference, TEST_SAMPLES);
+
+    for (uint32_t b=0; b<sizeof(blockSizes) / sizeof(blockSizes[0]); b++)
+    {
+        TEST_CHECK_EQUAL(FILTER_ERR_OK, filterInitBiquadQ31(&biquad, TEST_BIQUAD_STAGES, gCoeffsQ31, state, TEST_BIQUAD_POST_SHIFT));
+
+        for (uint32_t n=0; n<TEST_SAMPLES; n+=blockSizes[b])
+        {
+            uint32_t count = (TEST_SAMPLES - n < blockSizes[b]) ? TEST_SAMPLES - n : blockSizes[b];
+            filterBiquadQ31(&biquad, &input[n], &output[n], count);
+        }
+
+        for (uint32_t n=0; n<TEST_SAMPLES; n++)
+        {
+            actual[n] = output[n] / 2147483648.0;
+        }
+
+        char name[40];
+        snprintf(name, sizeof(name), "biquad Q31 DF-II-T (block %u)", (unsigned)blockSizes[b]);
+
+        // The 64 bit state keeps the error in the order of the output rounding
+        TEST_CHECK(testCompare(name, actual, 1.0 / 2147483648.0) < 64.0);
+    }
+}
+
+static void testFIR(void)
+{
+    static int16_t input[TEST_SAMPLES];
+    static int16_t output[TEST_SAMPLES];
+    static double actual[TEST_SAMPLES];
+    const uint32_t blockSizes[] = {1, 7, TEST_MAX_BLOCK};
+    int16_t state[TEST_FIR_TAPS + TEST_MAX_BLOCK - 1];
+    double taps[TEST_FIR_TAPS];
+    FIRQ15Data_t fir;
+
+    // Hamming windowed sinc low pass, the coefficients sum up to 1.0
+    double sum = 0.0;
+    for (uint32_t k=0; k<TEST_FIR_TAPS; k++)
+    {
+        double t = (double)k - (TEST_FIR_TAPS - 1) / 2.0;
+        double sinc = (t == 0.0) ? 1.0 : sin(2.0 * M_PI * TEST_BIQUAD_CUTOFF * t) / (2.0 * M_PI * TEST_BIQUAD_CUTOFF * t);
+        taps[k] = sinc * (0.54 - 0.46 * cos(2.0 * M_PI * k / (TEST_FIR_TAPS - 1)));
+        sum += taps[k];
+    }
+
+    for (uint32_t k=0; k<TEST_FIR_TAPS; k++)
+    {
+        gTapsQ15[k] = (int16_t)lrint(taps[k] / sum * 32768.0);
+    }
+
+    for (uint32_t n=0; n<TEST_SAMPLES; n++)
+    {
+        input[n] = (int16_t)lrint(gInput[n] * 32768.0);
+        gReference[n] = 0.0;
+
+        for (uint32_t k=0; k<TEST_FIR_TAPS && k<=n; k++)
+        {
+            gReference[n] += (gTapsQ15[k] / 32768.0) * (input[n - k] / 32768.0);
+        }
+    }
+
+    for (uint32_t b=0; b<sizeof(blockSizes) / sizeof(blockSizes[0]); b++)
+    {
+        TEST_CHECK_EQUAL(FILTER_ERR_OK, filterInitFIRQ15(&fir, TEST_FIR_TAPS, gTapsQ15, state, TEST_MAX_BLOCK));
+
+        for (uint32_t n=0; n<TEST_SAMPLES; n+=blockSizes[b])
+        {
+            uint32_t count = (TEST_SAMPLES - n < blockSizes[b]) ? TEST_SAMPLES - n : blockSizes[b];
+            filterFIRQ15(&fir, &input[n], &output[n], count);
+        }
+
+        for (uint32_t n=0; n<TEST_SAMPLES; n++)
+        {
+            actual[n] = output[n] / 32768.0;
+        }
+
+        char name[40];
+        snprintf(name, sizeof(name), "FIR Q15 %u taps (block %u)", TEST_FIR_TAPS, (unsigned)blockSizes[b]);
+
+        // Exact 32 bit accumulation, only the final rounding
+        TEST_CHECK(testCompare(name, actual, 1.0 / 32768.0) <= 0.5);
+    }
+
+    TEST_CHECK_EQUAL(FILTER_ERR_INVALID_PARAM, filterFIRQ15(&fir, input, output, TEST_MAX_BLOCK + 1));
+}
+
+static void testEMAQRange(void)
+{
+    double worstError = 0.0;
+
+    srand(2);
+
+    for (uint32_t shift=0; shift<=FILTER_EMAQ_MAX_SHIFT; shift++)
+    {
+        EMAQFilterData_t ema;
+        long double reference = INT32_MIN;
+        double maxError = 0.0;
+
+        TEST_CHECK_EQUAL(FILTER_ERR_OK, filterInitEMAQ(&ema, shift, true));
+
+        // Full scale steps: the output settles exactly on the input (no bias)
+        maxError = fmax(maxError, testEMAQStep(&ema, &reference, shift, INT32_MIN));
+        for (uint32_t n=0; n<TEST_EMA_SETTLE; n++)
+        {
+            maxError = fmax(maxError, testEMAQStep(&ema, &reference, shift, INT32_MAX));
+        }
+        TEST_CHECK_EQUAL(INT32_MAX, filterEMAQ(&ema, INT32_MAX));
+
+        for (uint32_t n=0; n<TEST_EMA_SETTLE; n++)
+        {
+            maxError = fmax(maxError, testEMAQStep(&ema, &reference, shift, INT32_MIN));
+        }
+        TEST_CHECK_EQUAL(INT32_MIN, filterEMAQ(&ema, INT32_MIN));
+
+        // Largest possible difference in every update
+        for (uint32_t n=0; n<TEST_EMA_SAMPLES; n++)
+        {
+            maxError = fmax(maxError, testEMAQStep(&ema, &reference, shift, (n & 1) ? INT32_MIN : INT32_MAX));
+        }
+
+        for (uint32_t n=0; n<TEST_EMA_SAMPLES; n++)
+        {
+            maxError = fmax(maxError, testEMAQStep(&ema, &reference, shift, testRandom32()));
+        }
+
+        // Accumulator rounding (< 2^(shift - 17)) plus the output rounding
+        TEST_CHECK(maxError <= 0.75);
+        worstError = fmax(worstError, maxError);
+    }
+
+    printf("  %-32s max error %8.3f LSB\n", "filterEMAQ (int32_t range)", worstError);
+
+    TEST_CHECK_EQUAL(FILTER_ERR_INVALID_PARAM, filterInitEMAQ(&(EMAQFilterData_t){0}, FILTER_EMAQ_MAX_SHIFT + 1, true));
+}
+
+static void testEMARange(void)
+{
+    const int32_t scalingFactors[] = {100, 1 << 16, INT32_MAX};
+    uint32_t violations = 0;
+
+    srand(3);
+
+    for (uint32_t s=0; s<sizeof(scalingFactors) / sizeof(scalingFactors[0]); s++)
+    {
+        int32_t scaling = scalingFactors[s];
+        const int32_t alphas[] = {1, scaling / 16, scaling / 2, scaling - 1, scaling};
+
+        for (uint32_t a=0; a<sizeof(alphas) / sizeof(alphas[0]); a++)
+        {
+            EMAFilterData_t ema;
+            int32_t previous = INT32_MIN;
+
+            TEST_CHECK_EQUAL(FILTER_ERR_OK, filterInitEMA(&ema, scaling, alphas[a], true));
+            filterEMA(&ema, previous);
+
+            for (uint32_t n=0; n<TEST_EMA_SAMPLES; n++)
+            {
+                int32_t value = (n < TEST_EMA_SAMPLES / 2) ? ((n & 1) ? INT32_MIN : INT32_MAX) : testRandom32();
+                int32_t output = filterEMA(&ema, value);
+
+                // A weighted mean of the previous output and the input (an overflow leaves this range)
+                int32_t low = (previous < value) ? previous : value;
+                int32_t high = (previous < value) ? value : previous;
+                violations += (output < low || output > high);
+                previous = output;
+            }
+        }
+    }
+
+    TEST_CHECK_EQUAL(0, violations);
+    TEST_CHECK_EQUAL(FILTER_ERR_INVALID_PARAM, filterInitEMA(&(EMAFilterData_t){0}, 100, 101, true));
+}
+
+int main(void)
+{
+    testSignal();
+    testDesignBiquad(TEST_BIQUAD_CUTOFF);
+
+    printf("  Fixed-point filters against double precision\n");
+    testBiquadQ15();
+    testBiquadQ31();
+    testFIR();
+    testEMAQRange();
+    testEMARange();
+
+    return hostTestFinish("test_filter");
+}
@@ -0,0 +1,243 @@
+/**
+ * @file test_fixed_point.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host test of the fixed-point math functions (FixedPoint.h)
+ *
+ * Every function is checked for all combinations of the edge values of the
+ * int32_t range (and their neighbours) and for random operands against an
+ * exact reference with 128 bit integers. The reciprocal multiplication is
+ * checked for every µV value within +-4V against the exactly rounded
+ * quotient
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HostTest.h"
+#include "Util/FixedPoint.h"
+
+/*
+ * Private Defines
+*/
+#define TEST_RANDOM_OPERANDS    1000000     //!< Number of random operand pairs per function
+#define TEST_RECIPROCAL_RANGE   4000000     //!< Range of the exhaustive reciprocal test (µV)
+
+/*
+ * Private Module Variables
+*/
+static const int32_t gEdges[] =
+{
+    INT32_MIN, INT32_MIN + 1, INT32_MIN / 2, -FX_Q16_ONE - 1, -FX_Q16_ONE, -FX_Q16_ONE / 2, -3, -1,
+    0, 1, 3, FX_Q16_ONE / 2, FX_Q16_ONE, FX_Q16_ONE + 1, INT32_MAX / 2, INT32_MAX - 1, INT32_MAX
+};
+
+#define TEST_EDGE_COUNT         (sizeof(gEdges) / sizeof(gEdges[0]))
+
+/*
+ * Test helpers
+*/
+
+static int32_t testRandom32(void)
+{
+    return (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand() ^ ((uint32_t)rand() << 31));
+}
+
+static int32_t testSat(__int128 value)
+{
+    return (value > INT32_MAX) ? INT32_MAX : ((value < INT32_MIN) ? INT32_MIN : (int32_t)value);
+}
+
+/**
+ * @brief Exact floor(num / 2^shift + 0.5) (rounding to nearest, ties
+ * upwards like the implementation)
+ */
+static __int128 testRoundShift(__int128 num, uint32_t shift)
+{
+    __int128 den = (__int128)1 << shift;
+    __int128 twice = 2 * num + den;
+    __int128 quotient = twice / (2 * den);
+
+    // C division truncates, floor for negative values
+    return (twice % (2 * den) < 0) ? quotient - 1 : quotient;
+}
+
+/**
+ * @brief Checks one operand pair of all two operand functions, returns the
+ * number of deviations
+ */
+static uint32_t testPair(int32_t a, int32_t b)
+{
+    uint32_t failures = 0;
+
+    failures += fxSatAdd32(a, b) != testSat((__int128)a + b);
+    failures += fxSatSub32(a, b) != testSat((__int128)a - b);
+    failures += fxMulQ16(a, b) != testSat(testRoundShift((__int128)a * b, FX_Q16_SHIFT));
+    failures += fxMulQ31(a, b) != testSat(testRoundShift((__int128)a * b, FX_Q31_SHIFT));
+    failures += fxScaleQ31(a, b) != testSat(testRoundShift((__int128)a * b, FX_Q31_SHIFT));
+
+    if (b != 0)
+    {
+        // Rounded towards zero like the C division
+        failures += fxDivQ16(a, b) != testSat(((__int128)a << FX_Q16_SHIFT) / b);
+    }
+
+    return failures;
+}
+
+/*
+ * Tests
+*/
+
+static void testEdgePairs(void)
+{
+    uint32_t failures = 0;
+
+    for (uint32_t i=0; i<TEST_EDGE_COUNT; i++)
+    {
+        for (uint32_t j=0; j<TEST_EDGE_COUNT; j++)
+        {
+            failures += testPair(gEdges[i], gEdges[j]);
+        }
+    }
+
+    TEST_CHECK_EQUAL(0, failures);
+
+    // Documented special cases
+    TEST_CHECK_EQUAL(INT32_MAX, fxMulQ31(INT32_MIN, INT32_MIN));
+    TEST_CHECK_EQUAL(INT32_MAX, fxDivQ16(1, 0));
+    TEST_CHECK_EQUAL(INT32_MAX, fxDivQ16(0, 0));
+    TEST_CHECK_EQUAL(INT32_MIN, fxDivQ16(-1, 0));
+    TEST_CHECK_EQUAL(INT32_MAX, fxDivQ16(INT32_MIN, -FX_Q16_ONE));
+    TEST_CHECK_EQUAL(INT32_MAX, fxSatSub32(0, INT32_MIN));
+    TEST_CHECK_EQUAL(INT32_MIN, fxSatAdd32(INT32_MIN, -1));
+}
+
+static void testRandomPairs(void)
+{
+    uint32_t failures = 0;
+
+    srand(1);
+
+    for (uint32_t i=0; i<TEST_RANDOM_OPERANDS; i++)
+    {
+        int32_t a = testRandom32();
+        int32_t b = testRandom32();
+
+        // Full range operands and operands around 1.0 (no saturation)
+        failures += testPair(a, b);
+        failures += testPair(a >> 12, b >> 12);
+    }
+
+    TEST_CHECK_EQUAL(0, failures);
+}
+
+static void testConversions(void)
+{
+    uint32_t failures = 0;
+
+    for (uint32_t i=0; i<TEST_EDGE_COUNT; i++)
+    {
+        int32_t value = gEdges[i];
+
+        failures += fxIntToQ16(value) != testSat((__int128)value << FX_Q16_SHIFT);
+        failures += fxQ16ToInt(value) != testRoundShift(value, FX_Q16_SHIFT);
+    }
+
+    // Ties round upwards: -0.5 => 0, 0.5 => 1, -1.5 => -1
+    TEST_CHECK_EQUAL(0, fxQ16ToInt(-FX_Q16_ONE / 2));
+    TEST_CHECK_EQUAL(1, fxQ16ToInt(FX_Q16_ONE / 2));
+    TEST_CHECK_EQUAL(-1, fxQ16ToInt(-FX_Q16_ONE - FX_Q16_ONE / 2));
+    TEST_CHECK_EQUAL(32768, fxQ16ToInt(INT32_MAX));
+    TEST_CHECK_EQUAL(-32768, fxQ16ToInt(INT32_MIN));
+
+    // Bit width saturation for every width
+    for (uint32_t bits=1; bits<=32; bits++)
+    {
+        int64_t max = ((int64_t)1 << (bits - 1)) - 1;
+        int64_t min = -max - 1;
+
+        for (uint32_t i=0; i<TEST_EDGE_COUNT; i++)
+        {
+            int64_t expected = (gEdges[i] > max) ? max : ((gEdges[i] < min) ? min : gEdges[i]);
+            failures += fxSat32Bits(gEdges[i], bits) != expected;
+        }
+
+        failures += fxSat32Bits((int32_t)max, bits) != max;
+        failures += fxSat32Bits((int32_t)min, bits) != min;
+    }
+
+    TEST_CHECK_EQUAL(0, failures);
+    TEST_CHECK_EQUAL(2047, fxSatBits(5000, 12));
+    TEST_CHECK_EQUAL(-2048, fxSatBits(-5000, 12));
+
+    // Compile time constants are rounded to nearest
+    TEST_CHECK_EQUAL(FX_Q16_ONE, FX_Q16_CONST(1.0));
+    TEST_CHECK_EQUAL(-98304, FX_Q16_CONST(-1.5));
+    TEST_CHECK_EQUAL(1, FX_Q16_CONST(1.0 / 65536.0 * 0.5));
+    TEST_CHECK_EQUAL(-1, FX_Q16_CONST(-1.0 / 65536.0 * 0.5));
+    TEST_CHECK_EQUAL(INT32_MIN, FX_Q31_CONST(-1.0));
+    TEST_CHECK_EQUAL(1073741824, FX_Q31_CONST(0.5));
+}
+
+static void testReciprocal(void)
+{
+    // Ratios of the application (10cm per µV) and of typical unit conversions
+    const uint32_t ratios[][2] = {{950, 2000000}, {1, 3}, {2, 3}, {1000, 4095}, {4095, 4096}, {1, 1000000}};
+    uint32_t maxDeviation = 0;
+    uint32_t offTies = 0;
+
+    for (uint32_t r=0; r<sizeof(ratios) / sizeof(ratios[0]); r++)
+    {
+        int64_t num = ratios[r][0];
+        int64_t den = ratios[r][1];
+        uint32_t reciprocal = FX_RECIPROCAL_Q32(num, den);
+
+        for (int32_t value=-TEST_RECIPROCAL_RANGE; value<=TEST_RECIPROCAL_RANGE; value++)
+        {
+            // Exactly rounded quotient, and the distance of value * num / den to the next tie (in 1 / (2 den))
+            int64_t twice = 2 * (int64_t)value * num + den;
+            int64_t expected = (twice >= 0) ? twice / (2 * den) : -((-twice + 2 * den - 1) / (2 * den));
+            int64_t tieDistance = twice - expected * 2 * den;
+            int64_t result = fxMulQ32(value, reciprocal);
+            uint32_t deviation = (uint32_t)((result > expected) ? result - expected : expected - result);
+
+            maxDeviation = (deviation > maxDeviation) ? deviation : maxDeviation;
+
+            // A deviation is only allowed close to a tie: the rounding of the reciprocal changes the
+            // product by at most |value| / 2^33, i.e. |value| * den / 2^32 in units of 1 / (2 den)
+            int64_t tieWindow = (((int64_t)((value < 0) ? -value : value) * den) >> 32) + 1;
+            if (deviation != 0 && tieDistance > tieWindow && tieDistance < 2 * den - tieWindow)
+            {
+                offTies++;
+            }
+        }
+    }
+
+    TEST_CHECK(maxDeviation <= 1);
+    TEST_CHECK_EQUAL(0, offTies);
+
+    // Extremes can't overflow
+    uint32_t largest = FX_RECIPROCAL_Q32(0xFFFFFFFFULL, 0x100000000ULL);
+    TEST_CHECK_EQUAL(INT32_MAX, fxMulQ32(INT32_MAX, largest));
+    TEST_CHECK_EQUAL(INT32_MIN + 1, fxMulQ32(INT32_MIN, largest));
+    TEST_CHECK_EQUAL(0, fxMulQ32(INT32_MIN, 0));
+
+    printf("  %-32s max deviation %u LSB (ties only), %u values\n", "fxMulQ32 (+-4V in µV)", (unsigned)maxDeviation,
+           (unsigned)(sizeof(ratios) / sizeof(ratios[0]) * (2 * TEST_RECIPROCAL_RANGE + 1)));
+}
+
+int main(void)
+{
+    testEdgePairs();
+    testRandomPairs();
+    testConversions();
+    testReciprocal();
+
+    return hostTestFinish("test_fixed_point");
+}
@@ -0,0 +1,274 @@
+/**
+ * @file test_gesture.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host test of the gesture recognition (ButtonGesture.c)
+ *
+ * The button events and the µs timer are simulated, gestureProcess runs as
+ * 10ms task. Every gesture is checked for the posted event, the time of
+ * posting relative to the deciding edge or timeout and the recognition time
+ * of the statistics. The CPU cost per button event is measured with a long
+ * random event sequence
+ *
+ * @version 0.1
+ * @date 2023-03-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HostTest.h"
+#include "TimerModule.h"
+#include "ButtonGesture.h"
+
+/*
+ * Private Defines
+*/
+#define TEST_TASK_PERIOD_US     10000UL     //!< Call interval of gestureProcess (10ms task)
+#define TEST_QUEUE_SIZE         64          //!< Number of simulated button events in the queue
+#define TEST_POST_SIZE          16          //!< Number of recorded posted events
+#define TEST_LOAD_EVENTS        200000      //!< Number of button events of the load measurement
+
+#define EVT_USER_CLICK          1           //!< Event of a click of BTN_USER
+#define EVT_USER_DOUBLE         2           //!< Event of a double click of BTN_USER
+#define EVT_USER_LONG           3           //!< Event of a long press of BTN_USER
+#define EVT_RACE_CLICK          4           //!< Event of a click of BTN_RACE_MODE
+#define EVT_ACTIVATE_PRESS      5           //!< Event of a press of BTN_ACTIVATE
+#define EVT_CHORD               6           //!< Event of the chord BTN_ACTIVATE + BTN_RACE_MODE
+
+/*
+ * Private Types
+*/
+
+/**
+ * @brief Event posted by the gesture recognition
+ *
+ */
+typedef struct _TestPost
+{
+    int32_t eventID;                        //!< Posted event
+    uint32_t time;                          //!< Simulated time of posting in µs
+} TestPost_t;
+
+/*
+ * Private Module Variables
+*/
+static const GestureMapping_t gMapping[] =
+{
+    {GESTURE_BUTTON(BTN_USER),                                  GESTURE_CLICK,          EVT_USER_CLICK},
+    {GESTURE_BUTTON(BTN_USER),                                  GESTURE_DOUBLE_CLICK,   EVT_USER_DOUBLE},
+    {GESTURE_BUTTON(BTN_USER),                                  GESTURE_LONG_PRESS,     EVT_USER_LONG},
+    {GESTURE_BUTTON(BTN_RACE_MODE),                             GESTURE_CLICK,          EVT_RACE_CLICK},
+    {GESTURE_BUTTON(BTN_ACTIVATE),                              GESTURE_PRESS,          EVT_ACTIVATE_PRESS},
+    {GESTURE_BUTTON(BTN_ACTIVATE) | GESTURE_BUTTON(BTN_RACE_MODE), GESTURE_CHORD,       EVT_CHORD}
+};
+
+static uint32_t gNow;                                   //!< Simulated µs timer
+static ButtonEvent_t gQueue[TEST_QUEUE_SIZE];           //!< Simulated button events (ordered by time)
+static uint32_t gQueueHead;                             //!< Write index of the simulated events
+static uint32_t gQueueTail;                             //!< Read index of the simulated events
+static TestPost_t gPosts[TEST_POST_SIZE];               //!< Recorded posted events
+static uint32_t gPostCount;                             //!< Number of recorded posted events
+
+/*
+ * Simulated HAL functions
+*/
+
+uint32_t timerGetMicroseconds()
+{
+    return gNow;
+}
+
+int32_t buttonReadEvent(ButtonEvent_t* pEvent)
+{
+    // Only events which already happened are visible
+    if (gQueueTail == gQueueHead || (int32_t)(gQueue[gQueueTail % TEST_QUEUE_SIZE].timestamp - gNow) > 0)
+    {
+        return BUTTON_ERR_NO_EVENT;
+    }
+
+    *pEvent = gQueue[gQueueTail % TEST_QUEUE_SIZE];
+    gQueueTail++;
+
+    return BUTTON_ERR_OK;
+}
+
+static int32_t testPostEvent(int32_t eventID)
+{
+    if (gPostCount < TEST_POST_SIZE)
+    {
+        gPosts[gPostCount].eventID  = eventID;
+        gPosts[gPostCount].time     = gNow;
+        gPostCount++;
+    }
+
+    return 0;
+}
+
+/*
+ * Test helpers
+*/
+
+static void testReset(void)
+{
+    gNow        = TEST_TASK_PERIOD_US;
+    gQueueHead  = 0;
+    gQueueTail  = 0;
+    gPostCount  = 0;
+    gestureInitialize(gMapping, sizeof(gMapping) / sizeof(gMapping[0]), testPostEvent);
+}
+
+static void testEdge(Button_t button, Button_Status_t status, uint32_t time)
+{
+    gQueue[gQueueHead % TEST_QUEUE_SIZE].button     = button;
+    gQueue[gQueueHead % TEST_QUEUE_SIZE].status     = status;
+    gQueue[gQueueHead % TEST_QUEUE_SIZE].timestamp  = time;
+    gQueueHead++;
+}
+
+static void testRunUntil(uint32_t endTime)
+{
+    while ((int32_t)(endTime - gNow) > 0)
+    {
+        gNow += TEST_TASK_PERIOD_US;
+        gestureProcess();
+    }
+}
+
+/**
+ * @brief Checks that exactly one event was posted, not earlier than the
+ * decision and at most one task period later
+ */
+static void testExpectSingle(const char* pName, int32_t eventID, uint32_t decisionTime)
+{
+    GestureStats_t stats;
+
+    TEST_CHECK_EQUAL(1, gPostCount);
+    TEST_CHECK_EQUAL(eventID, gPosts[0].eventID);
+    TEST_CHECK(gPosts[0].time >= decisionTime);
+    TEST_CHECK(gPosts[0].time - decisionTime <= TEST_TASK_PERIOD_US);
+
+    gestureReadStats(&stats);
+    TEST_CHECK(stats.maxRecognitionUs <= TEST_TASK_PERIOD_US);
+
+    printf("  %-48s posted %4.1fms after the decision\n", pName, (gPosts[0].time - decisionTime) / 1000.0);
+}
+
+/*
+ * Tests
+*/
+
+static void testClick(void)
+{
+    // No double click mapped: decided by the release
+    testReset();
+    testEdge(BTN_RACE_MODE, BUTTON_PRESSED, 20300);
+    testEdge(BTN_RACE_MODE, BUTTON_RELEASED, 120700);
+    testRunUntil(2000000);
+    testExpectSingle("click (release decides)", EVT_RACE_CLICK, 120700);
+}
+
+static void testDelayedClick(void)
+{
+    // Double click mapped: the click waits for a second press
+    testReset();
+    testEdge(BTN_USER, BUTTON_PRESSED, 20300);
+    testEdge(BTN_USER, BUTTON_RELEASED, 120700);
+    testRunUntil(2000000);
+    testExpectSingle("click (double click timeout decides)", EVT_USER_CLICK, 120700 + GESTURE_DOUBLE_CLICK_US);
+}
+
+static void testDoubleClick(void)
+{
+    testReset();
+    testEdge(BTN_USER, BUTTON_PRESSED, 20300);
+    testEdge(BTN_USER, BUTTON_RELEASED, 120700);
+    testEdge(BTN_USER, BUTTON_PRESSED, 320100);
+    testEdge(BTN_USER, BUTTON_RELEASED, 420500);
+    testRunUntil(2000000);
+    testExpectSingle("double click (second press decides)", EVT_USER_DOUBLE, 320100);
+}
+
+static void testLongPress(void)
+{
+    testReset();
+    testEdge(BTN_USER, BUTTON_PRESSED, 20300);
+    testEdge(BTN_USER, BUTTON_RELEASED, 1500000);
+    testRunUntil(2000000);
+    testExpectSingle("long press (hold timeout decides)", EVT_USER_LONG, 20300 + GESTURE_LONG_PRESS_US);
+}
+
+static void testChord(void)
+{
+    testReset();
+    testEdge(BTN_RACE_MODE, BUTTON_PRESSED, 20300);
+    testEdge(BTN_ACTIVATE, BUTTON_PRESSED, 20300 + GESTURE_CHORD_US / 2);
+    testEdge(BTN_ACTIVATE, BUTTON_RELEASED, 300000);
+    testEdge(BTN_RACE_MODE, BUTTON_RELEASED, 310000);
+    testRunUntil(2000000);
+
+    // The press of BTN_ACTIVATE is posted immediately, the chord replaces both clicks
+    TEST_CHECK_EQUAL(2, gPostCount);
+    TEST_CHECK_EQUAL(EVT_ACTIVATE_PRESS, gPosts[0].eventID);
+    TEST_CHECK_EQUAL(EVT_CHORD, gPosts[1].eventID);
+    TEST_CHECK(gPosts[1].time - (20300 + GESTURE_CHORD_US / 2) <= TEST_TASK_PERIOD_US);
+    printf("  %-48s posted %4.1fms after the decision\n", "chord (second press decides)", (gPosts[1].time - (20300 + GESTURE_CHORD_US / 2)) / 1000.0);
+
+    // Too far apart: two separate gestures
+    testReset();
+    testEdge(BTN_RACE_MODE, BUTTON_PRESSED, 20300);
+    testEdge(BTN_ACTIVATE, BUTTON_PRESSED, 20300 + 2 * GESTURE_CHORD_US);
+    testEdge(BTN_RACE_MODE, BUTTON_RELEASED, 400000);
+    testEdge(BTN_ACTIVATE, BUTTON_RELEASED, 410000);
+    testRunUntil(2000000);
+    TEST_CHECK_EQUAL(2, gPostCount);
+    TEST_CHECK_EQUAL(EVT_ACTIVATE_PRESS, gPosts[0].eventID);
+    TEST_CHECK_EQUAL(EVT_RACE_CLICK, gPosts[1].eventID);
+}
+
+static void testLoad(void)
+{
+    GestureStats_t stats;
+    Button_Status_t status[BTN_COUNT] = {BUTTON_RELEASED, BUTTON_RELEASED, BUTTON_RELEASED};
+    uint64_t cycles = 0;
+
+    testReset();
+    srand(1);
+
+    for (uint32_t i=0; i<TEST_LOAD_EVENTS; i++)
+    {
+        Button_t button = (Button_t)(rand() % BTN_COUNT);
+        status[button] = (status[button] == BUTTON_PRESSED) ? BUTTON_RELEASED : BUTTON_PRESSED;
+
+        // Edges 20ms..1s apart, so all gestures occur
+        testEdge(button, status[button], gNow + 20000 + (uint32_t)(rand() % 980000));
+        gNow = gQueue[(gQueueHead - 1) % TEST_QUEUE_SIZE].timestamp;
+
+        uint64_t start = hostTestCycles();
+        gestureProcess();
+        cycles += hostTestCycles() - start;
+
+        gPostCount = 0;
+    }
+
+    gestureReadStats(&stats);
+    TEST_CHECK(stats.gestureCount >= TEST_LOAD_EVENTS);
+
+    printf("  CPU cost per button event\n");
+    hostBenchReport("gestureProcess (mean)", cycles, TEST_LOAD_EVENTS, "event");
+    printf("  %-40s %10u host cycles/event\n", "gestureHandleEvent (max, GestureStats_t)", (unsigned)stats.maxCycles);
+}
+
+int main(void)
+{
+    testClick();
+    testDelayedClick();
+    testDoubleClick();
+    testLongPress();
+    testChord();
+    testLoad();
+
+    return hostTestFinish("test_gesture");
+}
@@ -0,0 +1,408 @@
+/**
+ * @file test_sensor_pipeline.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host test of the sensor pipeline (SensorPipeline.c)
+ *
+ * The ADC is replaced by its frame ring (ADCFrame.c): the test publishes
+ * frames and calls the pipeline like the 1ms task (until no frame is left),
+ * several times per frame as at the lower acquisition rates or after a
+ * delay of several frames as at 1kHz. Checked are the execution of the
+ * chains and the diagnostics exactly once per new frame (including
+ * overwritten and busy frames), the diagnostic limits at different rates
+ * and the response of the chain (spike rejection, step response of the EMA
+ * stage against a double model for different spike windows, steady state
+ * of the linearization and the fusion). With SENSOR_USE_FLOAT the same test
+ * runs against the float variant, the load measurement (host cycles per
+ * frame) compares both variants
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HostTest.h"
+#include "ADCFrame.h"
+#include "SensorPipeline.h"
+#include "SensorDiagnostics.h"
+#include "SensorLinearTables.h"
+
+/*
+ * Private Defines
+*/
+#define TEST_CALLS_PER_FRAME    3           //!< Calls of sensorPipelineUpdate per published frame
+#define TEST_SETTLE_FRAMES      500         //!< Number of frames until all filters have settled
+#define TEST_EMA_TOLERANCE      2           //!< Maximum difference of the EMA output to the double model
+#define TEST_STEP_LOW_UV        1000000     //!< Lower level of the step response
+#define TEST_STEP_HIGH_UV       2000000     //!< Upper level of the step response
+#define TEST_LOAD_FRAMES        200000      //!< Number of frames of the load measurement
+
+/*
+ * Private Module Variables
+*/
+static uint32_t gFrameNumber;               //!< Number of the last published frame
+static bool gFakeBusy;                      //!< Simulates a read overlapping a frame update
+static uint32_t gProcessed;                 //!< Number of calls of sensorPipelineUpdate which returned true
+
+/*
+ * Simulated ADC functions
+*/
+
+int32_t adcReadNextSnapshot(ADCSnapshot_t* pSnapshot)
+{
+    if (gFakeBusy)
+    {
+        return ADC_ERR_BUSY;
+    }
+
+    return adcFrameReadNext(pSnapshot);
+}
+
+int32_t adcReadErrorCounters(ADCErrorCounters_t* pCounters)
+{
+    memset(pCounters, 0, sizeof(*pCounters));
+
+    return ADC_ERR_OK;
+}
+
+/*
+ * Test helpers
+*/
+
+/**
+ * @brief Publishes a new frame with both pots at the given voltages
+ */
+static void testPublish(int32_t pot1MicroVolt, int32_t pot2MicroVolt)
+{
+    int32_t raw[ADC_CHANNEL_COUNT] = {0};
+    int32_t microVolt[ADC_CHANNEL_COUNT] = {0};
+
+    microVolt[ADC_INPUT0]   = pot1MicroVolt;
+    microVolt[ADC_INPUT1]   = pot2MicroVolt;
+    raw[ADC_INPUT0]         = (int32_t)((int64_t)pot1MicroVolt * 4095 / 3300000);
+    raw[ADC_INPUT1]         = (int32_t)((int64_t)pot2MicroVolt * 4095 / 3300000);
+
+    adcFramePublish(raw, microVolt, 3300000, 250);
+    gFrameNumber++;
+}
+
+/**
+ * @brief One call of the 1ms task: processes frames until none is left
+ */
+static void testTask(void)
+{
+    while (sensorPipelineUpdate())
+    {
+        gProcessed++;
+    }
+}
+
+/**
+ * @brief Calls the task several times per frame (lower acquisition rates)
+ */
+static void testRun(void)
+{
+    for (uint32_t i=0; i<TEST_CALLS_PER_FRAME; i++)
+    {
+        testTask();
+    }
+}
+
+/**
+ * @brief Publishes the same voltage on both pots for a number of frames
+ */
+static void testHold(int32_t microVolt, uint32_t frames)
+{
+    for (uint32_t i=0; i<frames; i++)
+    {
+        testPublish(microVolt, microVolt);
+        testRun();
+    }
+}
+
+/**
+ * @brief Double precision reference of the linearization stage
+ */
+static double testLinearize(const SensorLinearTable_t* pTable, double microVolt)
+{
+    double position = (microVolt - pTable->inputBase) / (double)(1UL << pTable->segmentShift);
+    int32_t segment = (int32_t)floor(position);
+
+    if (segment < 0)
+    {
+        segment = 0;
+    }
+    else if ((uint32_t)segment >= pTable->segmentCount)
+    {
+        segment = (int32_t)pTable->segmentCount - 1;
+    }
+
+    double y0 = pTable->pOutput[segment];
+    double y1 = pTable->pOutput[segment + 1];
+
+    return y0 + (y1 - y0) * (position - segment);
+}
+
+static void testReset(void)
+{
+    adcFrameInitialize(3300000, 250);
+    gFrameNumber    = 0;
+    gFakeBusy       = false;
+    gProcessed      = 0;
+
+    sensorDiagInitialize();
+    TEST_CHECK_EQUAL(SENSOR_ERR_OK, sensorPipelineInitialize());
+}
+
+/*
+ * Tests
+*/
+
+static void testOncePerFrame(void)
+{
+    SensorDiagDataPath_t dataPath;
+
+    testReset();
+
+    // No frame published yet
+    TEST_CHECK(!sensorPipelineUpdate());
+
+    testHold(TEST_STEP_LOW_UV, 100);
+    TEST_CHECK_EQUAL(100, gProcessed);
+    sensorDiagReadDataPath(&dataPath);
+    TEST_CHECK_EQUAL(100, dataPath.frames);
+    TEST_CHECK_EQUAL(0, dataPath.missedFrames);
+    TEST_CHECK_EQUAL(TEST_STEP_LOW_UV, sensorPipelineGetInputValue(SENSOR_POT1));
+
+    // Task delayed by two frames (1kHz): both frames are processed in order
+    testPublish(TEST_STEP_LOW_UV + 800, TEST_STEP_LOW_UV + 800);
+    testPublish(TEST_STEP_LOW_UV, TEST_STEP_LOW_UV);
+    TEST_CHECK(sensorPipelineUpdate());
+    TEST_CHECK_EQUAL(TEST_STEP_LOW_UV + 800, sensorPipelineGetInputValue(SENSOR_POT1));
+    TEST_CHECK(sensorPipelineUpdate());
+    TEST_CHECK_EQUAL(TEST_STEP_LOW_UV, sensorPipelineGetInputValue(SENSOR_POT1));
+    TEST_CHECK(!sensorPipelineUpdate());
+    sensorDiagReadDataPath(&dataPath);
+    TEST_CHECK_EQUAL(102, dataPath.frames);
+    TEST_CHECK_EQUAL(0, dataPath.missedFrames);
+
+    // A busy read processes nothing, the frame is processed by the next call
+    testPublish(TEST_STEP_LOW_UV, TEST_STEP_LOW_UV);
+    gFakeBusy = true;
+    testRun();
+    TEST_CHECK_EQUAL(100, gProcessed);
+    gFakeBusy = false;
+    testRun();
+    TEST_CHECK_EQUAL(101, gProcessed);
+
+    // Delayed longer than the frame ring: only the overwritten frames are reported as missed
+    for (uint32_t i=0; i<ADC_FRAME_QUEUE_LENGTH + 2; i++)
+    {
+        testPublish(TEST_STEP_LOW_UV, TEST_STEP_LOW_UV);
+    }
+    testTask();
+    TEST_CHECK_EQUAL(101 + ADC_FRAME_QUEUE_LENGTH, gProcessed);
+    sensorDiagReadDataPath(&dataPath);
+    TEST_CHECK_EQUAL(103 + ADC_FRAME_QUEUE_LENGTH, dataPath.frames);
+    TEST_CHECK_EQUAL(2, dataPath.missedFrames);
+    TEST_CHECK_EQUAL(gFrameNumber, dataPath.frames + dataPath.missedFrames);
+}
+
+static void testSequenceWrap(void)
+{
+    SensorDiagDataPath_t dataPath;
+    ADCSnapshot_t snapshot = {0};
+    const uint32_t sequences[] = {ADC_SEQUENCE_MASK - 2, ADC_SEQUENCE_MASK - 1, 1, 2};
+
+    sensorDiagInitialize();
+
+    // The frame numbers wrap at 2^31, the frames ADC_SEQUENCE_MASK and 0 are missed across the wrap
+    for (uint32_t i=0; i<sizeof(sequences) / sizeof(sequences[0]); i++)
+    {
+        snapshot.sequence = sequences[i];
+        TEST_CHECK_EQUAL(DIAG_ERR_OK, sensorDiagProcessFrame(&snapshot));
+    }
+
+    sensorDiagReadDataPath(&dataPath);
+    TEST_CHECK_EQUAL(4, dataPath.frames);
+    TEST_CHECK_EQUAL(2, dataPath.missedFrames);
+}
+
+static void testSteadyState(void)
+{
+    const int32_t levels[] = {600000, 1234567, 2000000, 2900000};
+    SensorFusion_t fusion;
+
+    testReset();
+
+    for (uint32_t i=0; i<sizeof(levels) / sizeof(levels[0]); i++)
+    {
+        testHold(levels[i], TEST_SETTLE_FRAMES);
+
+        double expected = testLinearize(&gSensorLinearPot1, levels[i]);
+        TEST_CHECK(fabs(sensorPipelineGetValue(SENSOR_POT1) - expected) <= 1.0);
+        TEST_CHECK(fabs(sensorPipelineGetValue(SENSOR_POT2) - testLinearize(&gSensorLinearPot2, levels[i])) <= 1.0);
+
+        sensorPipelineReadFusion(&fusion);
+        TEST_CHECK(fabs(fusion.position - expected) <= 2.0);
+        TEST_CHECK(fusion.velocity == 0);
+    }
+}
+
+static void testSpike(void)
+{
+    SensorChannelStats_t stats;
+
+    testReset();
+    testHold(TEST_STEP_LOW_UV, TEST_SETTLE_FRAMES);
+    int32_t settled = sensorPipelineGetValue(SENSOR_POT1);
+
+    // A single frame outlier of +1V never reaches the output
+    testPublish(TEST_STEP_LOW_UV + 1000000, TEST_STEP_LOW_UV);
+    testRun();
+    TEST_CHECK(fabs(sensorPipelineGetValue(SENSOR_POT1) - settled) <= 1.0);
+    testHold(TEST_STEP_LOW_UV, 10);
+    TEST_CHECK(fabs(sensorPipelineGetValue(SENSOR_POT1) - settled) <= 1.0);
+
+    // An implausible voltage is clamped and counted by the range stage
+    testHold(3500000, 20);
+    sensorPipelineReadStats(SENSOR_POT1, &stats);
+    TEST_CHECK(stats.rangeViolations > 0);
+    TEST_CHECK((stats.flags & SENSOR_FLAG_RANGE) != 0);
+    TEST_CHECK(fabs(sensorPipelineGetValue(SENSOR_POT1) - testLinearize(&gSensorLinearPot1, 3400000)) <= 1.0);
+}
+
+/**
+ * @brief Step response of the chain against a double EMA model, which
+ * starts once the spike rejection passes the new level (at most half the
+ * window later)
+ */
+static void testStep(uint32_t alphaShift, uint32_t spikeWindow)
+{
+    double alpha = 1.0 / (double)(1UL << alphaShift);
+    double low = testLinearize(&gSensorLinearPot1, TEST_STEP_LOW_UV);
+    double high = testLinearize(&gSensorLinearPot1, TEST_STEP_HIGH_UV);
+    double maxError = 0.0;
+    int32_t delay = -1;
+    double model = low;
+
+    testReset();
+    TEST_CHECK_EQUAL(SENSOR_ERR_OK, sensorPipelineConfigureEMA(alphaShift));
+    TEST_CHECK_EQUAL(SENSOR_ERR_OK, sensorPipelineConfigureSpikeWindow(spikeWindow));
+
+    testHold(TEST_STEP_LOW_UV, TEST_SETTLE_FRAMES);
+
+    for (int32_t n=0; n<(int32_t)TEST_SETTLE_FRAMES; n++)
+    {
+        testPublish(TEST_STEP_HIGH_UV, TEST_STEP_HIGH_UV);
+        testRun();
+
+        int32_t output = sensorPipelineGetValue(SENSOR_POT1);
+
+        if (delay < 0 && fabs(output - low) > 1.0)
+        {
+            delay = n;
+        }
+
+        if (delay >= 0)
+        {
+            model += alpha * (high - model);
+            maxError = fmax(maxError, fabs(output - model));
+        }
+    }
+
+    TEST_CHECK(delay >= 0 && delay <= (int32_t)(spikeWindow / 2));
+    TEST_CHECK(maxError <= TEST_EMA_TOLERANCE);
+    TEST_CHECK(fabs(sensorPipelineGetValue(SENSOR_POT1) - high) <= 1.0);
+
+    printf("  step response alpha 2^-%-2u window %2u delayed %2d frames, max deviation from model %.2f\n",
+        (unsigned)alphaShift, (unsigned)spikeWindow, (int)delay, maxError);
+}
+
+/**
+ * @brief Stuck and slew limits of the diagnostics follow the frame period
+ */
+static void testDiagRate(void)
+{
+    const uint32_t periods[] = {100000, 10000, 1000};
+    const uint32_t stuckFrames[] = {20, 200, 2000};
+    const int32_t slewDigits[] = {3000, 300, 150};
+    const bool slewViolation[] = {false, false, true};
+    SensorDiagRecord_t record;
+
+    for (uint32_t i=0; i<sizeof(periods) / sizeof(periods[0]); i++)
+    {
+        testReset();
+        TEST_CHECK_EQUAL(DIAG_ERR_OK, sensorDiagConfigureRate(periods[i]));
+
+        // Identical values: 2s until the sensor is reported as stuck (the first frame counts)
+        testHold(TEST_STEP_LOW_UV, stuckFrames[i] - 1);
+        sensorDiagReadRecord(ADC_INPUT0, &record);
+        TEST_CHECK((record.flags & DIAG_FLAG_STUCK) == 0);
+        testHold(TEST_STEP_LOW_UV, 1);
+        sensorDiagReadRecord(ADC_INPUT0, &record);
+        TEST_CHECK((record.flags & DIAG_FLAG_STUCK) != 0);
+
+        // Slew limit of 40000 digits/s (at least 100 digits per frame)
+        int32_t step = (int32_t)((int64_t)slewDigits[i] * 3300000 / 4095);
+        testHold(TEST_STEP_LOW_UV + step, 1);
+        sensorDiagReadRecord(ADC_INPUT0, &record);
+        TEST_CHECK_EQUAL(slewViolation[i], (record.flags & DIAG_FLAG_SLEW) != 0);
+    }
+
+    TEST_CHECK_EQUAL(DIAG_ERR_INVALID_PARAM, sensorDiagConfigureRate(0));
+}
+
+/**
+ * @brief CPU cost of one frame (all chains, fusion and diagnostics) with
+ * noisy moving pots
+ */
+static void testLoad(void)
+{
+    uint64_t cycles = 0;
+
+    testReset();
+    srand(1);
+
+    for (uint32_t i=0; i<TEST_LOAD_FRAMES; i++)
+    {
+        int32_t position = TEST_STEP_LOW_UV + (int32_t)(i % 1000) * 1000;
+
+        testPublish(position + rand() % 2000, position + rand() % 2000);
+
+        uint64_t start = hostTestCycles();
+        sensorPipelineUpdate();
+        cycles += hostTestCycles() - start;
+    }
+
+#ifdef SENSOR_USE_FLOAT
+    hostBenchReport("sensorPipelineUpdate (float)", cycles, TEST_LOAD_FRAMES, "frame");
+#else
+    hostBenchReport("sensorPipelineUpdate (fixed point)", cycles, TEST_LOAD_FRAMES, "frame");
+#endif
+}
+
+int main(void)
+{
+    testOncePerFrame();
+    testSequenceWrap();
+    testSteadyState();
+    testSpike();
+    testStep(1, 5);
+    testStep(4, 5);
+    testStep(4, 31);
+    testDiagRate();
+    testLoad();
+
+#ifdef SENSOR_USE_FLOAT
+    return hostTestFinish("test_sensor_pipeline_float");
+#else
+    return hostTestFinish("test_sensor_pipeline");
+#endif
+}
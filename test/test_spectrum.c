@@ -0,0 +1,232 @@
+/**
+ * @file test_spectrum.c
+ * @author Andreas Schmidt (a.v.schmidt81@gmail.com)
+ * @brief Host test of the fixed-point spectrum library (Spectrum.h)
+ *
+ * Window, real FFT, bin power and Goertzel detector are compared with a
+ * double precision DFT of the same Q15 samples for all supported FFT sizes.
+ * The test signal uses the allowed input range (+-0.5) with tones on and
+ * between the bins and a DC offset, which leaks into the lowest bins
+ *
+ * @version 0.1
+ * @date 2023-03-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HostTest.h"
+#include "Util/Spectrum/Spectrum.h"
+
+/*
+ * Private Defines
+*/
+#define TEST_Q15_SCALE          32768.0     //!< Scale of the Q15 samples
+
+/*
+ * Private Module Variables
+*/
+static SpectrumFFTData_t gFFT;                              //!< FFT under test
+static int16_t gSamples[SPECTRUM_FFT_MAX_SIZE];             //!< Q15 test signal
+static int16_t gData[SPECTRUM_FFT_MAX_SIZE];                //!< Working buffer (samples, then bins)
+static uint32_t gPower[SPECTRUM_FFT_MAX_SIZE / 2];          //!< Power of the bins
+static double gReferenceRe[SPECTRUM_FFT_MAX_SIZE / 2 + 1];  //!< Real part of the DFT (Q15 units)
+static double gReferenceIm[SPECTRUM_FFT_MAX_SIZE / 2 + 1];  //!< Imaginary part of the DFT (Q15 units)
+
+/*
+ * Test helpers
+*/
+
+/**
+ * @brief Tones on bin 8 and between the bins 50 and 51 of a 256 point FFT
+ * (relative to the FFT size) plus noise, peak below 0.5
+ */
+static void testSignal(uint32_t fftSize)
+{
+    srand(fftSize);
+
+    for (uint32_t n=0; n<fftSize; n++)
+    {
+        double t = (double)n / fftSize;
+        double value = 0.25 * sin(2.0 * M_PI * 8.0 * (fftSize / 256) * t + 0.3) +
+                       0.15 * cos(2.0 * M_PI * 50.5 * (fftSize / 256) * t) +
+                       0.02 * ((double)rand() / RAND_MAX - 0.5) + 0.05;
+
+        gSamples[n] = (int16_t)lrint(value * TEST_Q15_SCALE);
+    }
+}
+
+/**
+ * @brief Double precision DFT of the (windowed) Q15 samples, scaled with
+ * 1 / N like the FFT under test
+ */
+static void testReferenceDFT(const int16_t* pSamples, uint32_t fftSize)
+{
+    for (uint32_t k=0; k<=fftSize / 2; k++)
+    {
+        double re = 0.0;
+        double im = 0.0;
+
+        for (uint32_t n=0; n<fftSize; n++)
+        {
+            double phase = 2.0 * M_PI * (double)((k * n) % fftSize) / fftSize;
+
+            re += pSamples[n] * cos(phase);
+            im -= pSamples[n] * sin(phase);
+        }
+
+        gReferenceRe[k] = re / fftSize;
+        gReferenceIm[k] = im / fftSize;
+    }
+}
+
+static double testReferencePower(uint32_t bin)
+{
+    return gReferenceRe[bin] * gReferenceRe[bin] + gReferenceIm[bin] * gReferenceIm[bin];
+}
+
+/*
+ * Tests
+*/
+
+static void testWindow(uint32_t fftSize)
+{
+    double maxError = 0.0;
+
+    for (uint32_t n=0; n<fftSize; n++)
+    {
+        gData[n] = gSamples[n];
+    }
+
+    TEST_CHECK_EQUAL(SPECTRUM_ERR_OK, spectrumWindowHann(&gFFT, gData));
+
+    for (uint32_t n=0; n<fftSize; n++)
+    {
+        double window = 0.5 * (1.0 - cos(2.0 * M_PI * n / fftSize));
+        maxError = fmax(maxError, fabs(gData[n] - gSamples[n] * window));
+    }
+
+    TEST_CHECK(maxError <= 1.0);
+    printf("  %-24s N=%4u max error %6.2f LSB\n", "spectrumWindowHann", (unsigned)fftSize, maxError);
+}
+
+static void testFFT(uint32_t fftSize)
+{
+    double maxError = 0.0;
+    double maxPowerError = 0.0;
+    double noise = 0.0;
+    double signal = 0.0;
+
+    for (uint32_t n=0; n<fftSize; n++)
+    {
+        gData[n] = gSamples[n];
+    }
+
+    testReferenceDFT(gSamples, fftSize);
+    TEST_CHECK_EQUAL(SPECTRUM_ERR_OK, spectrumRealFFT(&gFFT, gData));
+    TEST_CHECK_EQUAL(SPECTRUM_ERR_OK, spectrumPower(&gFFT, gData, gPower));
+
+    // Bin 0 holds DC and Nyquist, both are real
+    TEST_CHECK(fabs(gData[0] - gReferenceRe[0]) <= 2.0);
+    TEST_CHECK(fabs(gData[1] - gReferenceRe[fftSize / 2]) <= 2.0);
+
+    for (uint32_t k=1; k<fftSize / 2; k++)
+    {
+        double errorRe = gData[2 * k] - gReferenceRe[k];
+        double errorIm = gData[2 * k + 1] - gReferenceIm[k];
+
+        maxError = fmax(maxError, fmax(fabs(errorRe), fabs(errorIm)));
+        noise += errorRe * errorRe + errorIm * errorIm;
+        signal += testReferencePower(k);
+
+        // Power of the rounded bins: error of the bins times the amplitude
+        double amplitude = sqrt(testReferencePower(k));
+        maxPowerError = fmax(maxPowerError, fabs(gPower[k] - testReferencePower(k)) / (2.0 * amplitude + 1.0));
+    }
+
+    // One truncation per stage (scaled by 1/2, so the early ones fade) plus the split step
+    TEST_CHECK(maxError <= 3.0);
+    TEST_CHECK(maxPowerError <= 4.0);
+
+    printf("  %-24s N=%4u max error %6.2f LSB, SNR %5.1f dB\n", "spectrumRealFFT", (unsigned)fftSize, maxError, 10.0 * log10(signal / noise));
+}
+
+static void testGoertzel(uint32_t fftSize)
+{
+    const uint32_t bins[] = {1, 8 * (fftSize / 256), 50 * (fftSize / 256), fftSize / 4, fftSize / 2 - 1};
+    double maxError = 0.0;
+
+    for (uint32_t n=0; n<fftSize; n++)
+    {
+        gData[n] = gSamples[n];
+    }
+
+    spectrumWindowHann(&gFFT, gData);
+    testReferenceDFT(gData, fftSize);
+
+    for (uint32_t b=0; b<sizeof(bins) / sizeof(bins[0]); b++)
+    {
+        uint32_t power;
+
+        TEST_CHECK_EQUAL(SPECTRUM_ERR_OK, spectrumGoertzel(&gFFT, gData, bins[b], &power));
+
+        // Relative to the amplitude, like the power of the FFT bins
+        double amplitude = sqrt(testReferencePower(bins[b]));
+        maxError = fmax(maxError, fabs(power - testReferencePower(bins[b])) / (2.0 * amplitude + 1.0));
+    }
+
+    // Q30 coefficient, so only the rounding of the recurrence remains
+    TEST_CHECK(maxError <= 0.5);
+    printf("  %-24s N=%4u max power error %6.2f LSB x amplitude\n", "spectrumGoertzel", (unsigned)fftSize, maxError);
+
+    uint32_t power;
+    TEST_CHECK_EQUAL(SPECTRUM_ERR_INVALID_PARAM, spectrumGoertzel(&gFFT, gData, 0, &power));
+    TEST_CHECK_EQUAL(SPECTRUM_ERR_INVALID_PARAM, spectrumGoertzel(&gFFT, gData, fftSize / 2, &power));
+}
+
+static void testSqrt(void)
+{
+    const uint32_t values[] = {0, 1, 2, 3, 4, 65535, 65536, 1000000, UINT32_MAX - 1, UINT32_MAX};
+
+    for (uint32_t i=0; i<sizeof(values) / sizeof(values[0]); i++)
+    {
+        TEST_CHECK_EQUAL((uint32_t)floor(sqrt((double)values[i])), spectrumSqrt(values[i]));
+    }
+
+    for (uint32_t root=1; root<65536; root++)
+    {
+        uint32_t square = root * root;
+
+        if (spectrumSqrt(square) != root || spectrumSqrt(square - 1) != root - 1)
+        {
+            TEST_CHECK_EQUAL(root, spectrumSqrt(square));
+            TEST_CHECK_EQUAL(root - 1, spectrumSqrt(square - 1));
+            break;
+        }
+    }
+}
+
+int main(void)
+{
+    printf("  Fixed-point spectrum against a double precision DFT\n");
+
+    for (uint32_t fftSize=SPECTRUM_FFT_MIN_SIZE; fftSize<=SPECTRUM_FFT_MAX_SIZE; fftSize*=2)
+    {
+        TEST_CHECK_EQUAL(SPECTRUM_ERR_OK, spectrumInitFFT(&gFFT, fftSize));
+        testSignal(fftSize);
+
+        testWindow(fftSize);
+        testFFT(fftSize);
+        testGoertzel(fftSize);
+    }
+
+    TEST_CHECK_EQUAL(SPECTRUM_ERR_INVALID_PARAM, spectrumInitFFT(&gFFT, 384));
+    TEST_CHECK_EQUAL(SPECTRUM_ERR_INVALID_PARAM, spectrumInitFFT(&gFFT, 2 * SPECTRUM_FFT_MAX_SIZE));
+    testSqrt();
+
+    return hostTestFinish("test_spectrum");
+}
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+Generates the linearization tables of the sensor pipeline from calibration
+CSV files (build step, see Makefile).
+
+Each CSV contains the measured points of one sensor (input in µV, output in
+mm, header line and '#' comments are ignored). The points are resampled on
+a grid with a power of two spacing, so the pipeline finds the segment of a
+value with a shift instead of a search and interpolates with one multiply.
+
+Usage: linear_table.py -o <output.c> <name>=<file.csv> [<name>=<file.csv> ...]
+The table of a CSV is named gSensorLinear<name> (declared in
+SensorLinearTables.h).
+"""
+import argparse
+import csv
+import sys
+
+MAX_SEGMENTS = 128      # Upper limit of the table size (segments per sensor)
+
+
+def read_points(path):
+    points = []
+    with open(path, newline='', encoding='utf-8') as f:
+        for row in csv.reader(f):
+            if not row or row[0].strip().startswith('#'):
+                continue
+            try:
+                points.append((int(row[0]), int(row[1])))
+            except ValueError:
+                continue    # header line
+
+    if len(points) < 2:
+        sys.exit(f'{path}: at least two calibration points required')
+
+    points.sort()
+    for (x0, _), (x1, _) in zip(points, points[1:]):
+        if x0 == x1:
+            sys.exit(f'{path}: duplicate input value {x0}')
+
+    return points
+
+
+def interpolate(points, x):
+    # First/last segment is used for extrapolation
+    i = 1
+    while i < len(points) - 1 and x > points[i][0]:
+        i += 1
+    (x0, y0), (x1, y1) = points[i - 1], points[i]
+    return round(y0 + (x - x0) * (y1 - y0) / (x1 - x0))
+
+
+def build_table(points):
+    base = points[0][0]
+    span = points[-1][0] - base
+
+    shift = 0
+    while (span + (1 << shift) - 1) >> shift > MAX_SEGMENTS:
+        shift += 1
+
+    count = max(1, (span + (1 << shift) - 1) >> shift)
+    outputs = [interpolate(points, base + (i << shift)) for i in range(count + 1)]
+
+    return base, shift, outputs
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('-o', '--output', required=True, help='Generated C file')
+    parser.add_argument('tables', nargs='+', help='<name>=<file.csv>')
+    args = parser.parse_args()
+
+    lines = [
+        '/*',
+        ' * Generated by tools/linear_table.py from the calibration files, do not edit',
+        '*/',
+        '#include "SensorLinearTables.h"',
+        '',
+    ]
+
+    for spec in args.tables:
+        name, _, path = spec.partition('=')
+        if not name or not path:
+            sys.exit(f'invalid table specification "{spec}"')
+
+        base, shift, outputs = build_table(read_points(path))
+
+        lines.append(f'// {path}: {len(outputs) - 1} segments of {1 << shift} µV starting at {base} µV')
+        lines.append(f'static const int32_t gSensorLinear{name}Output[] =')
+        lines.append('{')
+        for i in range(0, len(outputs), 8):
+            lines.append('    ' + ', '.join(f'{v}' for v in outputs[i:i + 8]) + ',')
+        lines[-1] = lines[-1].rstrip(',')
+        lines.append('};')
+        lines.append('')
+        lines.append(f'const SensorLinearTable_t gSensorLinear{name} =')
+        lines.append('{')
+        lines.append(f'    {base}, {shift}, {len(outputs) - 1}, gSensorLinear{name}Output')
+        lines.append('};')
+        lines.append('')
+
+    with open(args.output, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(lines))
+
+
+if __name__ == '__main__':
+    main()